@@ -22,11 +22,164 @@
 #include <kern/spinlock.h>
 #include <kern/proc.h>
 #include <kern/thread.h>
+#include <kern/vm.h>
 #include <kern/async-event.h>
 #include <kern/queue.h>
 #include <kern/list.h>
 #include <kern/page.h>
 
+/** イベントキューにイベントを追加する
+    @param[in] que  操作対象のキュー
+    @param[in] ent  追加するエントリ
+    @note イベント番号の昇順に並べる(同一番号内では到着順).
+    末尾から, 追加するイベント以下の番号のイベントを探してその直後に挿入する
+ */
+static void
+evque_add_nolock(event_queue *que, event_ent *ent) {
+	list    *li;
+	event_no id;
+
+	kassert( que != NULL );
+	kassert( ent != NULL );
+	kassert( ent->node->info.no < EV_NR_EVENT );
+	kassert( spinlock_locked_by_self( &que->lock ) );
+
+	id = ent->node->info.no;
+	queue_reverse_for_each(li, &que->que) {
+
+		if ( CONTAINER_OF(li, event_ent, link)->node->info.no <= id )
+			break;
+	}
+	queue_insert_after(li, &ent->link);
+
+	ev_mask_set( &que->events, id );
+}
+
+/** イベントキューから指定した番号のイベントを取り出す
+    @param[in]  que   操作対象のキュー
+    @param[in]  id    取り出すイベントの番号
+    @param[out] entp  取り出したエントリの返却先
+    @note 指定した番号のイベントが保留されていることを確認してから呼び出す
+ */
+static void
+evque_get_nolock(event_queue *que, event_no id, event_ent **entp) {
+	list         *li;
+	event_ent   *ent;
+
+	kassert( que != NULL );
+	kassert( entp != NULL );
+	kassert( spinlock_locked_by_self( &que->lock ) );
+	kassert( ev_mask_test( &que->events, id ) );
+
+	ent = NULL;
+	queue_for_each(li, &que->que) {
+
+		ent = CONTAINER_OF(li, event_ent, link);
+		if ( ent->node->info.no >= id )
+			break;
+	}
+	kassert( li != (list *)&que->que );
+	kassert( ent->node->info.no == id );
+
+	/*  同一番号のイベントがなくなったら保留中ビットを落とす  */
+	if ( ( ( li->next == (list *)&que->que ) ||
+		( CONTAINER_OF(li->next, event_ent, link)->node->info.no != id ) ) &&
+	    ( !ev_mask_test( &que->coalesced, id ) ) )
+		ev_mask_unset( &que->events, id );
+
+	list_del( li );
+
+	*entp = ent;
+}
+
+/** イベントの受信に備えてスレッドを起床する
+    @param[in] thr 配送先スレッド
+    @param[in] id  配送したイベントの番号
+    @note イベントを配送可能な場合で, 休眠条件が合えば, 休眠しているスレッドを
+    起こす. マスクされている場合は, マスク解除時の通知を依頼する.
+ */
+static void
+wakeup_event_receiver(thread *thr, event_no id) {
+
+	kassert( thr != NULL );
+
+	if ( !ev_is_masked(thr, id) ) {
+		
+		if ( ( ( id == EV_SIG_KILL ) && ( thr_wait_killable(thr) ) ) ||
+		    thr_wait_intr(thr) )
+			_sched_wakeup(thr);
+	} else if ( thr->evque.upage != NULL )
+		thr->evque.upage->pending = 1;  /*  マスク解除時の通知を依頼  */
+}
+
+/** 集約配送するイベントを記録する
+    @param[in] que 操作対象のキュー
+    @param[in] id  イベント番号
+    @note 発生回数が上限に達した場合は上限値に留める
+ */
+static void
+evque_notify_nolock(event_queue *que, event_no id) {
+
+	kassert( que != NULL );
+	kassert( ev_is_coalescable(id) );
+	kassert( spinlock_locked_by_self( &que->lock ) );
+
+	if ( que->counts[id] < (event_count)~( (event_count)0 ) )
+		++que->counts[id];
+
+	ev_mask_set( &que->coalesced, id );
+	ev_mask_set( &que->events, id );
+}
+
+/** 指定した番号のイベントノードがキューに繋がっていることを確認する
+    @param[in] que 操作対象のキュー
+    @param[in] id  イベント番号
+    @retval    真  イベントノードが繋がっている
+    @retval    偽  イベントノードが繋がっていない
+ */
+static bool
+evque_has_node_nolock(event_queue *que, event_no id) {
+	list       *li;
+	event_no  eid;
+
+	kassert( que != NULL );
+	kassert( spinlock_locked_by_self( &que->lock ) );
+
+	queue_for_each(li, &que->que) {
+
+		eid = CONTAINER_OF(li, event_ent, link)->node->info.no;
+		if ( eid >= id )
+			return ( eid == id );
+	}
+
+	return false;
+}
+
+/** スレッドのイベントキューにエントリを追加し, 必要に応じてスレッドを起床する
+    @param[in] thr 配送先スレッド
+    @param[in] ent 追加するエントリ
+    @note 配送先スレッドが破棄されないことを保証して呼び出す.
+    イベントキューのロックは割込み禁止で獲得する
+ */
+static void
+enqueue_thread_event(thread *thr, event_ent *ent) {
+	event_no      id;
+	intrflags  flags;
+
+	kassert( thr != NULL );
+	kassert( ent != NULL );
+	kassert( !check_recursive_locked( &thr->evque.lock ) );	
+
+	id = ent->node->info.no;
+
+	spinlock_lock_disable_intr( &thr->evque.lock, &flags );
+
+	evque_add_nolock( &thr->evque, ent );
+	wakeup_event_receiver(thr, id);
+
+	spinlock_unlock_restore_intr( &thr->evque.lock, &flags );
+}
+
 /** イベントキューを初期化する
     @param[in] que 初期化対象のキュー
  */
@@ -44,8 +197,23 @@ ev_queue_init(event_queue *que){
 		que->masks.map[i] = 0;
 	}
 
-	for( i = 0; EV_NR_EVENT > i ; ++i) 
-		queue_init( &que->que[i] );
+	que->upage = NULL;
+	que->uaddr = NULL;
+	que->uvma = NULL;
+	que->ubatch = NULL;
+	que->nr_ubatch = 0;
+	que->ubatch_busy = false;
+
+	queue_init( &que->que );
+
+	ev_mask_clr( &que->coalesced );
+	memset( &que->counts[0], 0, sizeof(que->counts) );
+
+	/*  取り出し用ノードの参照はキューが保持し, 解放されないようにする  */
+	memset( &que->cnode, 0, sizeof(event_node) );
+	list_init( &que->cnode.ent.link );
+	que->cnode.ent.node = &que->cnode;
+	refcnt_init( &que->cnode.refs );
 }
 
 /** 未配送のイベントを解放する
@@ -53,28 +221,20 @@ ev_queue_init(event_queue *que){
  */
 void
 ev_free_pending_events(event_queue *que){
-	int            i;
 	intrflags  flags;
-	list         *li;
-	list       *next;
-	event_node *node;
+	event_ent   *ent;
 
 	kassert( que != NULL );
 
 	spinlock_lock_disable_intr( &que->lock, &flags );
-	for( i = 0; EV_NR_EVENT > i ; ++i) {
+	while( !queue_is_empty( &que->que ) ) {
 
-		for( li = queue_ref_top( &que->que[i] );
-		     li != (list *)&que->que[i];
-		     li = next) {
-
-			next = li->next;
-
-			list_del( li );
-			node =CONTAINER_OF(li, event_node, link);
-			kfree( node );
-		}
+		ent = CONTAINER_OF(queue_get_top( &que->que ), event_ent, link);
+		ev_free_ent( ent );
 	}
+	ev_mask_clr( &que->events );
+	ev_mask_clr( &que->coalesced );
+	memset( &que->counts[0], 0, sizeof(que->counts) );
 	spinlock_unlock_restore_intr( &que->lock, &flags );
 }
 
@@ -109,23 +269,8 @@ ev_send(tid dest, event_node *node) {
 	}
 
 	kassert( node->info.no < EV_NR_EVENT);
-	kassert( !check_recursive_locked( &thr->evque.lock ) );	
 
-	spinlock_lock( &thr->evque.lock );
-
-	ev_mask_set( &thr->evque.events, node->info.no );
-	queue_add( &thr->evque.que[node->info.no], &node->link );
-	if ( !ev_mask_test(&thr->evque.masks, node->info.no) ) {
-		
-		/* イベントを配送可能な場合で, 休眠条件が合えば, 
-		 * 休眠しているスレッドを起こす  
-		 */
-		if ( ( ( node->info.no == EV_SIG_KILL ) && ( thr_wait_killable(thr) ) ) ||
-		    thr_wait_intr(thr) )
-			_sched_wakeup(thr);
-	}
-
-	spinlock_unlock( &thr->evque.lock);
+	enqueue_thread_event(thr, &node->ent);
 
 	release_all_thread_lock(&flags);
 	
@@ -142,63 +287,156 @@ error_out:
     @param[in] node   シグナルノード
     @retval    0      正常配送完了
     @retval   -ENOMEM メモリ不足による配信失敗
-    @note      引数nodeの指し示す領域の解放は, 呼出元で実施。
+    @note      プロセスのロックを獲得したまま配送する.
+    配送先スレッド数分のエントリ配列を1回だけ割り当て, 
+    各スレッドのキューには引数nodeを共有するエントリを繋ぐ.
+    呼出元はnodeへの参照を保持しており, 配送後にev_put_nodeで解放する.
  */
 int
 ev_send_to_all_threads_in_process(proc *p, event_node *node) {
 	int           rc;
 	list         *li;
 	thread      *thr;
-	event_node  *new;
+	obj_cnt_type  nr;
+	obj_cnt_type   i;
+
+	kassert( p != NULL );
+	kassert( node != NULL );
+	kassert( node->info.no < EV_NR_EVENT);
+	kassert( spinlock_locked_by_self( &p->lock ) );
+
+	/*  配送先スレッド数を数える  */
+	nr = 0;
+	queue_for_each(li, &p->threads) {
+
+		if ( CONTAINER_OF(li, thread, plink)->type != THR_TYPE_KERNEL )
+			++nr;
+	}
+
+	if ( nr == 0 )
+		return 0;  /*  配送先スレッドがない  */
+
+	/*  イベントノードを共有するエントリを一括して割り当てる  */
+	rc = ev_alloc_shared_ents( node, nr );
+	if ( rc != 0 )
+		return rc;
+
+	i = 0;
+	queue_for_each(li, &p->threads) {
+
+		thr = CONTAINER_OF(li, thread, plink);
+		if ( thr->type == THR_TYPE_KERNEL )
+			continue;
+
+		kassert( nr > i );
+		rc = refcnt_get( &node->refs, NULL );  /*  エントリからの参照  */
+		kassert( rc == 0 );
+
+		enqueue_thread_event(thr, &node->ents[i++]);
+	}
+
+	return 0;
+}
+
+/** プロセスにシグナルを送る
+    @param[in] p      配送先プロセス
+    @param[in] node   シグナルノード
+ */
+void
+ev_send_to_process(proc *p, event_node *node) {
+	list         *li;
+	thread      *thr;
+	intrflags  flags;
 
 	kassert( p != NULL );
 	kassert( node != NULL );
 	kassert( spinlock_locked_by_self( &p->lock ) );
 
+	spinlock_lock_disable_intr( &p->evque.lock, &flags );
+	evque_add_nolock( &p->evque, &node->ent );  /*  キューに追加  */
+	spinlock_unlock_restore_intr( &p->evque.lock, &flags );
+
 	for( li = queue_ref_top( &p->threads );
 	     li != (list *)&p->threads;
 	     li = li->next) {
 
 		thr = CONTAINER_OF(li, thread, plink);
 
-		/*  イベント情報のコピーを作成し, 各スレッドに配送  */
-		rc = ev_alloc_node( node->info.no, &new );
-		if ( rc != 0 )
-			goto error_out;
+		wakeup_event_receiver(thr, node->info.no);
+	}
+	return;
+}
 
-		memcpy( &new->info, &node->info, sizeof(evinfo) );
+/** イベントを集約配送する
+    @param[in] dest  送信先スレッド
+    @param[in] id    イベント番号
+    @retval  0       送信完了
+    @retval -EINVAL  集約配送できないイベントを指定した
+    @retval -ENOENT  送信先スレッドが見つからなかった
+    @retval -EPERM   カーネルスレッドにイベントを配送しようとした
+    @note イベントノードを割り当てず, 保留中ビットと発生回数のみを記録する.
+    受信者には1回のイベントとして発生回数(evinfoのcount)と共に配送される.
+ */
+int
+ev_notify(tid dest, event_no id) {
+	int               rc;
+	thread          *thr;
+	intrflags      flags;
 
-		rc = ev_send(thr->tid, new);
-		if ( rc != 0 ) {  /*  配送失敗  */
-			
-			kfree(new);
-			goto error_out;
-		}
+	if ( !ev_is_coalescable(id) )
+		return -EINVAL;
+
+	acquire_all_thread_lock( &flags );
+
+	thr = thr_find_thread_by_tid_nolock(dest);
+	if ( thr == NULL ) {
+
+		rc = -ENOENT;
+		goto error_out;
+	}
+
+	if ( thr->type == THR_TYPE_KERNEL ) {
+
+		rc = -EPERM;
+		goto error_out;
 	}
 
+	kassert( !check_recursive_locked( &thr->evque.lock ) );	
+
+	spinlock_lock( &thr->evque.lock );
+	evque_notify_nolock( &thr->evque, id );
+	wakeup_event_receiver(thr, id);
+	spinlock_unlock( &thr->evque.lock );
+
 	rc = 0;
 
 error_out:
+	release_all_thread_lock(&flags);
+
 	return rc;
 }
 
-/** プロセスにシグナルを送る
+/** プロセスにイベントを集約配送する
     @param[in] p      配送先プロセス
-    @param[in] node   シグナルノード
+    @param[in] id     イベント番号
+    @retval  0       送信完了
+    @retval -EINVAL  集約配送できないイベントを指定した
+    @note プロセスのロックを獲得して呼び出す
  */
-void
-ev_send_to_process(proc *p, event_node *node) {
+int
+ev_notify_process(proc *p, event_no id) {
 	list         *li;
 	thread      *thr;
 	intrflags  flags;
 
 	kassert( p != NULL );
-	kassert( node != NULL );
 	kassert( spinlock_locked_by_self( &p->lock ) );
 
+	if ( !ev_is_coalescable(id) )
+		return -EINVAL;
+
 	spinlock_lock_disable_intr( &p->evque.lock, &flags );
-	queue_add( &p->evque.que[node->info.no], &node->link);  /*  キューに追加  */
-	ev_mask_set( &p->evque.events, node->info.no );
+	evque_notify_nolock( &p->evque, id );
 	spinlock_unlock_restore_intr( &p->evque.lock, &flags );
 
 	for( li = queue_ref_top( &p->threads );
@@ -206,61 +444,52 @@ ev_send_to_process(proc *p, event_node *node) {
 	     li = li->next) {
 
 		thr = CONTAINER_OF(li, thread, plink);
-
-		if ( !ev_mask_test(&thr->evque.masks, node->info.no) ) {
-		
-			/* イベントを配送可能な場合で, 休眠条件が合えば, 
-			 * 休眠しているスレッドを起こす  
-			 */
-			if ( ( ( node->info.no == EV_SIG_KILL ) && ( thr_wait_killable(thr) ) ) ||
-			    thr_wait_intr(thr) )
-				_sched_wakeup(thr);
-		}
+		wakeup_event_receiver(thr, id);
 	}
-	return;
+
+	return 0;
 }
 
 /** カレントスレッド終了時の未処理イベントを回送
  */
 void
 ev_handle_exit_thread_events(void) {
-	int            i;
-	list         *li;
-	list       *next;
+	event_ent   *ent;
 	event_node *node;
 
 	kassert( current->status == THR_TSTATE_EXIT );
 	kassert( spinlock_locked_by_self( &current->p->lock ) );
 
-	for( i = 0; EV_NR_EVENT > i ; ++i) {
+	while( !queue_is_empty( &current->evque.que ) ) {
 
-		for( li = queue_ref_top( &current->evque.que[i] );
-		     li != (list *)&current->evque.que[i];
-		     li = next) {
-			
-			next = li->next;
-			node = CONTAINER_OF(li, event_node, link);
-			list_del( li );
+		ent = CONTAINER_OF(queue_get_top( &current->evque.que ),
+		    event_ent, link);
+		node = ent->node;
 
-			if ( ( current == current->p->master ) || 
-			    ( node->info.flags & EV_FLAGS_THREAD_SPECIFIC ) ) {
+		if ( ( current == current->p->master ) || 
+		    ( node->info.flags & EV_FLAGS_THREAD_SPECIFIC ) ||
+		    ( ent != &node->ent ) ) {
 				
-				/* 自身が最終スレッドだった場合や
-				 * スレッド固有イベントの場合は, 
-				 * 即時にイベントを破棄する  
-				 */
-				kfree( node );
-				continue;  
-			}
-			
-			/*
-			 * イベントをプロセスのイベントキューに配送
+			/* 自身が最終スレッドだった場合や
+			 * スレッド固有イベントの場合は, 
+			 * 即時にイベントを破棄する
+			 * 全スレッドへの配送イベントは他のスレッドにも
+			 * 配送済みのため, 引き継がずに破棄する
 			 */
-			ev_send_to_process(current->p, node);
+			ev_free_ent( ent );
+			continue;  
 		}
-		kassert( queue_is_empty( &current->evque.que[i] ) );
-		ev_mask_unset( &current->evque.events, i );
+			
+		/*
+		 * イベントをプロセスのイベントキューに配送
+		 */
+		ev_send_to_process(current->p, node);
 	}
+
+	/*  集約配送されたイベントはスレッド固有イベントとして破棄する  */
+	ev_mask_clr( &current->evque.events );
+	ev_mask_clr( &current->evque.coalesced );
+	memset( &current->evque.counts[0], 0, sizeof(current->evque.counts) );
 }
 
 /** イベントマスクを取得する
@@ -273,7 +502,7 @@ ev_get_mask(event_mask *mask) {
 	kassert( mask != NULL );
 
 	spinlock_lock_disable_intr( &current->evque.lock, &flags );
-	memcpy(mask, &current->evque.masks, sizeof( event_mask ) );
+	memcpy(mask, ev_refer_mask( &current->evque ), sizeof( event_mask ) );
 	spinlock_unlock_restore_intr( &current->evque.lock, &flags );	
 }
 
@@ -290,10 +519,42 @@ ev_update_mask(thread *thr, event_mask *mask){
 	kassert( mask != NULL );
 
 	spinlock_lock_disable_intr( &thr->evque.lock, &flags );
-	memcpy(&thr->evque.masks, mask, sizeof( event_mask ) );
+	memcpy(ev_refer_mask( &thr->evque ), mask, sizeof( event_mask ) );
 	spinlock_unlock_restore_intr( &thr->evque.lock, &flags );	
 }
 
+/** スレッドのイベントマスクを参照する
+    @param[in] que 参照対象のスレッドのイベントキュー
+    @return イベントマスクのアドレス
+    @note 共有マスクページを割り当てたスレッドの場合は, 共有マスクページ上の
+    マスクを返却する
+ */
+event_mask *
+ev_refer_mask(event_queue *que) {
+
+	kassert( que != NULL );
+
+	return ( que->upage != NULL ) ? ( &que->upage->masks ) : ( &que->masks );
+}
+
+/** スレッドがイベントをマスクしていることを確認する
+    @param[in] thr 確認対象のスレッド
+    @param[in] id  イベント番号
+    @retval    真  イベントがマスクされている
+    @retval    偽  イベントがマスクされていない
+    @note EV_SIG_KILLはマスクの設定によらず常に配送可能とする
+ */
+bool
+ev_is_masked(thread *thr, event_no id) {
+
+	kassert( thr != NULL );
+
+	if ( id == EV_SIG_KILL )
+		return false;
+
+	return ev_mask_test( ev_refer_mask( &thr->evque ), id );
+}
+
 /** 未配送のイベントがあることを確認する
     @param[in] thr 確認対象のスレッド
     @retval    真  未配送のイベントがある
@@ -336,34 +597,71 @@ dequeue_from_evque_nolock(event_queue *evque, event_node **nodep) {
 	int               rc;
 	event_mask       tmp;
 	event_mask   deliver;
+	event_mask      mask;
 	event_no          id;
+	event_ent       *ent;
+	event_node     *node;
 
 	kassert( evque != NULL );
 	kassert( nodep != NULL );
 	kassert( spinlock_locked_by_self( &evque->lock ) );	
 
+	/*
+	 * 共有マスクページはユーザが随時更新するため, 複写してから参照する
+	 */
+	memcpy( &mask, ev_refer_mask( &current->evque ), sizeof(event_mask) );
+	ev_mask_unset( &mask, EV_SIG_KILL );  /*  KILLはマスクできない  */
+
 	/*
 	 * 送信可能な（マスクされていない)イベントの番号を取得する
 	 */
 	ev_mask_clr( &tmp );
 	ev_mask_clr( &deliver );
 	
-	ev_mask_xor( &evque->events, &current->evque.masks, &tmp);
+	ev_mask_xor( &evque->events, &mask, &tmp);
 	ev_mask_and( &evque->events, &tmp, &deliver);
 	
 	rc = ev_mask_find_first_bit(&deliver, &id);
-	if ( rc != 0 )
+	if ( rc != 0 ) {
+
+		/*  マスク中のイベントが保留されている場合はマスク解除時の通知を依頼  */
+		if ( ( current->evque.upage != NULL ) && 
+		    ( !ev_mask_empty( &evque->events ) ) )
+			current->evque.upage->pending = 1;
+
 		return rc;  /*  イベントが来ていない  */
+	}
 	
 	kassert( id < EV_NR_EVENT );
-	kassert( !queue_is_empty( &evque->que[id] ) );
-	
-	*nodep = CONTAINER_OF(queue_get_top( &evque->que[id] ), 
-	    event_node, link);
 
-	/*  キューにつながっているイベントがなくなったら保留中ビットを落とす  */
-	if ( queue_is_empty( &evque->que[id] ) ) 
-		ev_mask_unset( &evque->events, id );
+	if ( ev_mask_test( &evque->coalesced, id ) ) {
+
+		/*
+		 * 集約配送されたイベントを自スレッドの取り出し用ノードに格納して返却する
+		 * (プロセスのキューから取り出す場合も自スレッドのノードを使用する)
+		 */
+		node = &current->evque.cnode;
+		memset( &node->info, 0, sizeof(evinfo) );
+		node->info.no = id;
+		node->info.code = EV_SIG_SI_KERNEL;
+		node->info.count = evque->counts[id];
+
+		evque->counts[id] = 0;
+		ev_mask_unset( &evque->coalesced, id );
+		if ( !evque_has_node_nolock(evque, id) )
+			ev_mask_unset( &evque->events, id );
+
+		rc = refcnt_get( &node->refs, NULL );  /*  呼出元の参照  */
+		kassert( rc == 0 );
+
+		*nodep = node;
+
+		return 0;
+	}
+
+	evque_get_nolock(evque, id, &ent);
+
+	*nodep = ent->node;  /*  ノードの参照は呼出元が解放する  */
 
 	return 0;
 }
@@ -372,6 +670,7 @@ dequeue_from_evque_nolock(event_queue *evque, event_node **nodep) {
     @param[in] nodep   イベントノードのアドレスを格納する領域
     @retval    0       取得完了
     @retval   -ENOENT  イベントキューが空だった
+    @note 取り出したイベントノードは呼出元がev_put_nodeで解放する
  */
 int
 ev_dequeue(event_node **nodep) {
@@ -406,7 +705,8 @@ ev_dequeue(event_node **nodep) {
  */
 int
 kcom_handle_system_event(event_node *node) {
-	evinfo *info;
+	evinfo     *info;
+	event_code  code;
 
 	kassert( node != NULL );
 
@@ -415,7 +715,51 @@ kcom_handle_system_event(event_node *node) {
 	if  ( info->no != EV_SIG_KILL )
 		return -ENOENT;
 
-	thr_exit(info->code);   /*  自スレッド終了  */
+	code = info->code;
+	ev_put_node(node);  /*  イベントノードの解放  */
+
+	thr_exit(code);   /*  自スレッド終了  */
+
+	return 0;
+}
+
+/** 自スレッドのイベント一括配送先配列を登録する
+    @param[in] uarray 一括配送先配列のユーザ仮想アドレス(NULLの場合は登録解除)
+    @param[in] nr     配列の要素数(0の場合は登録解除)
+    @retval    0      正常に登録した
+    @retval   -EPERM  カーネルスレッドから呼び出した
+    @retval   -EINVAL 要素数が上限を超えている
+    @retval   -EFAULT 配列に書き込めない
+    @note 登録後は, 配送可能なイベントを配列に格納し, 1回のハンドラ呼出しで
+    配送する
+ */
+int
+ev_register_batch(evinfo *uarray, obj_cnt_type nr) {
+	bool        perm;
+	intrflags  flags;
+
+	if ( current->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( nr > EV_BATCH_MAX )
+		return -EINVAL;
+
+	if ( ( uarray == NULL ) || ( nr == 0 ) ) {
+
+		uarray = NULL;
+		nr = 0;
+	} else {
+
+		perm = vm_user_area_can_access(&current->p->vm, uarray,
+		    sizeof(evinfo) * nr, VMA_PROT_W);
+		if ( !perm )
+			return -EFAULT;
+	}
+
+	spinlock_lock_disable_intr( &current->evque.lock, &flags );
+	current->evque.ubatch = uarray;
+	current->evque.nr_ubatch = nr;
+	spinlock_unlock_restore_intr( &current->evque.lock, &flags );
 
 	return 0;
 }
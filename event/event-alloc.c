@@ -45,10 +45,13 @@ ev_alloc_node(event_no id, event_node **nodep) {
 
 	memset(node, 0, sizeof(event_node) );
 
-	list_init( &node->link );
+	list_init( &node->ent.link );
+	node->ent.node = node;
+	refcnt_init( &node->refs );
 	info = &node->info;
 	
 	info->no = id;
+	info->count = 1;
 	if ( current->p == hal_refer_kernel_proc() )
 		info->code = EV_SIG_SI_KERNEL;
 	else
@@ -58,3 +61,69 @@ ev_alloc_node(event_no id, event_node **nodep) {
 
 	return 0;
 }
+
+/** イベントノードへの参照を解放する
+    @param[in] node 操作対象のイベントノード
+    @note 最後の参照を解放した場合はイベントノードを解放する
+ */
+void
+ev_put_node(event_node *node) {
+	refcnt_val old;
+
+	kassert( node != NULL );
+
+	refcnt_put( &node->refs, &old );
+	if ( old == REFCNT_INITIAL_VAL ) {  /*  最終参照者  */
+
+		if ( node->ents != NULL )
+			kfree( node->ents );  /*  全スレッド配送用のエントリ配列  */
+		kfree( node );
+	}
+}
+
+/** イベントノードを共有するエントリの配列を割当てる
+    @param[in]  node 共有するイベントノード
+    @param[in]  nr   割り当てるエントリ数
+    @retval     0      割り当て成功
+    @retval    -ENOMEM メモリ不足により割当て失敗
+    @note 配送先スレッド数分のエントリを1回のメモリ割当てで確保する.
+    エントリ配列はイベントノードの最終参照の解放時に解放する.
+    各エントリをキューに繋ぐ際にイベントノードへの参照を獲得する.
+ */
+int
+ev_alloc_shared_ents(event_node *node, obj_cnt_type nr) {
+	event_ent  *ents;
+	obj_cnt_type   i;
+
+	kassert( node != NULL );
+	kassert( node->ents == NULL );
+	kassert( nr > 0 );
+
+	ents = kmalloc(sizeof(event_ent) * nr, KMALLOC_NORMAL);
+	if ( ents == NULL )
+		return -ENOMEM;
+
+	for( i = 0; nr > i; ++i) {
+
+		list_init( &ents[i].link );
+		ents[i].node = node;
+	}
+
+	node->ents = ents;
+
+	return 0;
+}
+
+/** キューから取り外したエントリを解放する
+    @param[in] ent 解放するエントリ
+    @note イベントノードへの参照を解放する. 共有エントリの配列は
+    イベントノードとともに解放される
+ */
+void
+ev_free_ent(event_ent *ent) {
+
+	kassert( ent != NULL );
+	kassert( list_not_linked( &ent->link ) );
+
+	ev_put_node( ent->node );
+}
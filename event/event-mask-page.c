@@ -0,0 +1,193 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Event mask page shared with user space                            */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/proc.h>
+#include <kern/thread.h>
+#include <kern/vm.h>
+#include <kern/page.h>
+#include <kern/rwsem.h>
+#include <kern/async-event.h>
+
+#include <vm/vm-internal.h>
+
+/** マスク中のイベントが保留されていることを確認する
+    @param[in] que  確認対象のイベントキュー
+    @param[in] mask イベントマスク
+    @retval    真   マスク中のイベントが保留されている
+    @retval    偽   マスク中のイベントは保留されていない
+ */
+static bool
+masked_event_pending(event_queue *que, event_mask *mask) {
+	bool           rc;
+	event_mask    tmp;
+	intrflags   flags;
+
+	ev_mask_clr( &tmp );
+
+	spinlock_lock_disable_intr( &que->lock, &flags );
+	ev_mask_and( &que->events, mask, &tmp );
+	rc = !ev_mask_empty( &tmp );
+	spinlock_unlock_restore_intr( &que->lock, &flags );
+
+	return rc;
+}
+
+/** 自スレッドにイベントマスクページを割り当て, ユーザ空間にマップする
+    @param[out] uaddrp マップしたユーザ仮想アドレスの返却先
+    @retval     0       正常に割り当てた
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -ENOMEM  メモリ不足
+    @retval    -ENOSPC  マップ先の空き領域がない
+    @note 割り当て済みの場合は, 割り当て済みのページのアドレスを返却する.
+    割り当て時点のマスクを引き継ぐ.
+ */
+int
+ev_mask_page_attach(void **uaddrp) {
+	int              rc;
+	vm              *as;
+	vma           *vmap;
+	void          *page;
+	void          *addr;
+	ev_mask_page    *pg;
+	intrflags     flags;
+
+	kassert( uaddrp != NULL );
+
+	if ( current->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( current->evque.upage != NULL ) {  /*  割り当て済み  */
+
+		*uaddrp = current->evque.uaddr;
+		return 0;
+	}
+
+	rc = get_free_page( &page );
+	if ( rc != 0 )
+		goto error_out;
+
+	memset( page, 0, PAGE_SIZE );
+	pg = (ev_mask_page *)page;
+
+	as = &current->p->vm;
+
+	rwsem_down_write( &as->asmtx );
+
+	rc = _vm_find_free_area_nolock(as, PAGE_SIZE, &addr);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	rc = vm_create_vma(as, &vmap, addr, PAGE_SIZE,
+	    VMA_PROT_R | VMA_PROT_W, VMA_FLAG_FIXED);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	rc = hal_map_user_page(as, (uintptr_t)addr, (uintptr_t)page,
+	    VMA_PROT_R | VMA_PROT_W);
+	kassert( rc == 0 );
+
+	rwsem_up_write( &as->asmtx );
+
+	/*
+	 * 現在のマスクを引き継いで共有マスクページに切り替える
+	 */
+	spinlock_lock_disable_intr( &current->evque.lock, &flags );
+	memcpy( &pg->masks, &current->evque.masks, sizeof(event_mask) );
+	current->evque.upage = pg;
+	current->evque.uaddr = addr;
+	current->evque.uvma = vmap;
+	spinlock_unlock_restore_intr( &current->evque.lock, &flags );
+
+	ev_mask_page_sync();  /*  保留中のイベントを反映する  */
+
+	*uaddrp = addr;
+
+	return 0;
+
+unlock_out:
+	rwsem_up_write( &as->asmtx );
+	free_page( page );
+
+error_out:
+	return rc;
+}
+
+/** 共有マスクページの保留通知を更新する
+    @retval     0       正常に更新した
+    @retval    -ENOENT  共有マスクページが割り当てられていない
+    @note ユーザスレッドがマスクを解除した際にpendingが設定されていた場合に
+    呼び出す. 配送可能になったイベントはシステムコール復帰時に配送される.
+ */
+int
+ev_mask_page_sync(void) {
+	ev_mask_page    *pg;
+	event_mask     mask;
+
+	pg = current->evque.upage;
+	if ( pg == NULL )
+		return -ENOENT;
+
+	pg->pending = 0;
+
+	memcpy( &mask, &pg->masks, sizeof(event_mask) );
+	ev_mask_unset( &mask, EV_SIG_KILL );
+
+	if ( masked_event_pending( &current->evque, &mask ) ||
+	    masked_event_pending( &current->p->evque, &mask ) )
+		pg->pending = 1;  /*  マスク中のイベントが残っている  */
+
+	return 0;
+}
+
+/** スレッドの共有マスクページを解放する
+    @param[in] thr 操作対象のスレッド
+    @note 共有マスクページ上のマスクをスレッドのイベントキューに書き戻す
+ */
+void
+ev_mask_page_release(thread *thr) {
+	vm              *as;
+	vma           *vmap;
+	ev_mask_page    *pg;
+	intrflags     flags;
+
+	kassert( thr != NULL );
+
+	if ( thr->evque.upage == NULL )
+		return;  /*  共有マスクページを使用していない  */
+
+	spinlock_lock_disable_intr( &thr->evque.lock, &flags );
+	pg = thr->evque.upage;
+	vmap = thr->evque.uvma;
+	memcpy( &thr->evque.masks, &pg->masks, sizeof(event_mask) );
+	thr->evque.upage = NULL;
+	thr->evque.uaddr = NULL;
+	thr->evque.uvma = NULL;
+	spinlock_unlock_restore_intr( &thr->evque.lock, &flags );
+
+	as = &thr->p->vm;
+
+	rwsem_down_write( &as->asmtx );
+	_vm_remove_vma_nolock(as, vmap);
+	rwsem_up_write( &as->asmtx );
+
+	free_page( pg );
+}
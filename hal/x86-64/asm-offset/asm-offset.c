@@ -15,6 +15,7 @@
 #include <kern/thread.h>
 #include <kern/thread-info.h>
 #include <hal/traps.h>
+#include <hal/arch-cpu.h>
 
 int
 main(int  __attribute__ ((unused)) argc, char  __attribute__ ((unused)) *argv[]) {
@@ -30,6 +31,8 @@ main(int  __attribute__ ((unused)) argc, char  __attribute__ ((unused)) *argv[])
 	OFFSET(TI_THREAD_OFFSET, _thread_info, thr);
 	OFFSET(TI_CPU_OFFSET, _thread_info, cpu);
 
+	OFFSET(CTX_RCX_OFFSET, _trap_context, rcx);
+	OFFSET(CTX_R11_OFFSET, _trap_context, r11);
 	OFFSET(CTX_TRAPNO_OFFSET, _trap_context, trapno);
 	OFFSET(CTX_RIP_OFFSET, _trap_context, rip);
 	OFFSET(CTX_CS_OFFSET, _trap_context, cs);
@@ -39,6 +42,9 @@ main(int  __attribute__ ((unused)) argc, char  __attribute__ ((unused)) *argv[])
 
 	OFFSET(THR_FPCTX_OFFSET, _thread, fpctx);
 
+	OFFSET(X86_64_CPU_SYSCALL_KSTACK_OFFSET, _x86_64_cpu, syscall_kstack);
+	OFFSET(X86_64_CPU_SYSCALL_URSP_OFFSET, _x86_64_cpu, syscall_ursp);
+
 	DEFINE_SIZE(PAGE_FRAME_SIZE, sizeof(struct _page_frame));
 
 	DEFINE_SIZE(EV_BITMAP_SIZE, sizeof(events_map));
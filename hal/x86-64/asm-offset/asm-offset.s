@@ -0,0 +1,102 @@
+	.file	"asm-offset.c"
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbp
+	movq	%rsp, %rbp
+	subq	$16, %rsp
+	movl	%edi, -4(%rbp)
+	movq	%rsi, -16(%rbp)
+#APP
+# 24 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@THREAD_INFO_SIZE $40 sizeof(struct _thread_info)"
+# 0 "" 2
+# 26 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_MAGIC_OFFSET $0 __asm_offsetof(struct _thread_info, magic)"
+# 0 "" 2
+# 27 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_INTRCNT_OFFSET $4 __asm_offsetof(struct _thread_info, intrcnt)"
+# 0 "" 2
+# 28 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_PREEMPT_OFFSET $8 __asm_offsetof(struct _thread_info, preempt)"
+# 0 "" 2
+# 29 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_FLAGS_OFFSET $12 __asm_offsetof(struct _thread_info, flags)"
+# 0 "" 2
+# 30 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_ARCH_FLAGS_OFFSET $16 __asm_offsetof(struct _thread_info, arch_flags)"
+# 0 "" 2
+# 31 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_THREAD_OFFSET $24 __asm_offsetof(struct _thread_info, thr)"
+# 0 "" 2
+# 32 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@TI_CPU_OFFSET $32 __asm_offsetof(struct _thread_info, cpu)"
+# 0 "" 2
+# 34 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_RCX_OFFSET $16 __asm_offsetof(struct _trap_context, rcx)"
+# 0 "" 2
+# 35 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_R11_OFFSET $80 __asm_offsetof(struct _trap_context, r11)"
+# 0 "" 2
+# 36 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_TRAPNO_OFFSET $120 __asm_offsetof(struct _trap_context, trapno)"
+# 0 "" 2
+# 37 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_RIP_OFFSET $136 __asm_offsetof(struct _trap_context, rip)"
+# 0 "" 2
+# 38 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_CS_OFFSET $144 __asm_offsetof(struct _trap_context, cs)"
+# 0 "" 2
+# 39 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_RFLAGS_OFFSET $152 __asm_offsetof(struct _trap_context, rflags)"
+# 0 "" 2
+# 40 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_RSP_OFFSET $160 __asm_offsetof(struct _trap_context, rsp)"
+# 0 "" 2
+# 41 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@CTX_SS_OFFSET $168 __asm_offsetof(struct _trap_context, ss)"
+# 0 "" 2
+# 43 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@THR_FPCTX_OFFSET $848 __asm_offsetof(struct _thread, fpctx)"
+# 0 "" 2
+# 45 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@X86_64_CPU_SYSCALL_KSTACK_OFFSET $24 __asm_offsetof(struct _x86_64_cpu, syscall_kstack)"
+# 0 "" 2
+# 46 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@X86_64_CPU_SYSCALL_URSP_OFFSET $32 __asm_offsetof(struct _x86_64_cpu, syscall_ursp)"
+# 0 "" 2
+# 48 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@PAGE_FRAME_SIZE $248 sizeof(struct _page_frame)"
+# 0 "" 2
+# 50 "asm-offset.c" 1
+	
+.ascii "@ASM_OFFSET@EV_BITMAP_SIZE $8 sizeof(events_map)"
+# 0 "" 2
+#NO_APP
+	movl	$0, %eax
+	leave
+	ret
+	.size	main, .-main
+	.ident	"GCC: (Debian 12.2.0-14+deb12u1) 12.2.0"
+	.section	.note.GNU-stack,"",@progbits
@@ -8,6 +8,7 @@
 /**********************************************************************/
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include <kern/config.h>
 #include <kern/kernel.h>
@@ -31,7 +32,37 @@ static const char *x86_64_default_environ[] = {
 	NULL
 };
 
+/** モジュールのコマンドラインにオプションが含まれているか調べる
+    @param[in] cmdline コマンドライン文字列
+    @param[in] opt     オプション文字列
+    @retval    true    空白で区切られた引数としてoptが含まれている
+    @retval    false   optが含まれていない
+ */
+static bool
+cmdline_has_option(const char *cmdline, const char *opt) {
+	const char   *cp;
+	size_t       len;
+
+	len = strlen(opt);
+	for( cp = cmdline; *cp != '\0'; ) {
+
+		while( *cp == ' ' )
+			++cp;
+
+		if ( ( strncmp(cp, opt, len) == 0 ) &&
+		    ( ( cp[len] == ' ' ) || ( cp[len] == '\0' ) ) )
+			return true;
+
+		while( ( *cp != ' ' ) && ( *cp != '\0' ) )
+			++cp;
+	}
+
+	return false;
+}
+
 /** GRUBのモジュールとして指定されたELFバイナリをロードする
+    @note コマンドラインにPROC_CAP_OPT_KSTATを指定したモジュールには
+    カーネル統計情報の採取状態を変更する特権(PROC_CAP_KSTAT)を付与する.
  */
 void
 hal_load_system_procs(void) {
@@ -48,6 +79,9 @@ hal_load_system_procs(void) {
 		    (void *)PHY_TO_KERN_STRAIGHT(mod->start));
 		kassert(rc == 0);
 
+		if ( cmdline_has_option(mod->param, PROC_CAP_OPT_KSTAT) )
+			p->caps |= PROC_CAP_KSTAT;
+
 		rc = proc_start(p);
 		kassert(rc == 0);
 	}
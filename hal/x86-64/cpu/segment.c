@@ -215,14 +215,14 @@ init_segments(void *gdtp, tss64 **tssp){
 	    0, 0xffffffff, X86_DESC_RDWR, X86_DESC_NONEXEC, X86_DESC_DPL_KERNEL, 
 	    X86_DESC_64BIT_MODE, X86_DESC_64BIT_SEG, X86_DESC_PAGE_SIZE);
 
-	init_gdt_descriptor_table_entry((gdt_descriptor *)&gdt[GDT_USER_CODE64_SEL], 
-	    0, 0xffffffff, X86_DESC_RDWR, X86_DESC_EXEC, X86_DESC_DPL_USER, 
-	    X86_DESC_64BIT_MODE, X86_DESC_64BIT_SEG, X86_DESC_PAGE_SIZE);
-
 	init_gdt_descriptor_table_entry((gdt_descriptor *)&gdt[GDT_USER_DATA64_SEL], 
 	    0, 0xffffffff, X86_DESC_RDWR, X86_DESC_NONEXEC, X86_DESC_DPL_USER, 
 	    X86_DESC_64BIT_MODE, X86_DESC_64BIT_SEG, X86_DESC_PAGE_SIZE);
 
+	init_gdt_descriptor_table_entry((gdt_descriptor *)&gdt[GDT_USER_CODE64_SEL], 
+	    0, 0xffffffff, X86_DESC_RDWR, X86_DESC_EXEC, X86_DESC_DPL_USER, 
+	    X86_DESC_64BIT_MODE, X86_DESC_64BIT_SEG, X86_DESC_PAGE_SIZE);
+
 	init_tss_descriptor((gdt_descriptor *)&gdt[GDT_TSS64_SEL], addr, 
 	    (uintptr_t )(gdtp + (PAGE_SIZE<<X86_64_SEGMENT_CPUINFO_PAGE_ORDER)), sizeof(tss64) - 1);
 	
@@ -147,6 +147,7 @@ hal_set_exception_stack(void *ksp){
 	kassert(ac->tssp != NULL);
 
 	tssp->rsp0 = (uint64_t)ksp;
+	ac->syscall_kstack = (uint64_t)ksp;  /*  SYSCALL命令用スタック  */
 }
 
 /** アドレス空間を切り替える
@@ -192,4 +193,5 @@ x86_64_init_cpus(void *kpgtbl){
 
 	setup_current_gdt_tss();
 	init_idt((idt_descriptor **)&idtp);
+	x86_64_init_syscall(&acpus[current_cpu()]);
 }
@@ -0,0 +1,49 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  SYSCALL/SYSRET setup routines                                     */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+
+#include <hal/arch-cpu.h>
+#include <hal/segment.h>
+
+extern void x86_64_syscall_entry(void);
+
+/** SYSCALL命令発行時にRFLAGSからクリアするビット
+    @note 割込み禁止状態でエントリに入り, カーネルスタックへの切り替えを行う
+ */
+#define X86_64_SYSCALL_RFLAGS_MASK			\
+	( ( 1 << X86_64_RFLAGS_IF ) | ( 1 << X86_64_RFLAGS_DF ) |	\
+	  ( 1 << X86_64_RFLAGS_TF ) | ( 1 << X86_64_RFLAGS_AC ) |	\
+	  ( 1 << X86_64_RFLAGS_NT ) )
+
+/** SYSCALL/SYSRET命令を使用可能にする
+    @param[in] ac 設定対象CPUのアーキテクチャ依存CPU情報
+    @note SYSCALLエントリではSWAPGSでKERNEL_GS_BASEに設定したCPU情報を参照し,
+    カーネルスタックを得る. int 0x90によるシステムコールも引き続き使用可能.
+ */
+void
+x86_64_init_syscall(x86_64_cpu *ac) {
+
+	kassert( ac != NULL );
+
+	wrmsr(STAR, ( (uint64_t)GDT_SYSRET_USER_BASE << 48 ) |
+	    ( (uint64_t)GDT_SYSCALL_KERN_BASE << 32 ) );
+	wrmsr(LSTAR, (uint64_t)x86_64_syscall_entry);
+	wrmsr(SFMASK, (uint64_t)X86_64_SYSCALL_RFLAGS_MASK);
+	wrmsr(KERNEL_GS_BASE, (uint64_t)ac);
+
+	wrmsr(EFER, rdmsr(EFER) | EFER_SCE);
+}
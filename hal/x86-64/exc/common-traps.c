@@ -18,9 +18,11 @@
 #include <kern/thread.h>
 #include <kern/vm.h>
 #include <kern/irq.h>
+#include <kern/kstat.h>
 
 #include <hal/segment.h>
 #include <hal/arch-cpu.h>
+#include <hal/rdtsc.h>
 
 //#define DEBUG_TRAP_WITH_INT3
 
@@ -418,7 +420,6 @@ exit_out:
 static void
 page_fault_exception(trap_context *ctx) {
 	int           rc;
-	vma        *vmap;
 	void *fault_addr;
 
 	if ( hal_is_intr_from_user(ctx) ) {
@@ -427,14 +428,26 @@ page_fault_exception(trap_context *ctx) {
 
 		fault_addr = (void *)read_cr2();
 
-		rc = vm_find_vma( &current->p->vm, fault_addr, &vmap);
+		if ( ctx->errno & PGFLT_ECODE_PROT )
+			goto exit_out;  /* 保護属性違反 */
+
+		/*
+		 * Demand paging
+		 * 同一プロセス内の他スレッドのフォルト処理やコピー処理と並行して
+		 * 処理できるように読み込みロックで割り当てる
+		 */
+		rwsem_down_read( &current->p->vm.asmtx );
+		rc = vm_map_newpage(&current->p->vm, fault_addr);
+		rwsem_up_read( &current->p->vm.asmtx );
 		if ( rc == 0 ) {
 
-			rc = vm_map_newpage(&current->p->vm, fault_addr);
-			if ( rc != 0 )
-				goto exit_out;
+			kstat_record_pgflt(KSTAT_PGFLT_DEMAND);
+			return;  /*  割当て完了  */
 		}
 
+		if ( rc != -ENOENT )
+			goto exit_out;  /*  メモリ不足など  */
+
 		/*
 		 * Stack fault
 		 */
@@ -444,6 +457,7 @@ page_fault_exception(trap_context *ctx) {
 			rc = proc_expand_stack(current->p, fault_addr);
 			if ( rc != 0 )
 				goto exit_out;
+			kstat_record_pgflt(KSTAT_PGFLT_STACK);
 		} else 
 			goto exit_out;	/* Invalid memory area access */
 
@@ -455,6 +469,7 @@ page_fault_exception(trap_context *ctx) {
 	return;
 
 exit_out:
+	kstat_record_pgflt(KSTAT_PGFLT_SEGV);
 	x86_64_trap_exit(ctx);
 }
 
@@ -663,13 +678,25 @@ handle_interrupt(trap_context *ctx){
 
 void
 trap_common(trap_context *ctx){
+	uint64_t    tsc;
+	uint64_t trapno;
 
 	kassert(ctx != NULL);	
 	
-	if (ctx->trapno == TRAP_SYSCALL)
-		handle_syscall_trap(ctx);
-	else if ( ctx->trapno <= X86_SIMD_FPE )
+	if (ctx->trapno == TRAP_SYSCALL) {
+
+		handle_syscall_trap(ctx);  /*  ディスパッチャ内で計測する  */
+		return;
+	}
+
+	tsc = ( kstat_is_enabled() ) ? ( rdtsc() ) : ( 0 );
+	trapno = ctx->trapno;
+
+	if ( ctx->trapno <= X86_SIMD_FPE )
 		cpu_exception(ctx);
 	else 
 		handle_interrupt(ctx);
+
+	if ( tsc != 0 )
+		kstat_record_trap(trapno, rdtsc() - tsc);
 }
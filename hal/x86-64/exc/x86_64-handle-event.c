@@ -22,6 +22,7 @@
 #include <kern/async-event.h>
 #include <kern/page.h>
 #include <kern/irq.h>
+#include <kern/softirq.h>
 
 #include <hal/arch-cpu.h>
 
@@ -39,6 +40,9 @@ _x86_64_return_from_event_handler(event_frame *user_ef, trap_context *ctx) {
 	if ( rc == -EFAULT )
 		goto exit_out;
 
+	if ( ef.nr_infos > 0 )
+		current->evque.ubatch_busy = false;  /*  一括配送の処理完了  */
+
 	/*  コンテキストを復元      */
 	memcpy( ctx, &ef.trap_ctx, sizeof(trap_context) );
 	/*  FPU コンテキストを復元  */
@@ -52,6 +56,49 @@ exit_out:
 	thr_exit(-EFAULT);
 	return;
 }
+/** 配送可能なイベントを一括配送先配列に格納する
+    @param[in]  first  取り出し済みの最初のイベントの情報
+    @param[out] nrp    格納したイベント数の返却先
+    @retval     0       正常に格納した
+    @retval    -EFAULT  配列に書き込めなかった
+    @note 最初のイベント以外のイベントノードは格納後に解放する
+ */
+static int
+store_batched_events(evinfo *first, obj_cnt_type *nrp) {
+	int                  rc;
+	obj_cnt_type         nr;
+	event_node        *node;
+	evinfo          *uarray;
+	obj_cnt_type     max_nr;
+
+	uarray = current->evque.ubatch;
+	max_nr = current->evque.nr_ubatch;
+
+	rc = vm_copy_out(&current->p->vm, &uarray[0], first, sizeof(evinfo));
+	if ( rc < 0 )
+		return rc;
+
+	for( nr = 1; max_nr > nr; ++nr) {
+
+		rc = ev_dequeue(&node);
+		if ( rc != 0 )
+			break;  /*  配送可能なイベントがない  */
+
+		rc = kcom_handle_system_event(node);  /*  捕捉不能イベントを処理する  */
+		kassert( rc != 0 );
+
+		rc = vm_copy_out(&current->p->vm, &uarray[nr], &node->info, 
+		    sizeof(evinfo));
+		ev_put_node(node);  /*  イベントノードの解放  */
+		if ( rc < 0 )
+			return rc;
+	}
+
+	*nrp = nr;
+
+	return 0;
+}
+
 /** イベントハンドラ呼出しフレーム作成
     @param[in] ctx 割込みコンテキスト
  */
@@ -62,7 +109,9 @@ x86_64_setup_event_handler(trap_context *ctx) {
 	event_node       *newev;
 	event_frame    *user_ef;
 	event_frame          ef;
+	evinfo            first;
 	intrflags         flags;
+	obj_cnt_type   nr_infos;
 
 	/*
 	 * 捕捉可能なシグナルを取り出す
@@ -85,7 +134,7 @@ x86_64_setup_event_handler(trap_context *ctx) {
 
 		id = newev->info.no;
 
-		kfree(newev);
+		ev_put_node(newev);
 		if ( ev_is_cpu_exception(id) ) 
 			goto exit_out;
 		
@@ -117,6 +166,30 @@ x86_64_setup_event_handler(trap_context *ctx) {
 	 *       使用されないページが割り当てられることによるメモリ消費量増加との
 	 *       トレードオフからRed Zone分の伸長を行わない方針とした。
 	 */
+	/*
+	 * 最初のイベントの情報を退避する
+	 * 集約配送用ノードは後続のイベントの取り出しで上書きされるため, 
+	 * 一括配送前に複写しておく
+	 */
+	memcpy( &first, &newev->info, sizeof(evinfo) );
+
+	/*
+	 * 一括配送先配列が登録されている場合は, 配送可能なイベントをまとめて格納し
+	 * 1回のハンドラ呼出しで配送する. 
+	 * 一括配送したイベントをハンドラが処理中の場合(ハンドラ内からのシステム
+	 * コール復帰時など)は, 配列を上書きしないように逐次配送する.
+	 */
+	nr_infos = 0;
+	if ( ( current->evque.nr_ubatch > 0 ) && ( !current->evque.ubatch_busy ) ) {
+
+		rc = store_batched_events(&first, &nr_infos);
+		if ( rc != 0 ) {
+
+			rc = -EFAULT;
+			goto exit_out;
+		}
+	}
+
 	user_ef = (event_frame *)( (void *)ctx->rsp - sizeof(event_frame) );
 	rc= proc_expand_stack(current->p, (void *)user_ef);
 	if ( rc != 0 ) {
@@ -132,7 +205,13 @@ x86_64_setup_event_handler(trap_context *ctx) {
 
 	memset( &ef, 0, sizeof(event_frame) );
 
-	memcpy( &ef.info, &newev->info, sizeof(evinfo) );
+	memcpy( &ef.info, &first, sizeof(evinfo) );
+	if ( nr_infos > 0 ) {
+
+		ef.nr_infos = nr_infos;
+		ef.infos = current->evque.ubatch;
+		current->evque.ubatch_busy = true;  /*  ハンドラからの復帰まで使用中  */
+	}
 	memcpy( &ef.trap_ctx, ctx, sizeof(trap_context) );  /*  コンテキストをコピー  */
 
 	/*  FPUコンテキストをコピー  */
@@ -155,11 +234,11 @@ x86_64_setup_event_handler(trap_context *ctx) {
 	 */
 	ctx->rip = (uint64_t)current->p->u_evhandler;
 	ctx->rsp = (uint64_t)user_ef;
-	ctx->rdi = (uint64_t)newev->info.no;
+	ctx->rdi = (uint64_t)first.no;
 	ctx->rsi = (uint64_t)&user_ef->info;
 	ctx->rdx = (uint64_t)user_ef;
 
-	kfree(newev);  /*  イベントノードの解放  */
+	ev_put_node(newev);  /*  イベントノードの解放  */
 
 	return;
 
@@ -167,18 +246,23 @@ unlock_out:
 	spinlock_unlock_restore_intr( &current->p->lock, &flags );
 
 exit_out:
-	kfree(newev);  /*  イベントノードの解放  */
+	ev_put_node(newev);  /*  イベントノードの解放  */
 	thr_exit(rc);   /*  自スレッド終了  */	
 	/*  ここにはこない  */
 }
 
-/** 非同期イベント/遅延ディスパッチを処理する
+/** 遅延割込み処理/非同期イベント/遅延ディスパッチを処理する
     @param[in] ctx 例外コンテキスト
+    @note 遅延割込み処理中に多重割込みから復帰した場合は, 遅延ディスパッチを
+    遅延割込み処理の完了時に行う
  */
 void
 x86_64_handle_post_exception(trap_context  __attribute__ ((unused))   *ctx) {
 
-	while ( ti_dispatch_delayed( ti_get_current_tinfo() ) ) 
+	softirq_run_pending();  /*  遅延割込み処理を実行  */
+
+	while ( ( !ti_dispatch_disabled( ti_get_current_tinfo() ) )
+	    && ( ti_dispatch_delayed( ti_get_current_tinfo() ) ) )
 		sched_schedule();   /*  遅延ディスパッチを処理  */
 
 	if ( hal_is_intr_from_user(ctx) )
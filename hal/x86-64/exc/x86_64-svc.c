@@ -22,18 +22,261 @@
 #include <kern/spinlock.h>
 #include <kern/async-event.h>
 #include <kern/svc.h>
+#include <kern/kstat.h>
+#include <kern/proc.h>
+#include <kern/vm.h>
+#include <kern/thread.h>
+#include <kern/lpc.h>
 
 #include <hal/traps.h>
+#include <hal/rdtsc.h>
 
 extern void _x86_64_return_from_event_handler(event_frame *_user_ef, trap_context *_ctx);
 
+/** システムコール番号に対応する処理を呼び出す
+    @param[in] no   システムコール番号
+    @param[in] args システムコール引数
+    @return システムコールの返り値
+    @note イベントハンドラからの復帰はコンテキストを書き換えるため
+    x86_64_dispatch_syscallで処理する
+ */
+static int64_t
+invoke_syscall(uint64_t no, uint64_t args[SVC_BATCH_NR_ARGS]) {
+	int64_t   res;
+
+	switch( no ) {
+
+	case SYS_YATOS_EV_REG_EVHANDLER:
+		res = svc_register_common_event_handler((void *)args[0]);
+		break;
+	case SYS_YATOS_THR_YIELD:
+		res = svc_thr_yield();
+		break;
+	case SYS_YATOS_THR_EXIT:
+		svc_thr_exit(args[0]);
+		res = 0;
+		break;
+	case SYS_YATOS_THR_GETID:
+		res = svc_thr_getid();
+		break;
+	case SYS_YATOS_THR_WAIT:
+		res = svc_thr_wait((tid)args[0], (thread_wait_flags)args[1], 
+		    (tid *)args[2], (exit_code *)args[3]);
+		break;
+	case SYS_YATOS_LPC_SEND:
+		res = svc_lpc_send(args[0], args[1], (void *)args[2]);
+		break;
+	case SYS_YATOS_LPC_RECV:
+		res = svc_lpc_recv(args[0], args[1], (void *)args[2], (void *)args[3]);
+		break;
+	case SYS_YATOS_LPC_SEND_AND_REPLY:
+		res = svc_lpc_send_and_reply(args[0], (void *)args[1]);
+		break;
+	case SYS_YATOS_FUTEX_WAIT:
+		res = svc_futex_wait((void *)args[0], (futex_val)args[1], 
+		    (futex_tmout)args[2]);
+		break;
+	case SYS_YATOS_FUTEX_WAKE:
+		res = svc_futex_wake((void *)args[0], (int)args[1]);
+		break;
+	case SYS_YATOS_KSTAT_CTRL:
+		res = svc_kstat_ctrl((int)args[0]);
+		break;
+	case SYS_YATOS_KSTAT_GET:
+		res = svc_kstat_get((int)args[0], args[1], (void *)args[2]);
+		break;
+	case SYS_YATOS_LPC_SEND_ASYNC:
+		res = svc_lpc_send_async(args[0], (void *)args[1], 
+		    (lpc_req_id *)args[2]);
+		break;
+	case SYS_YATOS_LPC_ASYNC_WAIT:
+		res = svc_lpc_async_wait((lpc_tmout)args[0], (lpc_req_id *)args[1], 
+		    (int *)args[2]);
+		break;
+	case SYS_YATOS_LPC_RECV_REQ:
+		res = svc_lpc_recv_req(args[0], args[1], (void *)args[2], 
+		    (endpoint *)args[3], (lpc_req_id *)args[4]);
+		break;
+	case SYS_YATOS_LPC_RECV_BATCH:
+		res = svc_lpc_recv_batch(args[0], args[1], (lpc_batch_ent *)args[2], 
+		    (int)args[3]);
+		break;
+	case SYS_YATOS_LPC_REPLY_BATCH:
+		res = svc_lpc_reply_batch((lpc_batch_ent *)args[0], (int)args[1]);
+		break;
+	case SYS_YATOS_LPC_WAIT_ANY:
+		res = svc_lpc_wait_any((endpoint *)args[0], (int)args[1], 
+		    (lpc_tmout)args[2], (uint64_t *)args[3]);
+		break;
+	case SYS_YATOS_VM_GRANT:
+		res = svc_vm_grant(args[0], (void *)args[1], (size_t)args[2], 
+		    (vma_prot)args[3], (vm_grant_id *)args[4]);
+		break;
+	case SYS_YATOS_VM_GRANT_MAP:
+		res = svc_vm_grant_map((vm_grant_id)args[0], (void *)args[1], 
+		    (vma_prot)args[2]);
+		break;
+	case SYS_YATOS_VM_GRANT_UNMAP:
+		res = svc_vm_grant_unmap((vm_grant_id)args[0]);
+		break;
+	case SYS_YATOS_VM_GRANT_REVOKE:
+		res = svc_vm_grant_revoke((vm_grant_id)args[0]);
+		break;
+	case SYS_YATOS_LPC_RING_CREATE:
+		res = svc_lpc_ring_create(args[0], (obj_cnt_type)args[1], 
+		    (void *)args[2], (lpc_ring_id *)args[3]);
+		break;
+	case SYS_YATOS_LPC_RING_ATTACH:
+		res = svc_lpc_ring_attach((lpc_ring_id)args[0], (void *)args[1]);
+		break;
+	case SYS_YATOS_LPC_RING_NOTIFY:
+		res = svc_lpc_ring_notify((lpc_ring_id)args[0], (int)args[1]);
+		break;
+	case SYS_YATOS_LPC_RING_WAIT:
+		res = svc_lpc_ring_wait((lpc_ring_id)args[0], (int)args[1], 
+		    (lpc_tmout)args[2]);
+		break;
+	case SYS_YATOS_LPC_RING_DESTROY:
+		res = svc_lpc_ring_destroy((lpc_ring_id)args[0]);
+		break;
+	case SYS_YATOS_VM_SBRK:
+		res = svc_vm_sbrk((intptr_t)args[0], (void **)args[1]);
+		break;
+	case SYS_YATOS_VM_MAP_ANON:
+		res = svc_vm_map_anon((void *)args[0], (size_t)args[1], 
+		    (vma_prot)args[2], (void **)args[3]);
+		break;
+	case SYS_YATOS_VM_UNMAP_ANON:
+		res = svc_vm_unmap_anon((void *)args[0], (size_t)args[1]);
+		break;
+	case SYS_YATOS_KNS_GENERATION:
+		res = svc_kns_generation((uint64_t *)args[0]);
+		break;
+	case SYS_YATOS_EV_MASK_ATTACH:
+		res = svc_ev_mask_attach((void **)args[0]);
+		break;
+	case SYS_YATOS_EV_MASK_SYNC:
+		res = svc_ev_mask_sync();
+		break;
+	case SYS_YATOS_EV_REG_BATCH:
+		res = svc_ev_register_batch((evinfo *)args[0], (obj_cnt_type)args[1]);
+		break;
+	default:
+		res = -ENOSYS;
+		break;
+	}
+
+	return res;
+}
+
+/** 複数のシステムコールを一括して処理する
+    @param[in] uents ユーザ空間中のシステムコール要求配列
+    @param[in] nr    要求数
+    @param[in] flags 処理フラグ(SVC_BATCH_FLAG_STOP_ON_ERROR)
+    @return    0以上  処理した要求数
+    @retval   -EINVAL 要求数が不正
+    @retval   -EFAULT 要求配列にアクセスできない
+    @note 各要求の返り値は要求配列のresに格納する.
+    イベントハンドラからの復帰, 一括処理の入れ子, 短メッセージLPCは
+    要求できない(-EINVAL).
+    SVC_BATCH_FLAG_STOP_ON_ERROR指定時は負の返り値を得た時点で処理を打ち切る.
+ */
+static int64_t
+dispatch_batch(svc_batch_entry *uents, uint64_t nr, uint64_t flags) {
+	int                rc;
+	uint64_t            i;
+	svc_batch_entry   ent;
+
+	if ( ( nr == 0 ) || ( nr > SVC_BATCH_MAX_ENTRIES ) )
+		return -EINVAL;
+
+	for( i = 0; nr > i; ++i) {
+
+		rc = vm_copy_in(&current->p->vm, &ent, &uents[i], 
+		    sizeof(svc_batch_entry));
+		if ( rc < 0 )
+			return -EFAULT;
+
+		if ( ( ent.no == SYS_YATOS_EV_RETURN ) || ( ent.no == SYS_YATOS_BATCH ) ||
+		    ( ent.no == SYS_YATOS_LPC_SHORT_SEND ) ||
+		    ( ent.no == SYS_YATOS_LPC_SHORT_RECV ) ||
+		    ( ent.no == SYS_YATOS_LPC_SHORT_CALL ) )
+			ent.res = -EINVAL;
+		else
+			ent.res = invoke_syscall(ent.no, &ent.args[0]);
+
+		rc = vm_copy_out(&current->p->vm, &uents[i].res, &ent.res, 
+		    sizeof(ent.res));
+		if ( rc < 0 )
+			return -EFAULT;
+
+		if ( ( flags & SVC_BATCH_FLAG_STOP_ON_ERROR ) && ( ent.res < 0 ) )
+			return i + 1;  /*  エラーとなった要求までを処理した  */
+	}
+
+	return nr;
+}
+
+/** 短メッセージLPCのシステムコールを処理する
+    @param[in] no  システムコール番号
+    @param[in] ctx コンテキスト情報
+    @return システムコールの返り値
+    @note 短メッセージはrsi, rdx, r10, r8, r9の各レジスタで受け渡し,
+    受信した短メッセージは受信者のトラップコンテキストに直接書き込む.
+    受信時の送信元エンドポイントはrdiに返却する.
+ */
+static int64_t
+dispatch_lpc_short(uint64_t no, trap_context *ctx) {
+	int64_t          res;
+	endpoint         src;
+	lpc_short_msg     sm;
+
+	sm.w[0] = ctx->rsi;
+	sm.w[1] = ctx->rdx;
+	sm.w[2] = ctx->r10;
+	sm.w[3] = ctx->r8;
+	sm.w[4] = ctx->r9;
+
+	switch( no ) {
+
+	case SYS_YATOS_LPC_SHORT_SEND:
+		return svc_lpc_short_send((endpoint)ctx->rdi, &sm);
+	case SYS_YATOS_LPC_SHORT_RECV:
+		res = svc_lpc_short_recv((endpoint)ctx->rdi, (lpc_tmout)ctx->rsi, &sm,
+		    &src);
+		if ( res == 0 )
+			ctx->rdi = (uint64_t)src;
+		break;
+	case SYS_YATOS_LPC_SHORT_CALL:
+		res = svc_lpc_short_call((endpoint)ctx->rdi, &sm);
+		break;
+	default:
+		return -ENOSYS;
+	}
+
+	if ( res != 0 )
+		return res;
+
+	/*
+	 * 受信した短メッセージをトラップコンテキストに書き戻す
+	 */
+	ctx->rsi = sm.w[0];
+	ctx->rdx = sm.w[1];
+	ctx->r10 = sm.w[2];
+	ctx->r8  = sm.w[3];
+	ctx->r9  = sm.w[4];
+
+	return 0;
+}
+
 /** システムコールをディスパッチする
     @param[in] ctx コンテキスト情報
  */
 void
 x86_64_dispatch_syscall(trap_context *ctx) {
-	int        rc;
-	uint64_t   no;
+	uint64_t                         no;
+	uint64_t                        tsc;
+	uint64_t   args[SVC_BATCH_NR_ARGS];
 
 	/* システムコールのレジスタコンベンション
 	 * システムコール番号      rax
@@ -41,48 +284,37 @@ x86_64_dispatch_syscall(trap_context *ctx) {
 	 * 第2引数                 rsi
 	 * 第3引数                 rdx
 	 * 第4引数                 r10
-	 * 第5引数(未使用)          r8
+	 * 第5引数                 r8
 	*/
 
+	tsc = ( kstat_is_enabled() ) ? ( rdtsc() ) : ( 0 );
+
 	no = ctx->rax;
+	args[0] = ctx->rdi;
+	args[1] = ctx->rsi;
+	args[2] = ctx->rdx;
+	args[3] = ctx->r10;
+	args[4] = ctx->r8;
+
 	switch( no ) {
 
-	case SYS_YATOS_EV_REG_EVHANDLER:
-		rc = svc_register_common_event_handler((void *)ctx->rdi);
-		ctx->rax = (uint64_t)rc;
-		break;
 	case SYS_YATOS_EV_RETURN:
 		_x86_64_return_from_event_handler((event_frame *)ctx->rdi, ctx);
 		break;
-	case SYS_YATOS_THR_YIELD:
-		rc = svc_thr_yield();
-		ctx->rax = (uint64_t)rc;
+	case SYS_YATOS_BATCH:
+		ctx->rax = (uint64_t)dispatch_batch((svc_batch_entry *)args[0], 
+		    args[1], args[2]);
 		break;
-	case SYS_YATOS_THR_EXIT:
-		svc_thr_exit(ctx->rdi);
-		ctx->rax = 0;
-		break;
-	case SYS_YATOS_THR_GETID:
-		ctx->rax = svc_thr_getid();
-		break;
-	case SYS_YATOS_THR_WAIT:
-		ctx->rax = svc_thr_wait((tid)ctx->rdi, (thread_wait_flags)ctx->rsi, 
-		    (tid *)ctx->rdx, (exit_code *)ctx->r10);
-		break;
-	case SYS_YATOS_LPC_SEND:
-		rc = svc_lpc_send(ctx->rdi, ctx->rsi, (void *)ctx->rdx);
-		ctx->rax = (uint64_t)rc;
-		break;
-	case SYS_YATOS_LPC_RECV:
-		rc = svc_lpc_recv(ctx->rdi, ctx->rsi, (void *)ctx->rdx, (void *)ctx->r10);
-		ctx->rax = (uint64_t)rc;
-		break;
-	case SYS_YATOS_LPC_SEND_AND_REPLY:
-		rc = svc_lpc_send_and_reply(ctx->rdi, (void *)ctx->rsi);
-		ctx->rax = (uint64_t)rc;
+	case SYS_YATOS_LPC_SHORT_SEND:
+	case SYS_YATOS_LPC_SHORT_RECV:
+	case SYS_YATOS_LPC_SHORT_CALL:
+		ctx->rax = (uint64_t)dispatch_lpc_short(no, ctx);
 		break;
 	default:
-		ctx->rax = (uint64_t)-ENOSYS;
+		ctx->rax = (uint64_t)invoke_syscall(no, &args[0]);
 		break;
 	}
+
+	if ( tsc != 0 )
+		kstat_record_syscall(no, rdtsc() - tsc);
 }
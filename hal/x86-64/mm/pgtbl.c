@@ -296,7 +296,8 @@ hal_map_user_page(vm *as, uintptr_t vaddr, uintptr_t kpaddr, vma_prot prot) {
 	uintptr_t  pte_addr;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( ( rwsem_write_locked_by_self(&as->asmtx) ) ||
+	    ( spinlock_locked_by_self(&as->pgtbl_lock) ) );
 	kassert( as->pgtbl != NULL );
 
 	page_attr = vma_prot_to_page_flags(prot);
@@ -351,7 +352,7 @@ hal_translate_user_page(vm *as, uintptr_t vaddr, uintptr_t *kvaddrp, vma_prot *p
 	pte               pte_ent;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_is_locked(&as->asmtx) );
 	kassert( as->pgtbl != NULL );
 	kassert( protp != NULL );
 
@@ -394,7 +395,8 @@ hal_unmap_user_page(vm *as, uintptr_t vaddr) {
 	pdire            pdir_ent;
 	pte               pte_ent;
 
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( ( rwsem_write_locked_by_self(&as->asmtx) ) ||
+	    ( spinlock_locked_by_self(&as->pgtbl_lock) ) );
 	kassert( as->pgtbl != NULL );
 	
 	pml4_ent = get_pml4_ent(as->pgtbl, vaddr);
@@ -463,7 +465,7 @@ hal_free_user_page_table(vm *as) {
 	pml4_tbl           *user_pml4;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 
 	if ( as->pgtbl == NULL ) 
 		return;
@@ -19,6 +19,7 @@
 #include <kern/kern_types.h>
 #include <kern/spinlock.h>
 #include <kern/queue.h>
+#include <kern/refcount.h>
 
 #include <hal/traps.h>
 #include <hal/arch-cpu.h>
@@ -54,6 +55,17 @@
 #define EV_SYS_NOTIFY  (63)
 #define EV_SYS_NR      (64)
 
+#define EV_BATCH_MAX    (32)  /*< 1回の呼出しで一括配送するイベント数の上限  */
+
+/** 集約配送(発生回数のみを通知)可能なイベント数
+ */
+#define EV_COALESCE_NR  (EV_SYS_NR)
+
+/** 集約配送可能なイベント
+    @note EV_SIG_KILLは終了コードを伝えるため集約配送しない
+ */
+#define ev_is_coalescable(ev)							( ( (ev) > EV_RESERVED ) && ( (ev) < EV_COALESCE_NR ) &&		    ( (ev) != EV_SIG_KILL ) )
+
 /** CPUによる例外送出イベント
  */
 #define ev_is_cpu_exception(ev) \
@@ -103,6 +115,7 @@ typedef struct _evinfo{
 	void            *ev_addr;  /*< 不正メモリアクセス先アドレス  */
 	event_data          data;  /*< 付帯情報                      */
 	event_data_size data_siz;  /*< 付帯情報の長さ(単位:バイト)   */
+	event_count        count;  /*< 発生回数(集約配送時)          */
 }evinfo;
 
 /** イベントマスク
@@ -111,26 +124,68 @@ typedef struct _event_mask{
 	events_map map[EV_MAP_LEN];  /*< イベントのビットマップ配列  */
 }event_mask;
 
-/** 非同期イベントキュー
+/** ユーザ空間と共有するイベントマスクページ
+    @note マスクはユーザスレッドが通常のストア命令で更新し, カーネルは
+    イベント配送時に参照する. マスク中のイベントが保留された場合,
+    カーネルはpendingを設定する. ユーザスレッドはマスク解除時に
+    pendingが設定されていればev_mask_page_syncを呼び出す.
  */
-typedef struct _event_queue{
-	spinlock                 lock;  /*< イベントキューのロック                */
-	event_mask             events;  /*< ペンディング中イベントのビットマップ  */
-	event_mask              masks;  /*< イベントマスクのビットマップ          */
-	queue        que[EV_NR_EVENT];  /*< イベントキュー                        */
-}event_queue;
+typedef struct _ev_mask_page{
+	event_mask              masks;  /*< イベントマスクのビットマップ(ユーザが更新)  */
+	volatile uint64_t     pending;  /*< マスク中のイベントが保留されている          */
+}ev_mask_page;
+
+struct _vma;
 
-/** イベントキューのノード
+struct _event_node;
+
+/** イベントキューのエントリ
+    @note 単一の配送先に送るイベントはイベントノードに埋め込まれたエントリを,
+    プロセス内の全スレッドに送るイベントはイベントノードに付随する
+    エントリ配列の要素をキューに繋ぎ, 1つのイベントノードを共有する
+ */
+typedef struct _event_ent{
+	list                link;  /*< イベントキューへのリンク  */
+	struct _event_node *node;  /*< イベントノード            */
+}event_ent;
+
+/** イベントノード
  */
 typedef struct _event_node{
-	list   link;  /*< イベントキューへのリンク  */
-	evinfo info;  /*< イベント情報              */	
+	event_ent   ent;  /*< 埋め込みエントリ                          */
+	event_ent *ents;  /*< 全スレッド配送用のエントリ配列            */
+	refcnt     refs;  /*< 参照カウンタ(エントリ/配送処理からの参照) */
+	evinfo     info;  /*< イベント情報                              */	
 }event_node;
 
+/** 非同期イベントキュー
+    @note 保留中のイベントはイベント番号の昇順(同一番号内では到着順)に
+    単一のキューに格納し, 番号ごとの保留有無をeventsで管理する.
+    集約配送されたイベントはノードを割り当てず, coalescedとcountsで管理する.
+ */
+typedef struct _event_queue{
+	spinlock                 lock;  /*< イベントキューのロック                      */
+	event_mask             events;  /*< ペンディング中イベントのビットマップ        */
+	event_mask              masks;  /*< イベントマスクのビットマップ                */
+	ev_mask_page           *upage;  /*< 共有マスクページ(カーネル仮想アドレス)      */
+	void                   *uaddr;  /*< 共有マスクページのユーザ仮想アドレス        */
+	struct _vma             *uvma;  /*< 共有マスクページの仮想アドレス領域          */
+	queue                     que;  /*< 保留中イベントのキュー(イベント番号順)      */
+	event_mask          coalesced;  /*< 集約配送で保留中のイベントのビットマップ    */
+	event_count counts[EV_COALESCE_NR]; /*< 集約配送されたイベントの発生回数        */
+	event_node              cnode;  /*< 集約イベント取り出し用ノード(スレッドのみ)  */
+	struct _evinfo        *ubatch;  /*< 一括配送先配列のユーザ仮想アドレス          */
+	obj_cnt_type        nr_ubatch;  /*< 一括配送先配列の要素数(0の場合は逐次配送)   */
+	bool              ubatch_busy;  /*< 一括配送先配列をハンドラが処理中            */
+}event_queue;
+
+
 /** イベントフレーム
  */
 typedef struct _event_frame{
 	evinfo            info;
+	obj_cnt_type  nr_infos;    /*< 一括配送したイベント数(逐次配送時は0)  */
+	evinfo          *infos;    /*< 一括配送先配列のユーザ仮想アドレス     */
 	trap_context  trap_ctx;    /*< トラップコンテキストのコピー  */
 	fpu_context  fpu_frame;    /*< FPUフレーム                   */
 }event_frame;
@@ -141,6 +196,12 @@ void ev_queue_init(event_queue *_que);
 void ev_free_pending_events(event_queue *_que);
 void ev_get_mask(event_mask *_mask);
 void ev_update_mask(struct _thread *_thr, event_mask *_mask);
+event_mask *ev_refer_mask(event_queue *_que);
+bool ev_is_masked(struct _thread *_thr, event_no _id);
+int  ev_mask_page_attach(void **_uaddrp);
+int  ev_mask_page_sync(void);
+void ev_mask_page_release(struct _thread *_thr);
+int  ev_register_batch(struct _evinfo *_uarray, obj_cnt_type _nr);
 
 void ev_mask_clr(event_mask *_maskp);
 bool ev_mask_test(event_mask *_mask, event_no _id);
@@ -155,9 +216,14 @@ int  ev_mask_find_first_bit(event_mask *_mask, event_no *_valp);
 int  ev_send(tid _dest, event_node *_node);
 void ev_send_to_process(struct _proc *_p, event_node *_node);
 int  ev_send_to_all_threads_in_process(struct _proc *_p, event_node *_node);
+int  ev_notify(tid _dest, event_no _id);
+int  ev_notify_process(struct _proc *_p, event_no _id);
 int  ev_dequeue(event_node **_nodep);
 bool ev_has_pending_events(struct _thread *_thr);
 int  ev_alloc_node(event_no id, event_node **nodep);
+void ev_put_node(event_node *_node);
+int  ev_alloc_shared_ents(event_node *_node, obj_cnt_type _nr);
+void ev_free_ent(event_ent *_ent);
 void ev_handle_exit_thread_events(void);
 
 int  kcom_handle_system_event(event_node *_node);
@@ -0,0 +1,9 @@
+#define CONFIG_OPT_FLAGS "-O0 -ggdb3"
+#define CONFIG_GENERIC_CFLAGS "-fno-pic -static -fno-builtin -fno-strict-aliasing -fno-common -nostdlib -fno-stack-protector -Wall -Wextra -Werror -Wno-address-of-packed-member"
+#define CONFIG_HAL_MAX_MB_MODULES 32
+#define CONFIG_HAL_MAX_KPARAM_LEN 128
+#define CONFIG_HAL_CFLAGS "-ffreestanding -m64 -mcmodel=large -mno-red-zone -mno-aes -mno-avx -mno-mmx -mno-sse -msoft-float -fno-asynchronous-unwind-tables -fno-omit-frame-pointer -fno-optimize-sibling-calls"
+#define CONFIG_HAL_USER_CFLAGS "-ffreestanding -m64 -mcmodel=large -mno-red-zone -fno-asynchronous-unwind-tables -fno-omit-frame-pointer -fno-optimize-sibling-calls"
+#define CONFIG_HAL_LDFLAGS "-z max-page-size=0x1000 --build-id=none"
+#define CONFIG_HAL_OPT_FLAGS "-mtune=generic"
+#define CONFIG_DBG_SERIAL_COM1 1
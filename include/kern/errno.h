@@ -47,5 +47,6 @@
 #define	ENAMETOOLONG	36	/* File name too long */
 #define	ENOLCK		37	/* No record locks available */
 #define	ENOSYS		38	/* Math result not representable */
+#define	ETIMEDOUT	110	/* Connection timed out */
 
 #endif  /*  __KERN_ERRNO_H  */
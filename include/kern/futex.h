@@ -0,0 +1,53 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Fast user-space mutex relevant definitions                        */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_FUTEX_H)
+#define  _KERN_FUTEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+#include <kern/thread-sync.h>
+
+#define FUTEX_HASH_SHIFT   (6)                      /*< ハッシュ表のサイズ(2の冪)   */
+#define FUTEX_HASH_SIZE    (1 << FUTEX_HASH_SHIFT)  /*< ハッシュ表のエントリ数      */
+#define FUTEX_INFINITE     (-1)                     /*< タイムアウトなし            */
+#define FUTEX_WAKE_ALL     (-1)                     /*< 全待ちスレッドを起床        */
+
+struct _vm;
+
+/** futex待ちハッシュ表のエントリ
+ */
+typedef struct _futex_bucket{
+	spinlock   lock;  /*< エントリのロック          */
+	queue       que;  /*< 待ちスレッドのキュー      */
+}futex_bucket;
+
+/** futex待ちスレッド情報
+    @note 待ち合わせるスレッドのスタック上に配置する
+ */
+typedef struct _futex_waiter{
+	list             link;  /*< ハッシュ表エントリへのリンク  */
+	struct _vm        *as;  /*< 待ち合わせ対象の仮想空間      */
+	void           *uaddr;  /*< 待ち合わせ対象のアドレス      */
+	sync_obj         wait;  /*< 待ち合わせ同期オブジェクト    */
+}futex_waiter;
+
+void futex_init_subsys(void);
+int futex_wait(struct _vm *_as, void *_uaddr, futex_val _val, futex_tmout _tmout);
+int futex_wake(struct _vm *_as, void *_uaddr, int _nr);
+#endif  /*  _KERN_FUTEX_H   */
@@ -21,6 +21,7 @@
 #include <kern/spinlock.h>
 #include <kern/queue.h>
 #include <kern/list.h>
+#include <kern/thread-sync.h>
 #include <kern/irq-ctrl.h>
 
 #include <hal/traps.h>
@@ -30,12 +31,18 @@
 #define  IRQHDL_FLAG_MULTI      (0x0)     /*< 多重割込みを許可する              */
 #define  IRQHDL_FLAG_EXCLUSIVE  (0x1)     /*< 多重割込みを禁止する              */
 
+#define  IRQ_THREAD_DEFAULT_PRIO (THR_MAX_PRIO - 2) /*< 割込みスレッドの既定優先度  */
+
 /** ハンドラ終了コード
  */
 typedef enum  _ihandler_res{
 	IRQHDL_RES_HANDLED=0,    /*< 処理完了                          */
-	IRQHDL_RES_NEXT=1        /*< 他のハンドラに処理を依頼          */
+	IRQHDL_RES_NEXT=1,       /*< 他のハンドラに処理を依頼          */
+	IRQHDL_RES_WAKE_THREAD=2 /*< 割込みスレッドに処理を依頼        */
 }ihandler_res;
+
+struct _thread;
+
 /** 各割込みハンドラの管理情報
  */
 typedef struct _irq_handler{
@@ -44,6 +51,15 @@ typedef struct _irq_handler{
 	private_inf   private;   /*< ハンドラ固有情報       */
 	/*<  割込みハンドラ関数    */
 	ihandler_res (*handler)(intr_no _ino, private_inf _data, void *_ctx);
+	/*<  割込みスレッド処理関数(割込みコンテキストで完結する場合はNULL)  */
+	void (*thread_fn)(intr_no _ino, private_inf _data);
+	intr_no            no;   /*< 割込み番号             */
+	struct _thread   *thr;   /*< 割込みスレッド         */
+	spinlock        tlock;   /*< 割込みスレッドのロック */
+	sync_obj         wait;   /*< 割込みスレッド待ち合わせキュー */
+	bool          pending;   /*< 割込みスレッド処理要求 */
+	bool             stop;   /*< 割込みスレッド停止要求 */
+	bool           masked;   /*< 割込みスレッドの処理完了まで割込み線をマスク中 */
 }irq_handler;
 
 /** 割込みハンドラ/コントローラ情報
@@ -73,6 +89,12 @@ int irq_register_irq_handler(intr_no _no,
     ihandler_flags _iflags, private_inf _data);
 int irq_unregister_irq_handler(intr_no _no, 
     ihandler_res (*_handler)(intr_no , private_inf , void *));
+int irq_register_threaded_irq_handler(intr_no _no, 
+    ihandler_res (*_handler)(intr_no , private_inf , void *), 
+    void (*_thread_fn)(intr_no , private_inf ), ihandler_flags _iflags,
+    private_inf _data, int _prio);
+int irq_unregister_threaded_irq_handler(intr_no _no, 
+    void (*_thread_fn)(intr_no , private_inf ));
 
 void kcom_handle_irqs(intr_no _no, void *_ctx);
 int kcom_irq_register_controller(intr_no _no, irq_cntlr *_controller);
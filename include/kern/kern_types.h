@@ -50,6 +50,9 @@ typedef int32_t          lpc_tmout;  /**< LPCのタイムアウト値
 typedef uint32_t    lpc_sync_flags;  /**< メッセージ送受信制御フラグ                  */
 typedef uint64_t       lpc_msg_loc;  /**< メッセージ本文開始位置シンボル              */
 typedef tid               endpoint;  /**< LPCの端点(pid/tid)                          */
+typedef uint64_t        lpc_req_id;  /**< LPC要求ID                                   */
+typedef uint64_t       vm_grant_id;  /**< ページグラントID                            */
+typedef uint64_t       lpc_ring_id;  /**< 共有メモリリングチャネルID                  */
 typedef uint64_t             ticks;  /**< 電源投入時からのティック発生回数            */
 typedef uint64_t         delay_cnt;  /**< ミリ秒以下のループ待ち指定値                */
 typedef uint64_t        events_map;  /**< 非同期イベントのビットマップ                */
@@ -60,4 +63,7 @@ typedef int             event_code;  /**< 非同期イベントコード番号
 typedef int             event_trap;  /**< 非同期イベントトラップ番号                  */
 typedef void *          event_data;  /**< 非同期イベント付帯情報                      */
 typedef uint64_t   event_data_size;  /**< 非同期イベント付帯情報長(単位:バイト)       */
+typedef uint32_t       event_count;  /**< 集約された非同期イベントの発生回数          */
+typedef uint32_t         futex_val;  /**< futex変数の値                               */
+typedef int32_t        futex_tmout;  /**< futex待ちのタイムアウト値                   */
 #endif  /*  _KERN_KERN_TYPES_H   */
@@ -22,7 +22,7 @@
 #include <kern/thread-sync.h>
 #include <kern/lpc.h>
 #include <kern/kresv-ids.h>
-#include <kern/rbtree.h>
+#include <kern/queue.h>
 
 #include <thr/thr-internal.h>
 
@@ -32,34 +32,65 @@
 #define KSERV_UNREG_SERVICE (1) /*<  サービスの登録を抹消する */
 #define KSERV_LOOKUP        (2) /*< サービスを検索する        */
 
+#define KSERV_HASH_SHIFT    (5)                         /*< ハッシュ表サイズ(2の冪)  */
+#define KSERV_HASH_SIZE     (1 << KSERV_HASH_SHIFT)     /*< ハッシュ表のエントリ数   */
+
+#define KSERV_HASH_FNV_BASIS  (0xcbf29ce484222325ULL)  /*< FNV-1aの初期値  */
+#define KSERV_HASH_FNV_PRIME  (0x100000001b3ULL)       /*< FNV-1aの乗数    */
+
+typedef uint64_t kserv_hash;  /*< サービス名のハッシュ値      */
+typedef uint64_t   kserv_gen;  /*< サービス登録解除の世代番号  */
+
 struct _thread;
-struct _kern_service;
 
 /** カーネルサービスデータベース
  */
 typedef struct _kserv_db{
-	spinlock                           lock;  /*< ロック変数                */
-	struct _thread                     *thr;  /*< ネームサービススレッド    */
-	RB_HEAD(kserv_tree, _kern_service) head;  /*< カーネルサービスのヘッド  */
+	spinlock                           lock;  /*< ロック変数                        */
+	struct _thread                     *thr;  /*< ネームサービススレッド            */
+	volatile kserv_gen                  gen;  /*< 登録解除の度に更新する世代番号    */
+	queue             head[KSERV_HASH_SIZE];  /*< カーネルサービスのハッシュ表      */
 }kserv_db;
 
-#define __KSERV_DB_INITIALIZER(root)		\
+#define __KSERV_DB_INITIALIZER		        \
 	{					\
 		.lock = __SPINLOCK_INITIALIZER,	\
 		.thr    = NULL,		        \
-		.head   =RB_INITIALIZER(root),  \
+		.gen    = 0,		        \
 	}
 
 /** カーネルサービス情報
  */
 typedef struct _kern_service{
-	RB_ENTRY(_kern_service) node;  /*< 赤黒木のノード              */
+	list                    link;  /*< ハッシュ表のリンク          */
+	kserv_hash              hash;  /*< サービス名のハッシュ値      */
 	char    name[KSERV_NAME_LEN];  /*< サービス名                  */
 	endpoint                  id;  /*< サービス提供元への通信端点  */
 }kern_service;
 
+/** サービス名のハッシュ値を算出する(FNV-1a)
+    @param[in] name サービス名
+    @return サービス名のハッシュ値
+    @note ユーザライブラリの名前解決キャッシュと共用する
+ */
+static inline kserv_hash
+kserv_name_hash(const char *name) {
+	kserv_hash         h;
+	const char        *p;
+
+	for( h = KSERV_HASH_FNV_BASIS, p = name;
+	     ( *p != '\0' ) && ( ( p - name ) < ( KSERV_NAME_LEN - 1 ) ); ++p) {
+
+		h ^= (uint8_t)*p;
+		h *= KSERV_HASH_FNV_PRIME;
+	}
+
+	return h;
+}
+
 void kernel_name_service_init(void);
-int kns_register_kernel_service(const char *_name);
+int kns_register_kernel_service(const char *_name, endpoint _id);
 int kns_unregister_kernel_service(const char *_name);
 int kns_lookup_service_by_name(const char *_name, endpoint *_ep);
+kserv_gen kns_current_generation(void);
 #endif  /*  _KERN_KNAME_SERVICE_H   */
@@ -16,13 +16,12 @@
 #include <kern/param.h>
 
 #define ID_RESV_IDLE        (0)  /*< アイドルスレッド用に予約            */
-#define ID_RESV_REAPER      (1)  /*< reaperスレッド用に予約              */
-#define ID_RESV_NAME_SERV   (2)  /*< ネームサービススレッド用に予約      */
-#define ID_RESV_DBG_CONSOLE (3)  /*< デバッグコンソールサービス用に予約  */
-#define ID_RESV_THR         (4)  /*< THRサービス用に予約                 */
-#define ID_RESV_PROC        (5)  /*< PROCサービス用に予約                */
-#define ID_RESV_VM          (6)  /*< VMサービス用に予約                  */
-#define ID_NR_RESVED        (7)  /*< 予約ID数                            */
+#define ID_RESV_NAME_SERV   (1)  /*< ネームサービススレッド用に予約      */
+#define ID_RESV_DBG_CONSOLE (2)  /*< デバッグコンソールサービス用に予約  */
+#define ID_RESV_THR         (3)  /*< THRサービス用に予約                 */
+#define ID_RESV_PROC        (4)  /*< PROCサービス用に予約                */
+#define ID_RESV_VM          (5)  /*< VMサービス用に予約                  */
+#define ID_NR_RESVED        (6)  /*< 予約ID数                            */
 #define ID_RESV_INVALID     (MAX_OBJ_ID)  /*< 不正ID  */
 
 #define ID_RESV_NAME_DBG_CONSOLE "DebugConsole"
@@ -33,4 +32,6 @@
 #define KSERV_NAME_SERV_PRIO (THR_MAX_PRIO - 4)
 #define KSERV_DBG_CONS_PRIO  (THR_MAX_PRIO - 5)
 #define KSERV_KSERVICE_PRIO  (THR_MAX_PRIO - 5)
+
+#define KSERV_NR_RECEIVERS   (2)  /*< ポートを共有するサービススレッド数  */
 #endif  /*  _KERN_KRESV_IDS_H   */
@@ -0,0 +1,72 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  kernel statistics relevant definitions                            */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_KSTAT_H)
+#define  _KERN_KSTAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/svc.h>
+
+#define KSTAT_HIST_NR        (32)                   /*< 遅延ヒストグラムのバケット数(log2)  */
+#define KSTAT_NR_SYSCALLS    (SYS_YATOS_MAX_NOSYS)  /*< 計測対象システムコール数            */
+#define KSTAT_NR_TRAPS       (256)                  /*< 計測対象トラップ数                  */
+
+/** ページフォルト処理結果
+ */
+#define KSTAT_PGFLT_DEMAND   (0)  /*< デマンドページングによる割当て  */
+#define KSTAT_PGFLT_STACK    (1)  /*< スタック伸長                    */
+#define KSTAT_PGFLT_SEGV     (2)  /*< 不正アクセス                    */
+#define KSTAT_PGFLT_NR       (3)  /*< 処理結果の種類数                */
+
+/** 統計情報操作コマンド
+ */
+#define KSTAT_CTRL_DISABLE   (0)  /*< 統計情報採取停止              */
+#define KSTAT_CTRL_ENABLE    (1)  /*< 統計情報採取開始              */
+#define KSTAT_CTRL_RESET     (2)  /*< 統計情報クリア                */
+#define KSTAT_CTRL_SHOW      (3)  /*< 統計情報をコンソールに出力    */
+
+/** 統計情報の種別
+ */
+#define KSTAT_KIND_SYSCALL   (0)  /*< システムコール            */
+#define KSTAT_KIND_TRAP      (1)  /*< トラップ/割込み           */
+#define KSTAT_KIND_PGFLT     (2)  /*< ページフォルト処理結果    */
+
+/** 処理回数と処理時間
+    @note hist[i]には処理時間(TSCカウント)が[2^i, 2^(i+1))の範囲にある
+    処理の回数を格納する(hist[0]は2未満を含む)
+ */
+typedef struct _kstat_latency{
+	uint64_t                 count;  /*< 処理回数                  */
+	uint64_t                 total;  /*< 処理時間の合計            */
+	uint64_t   hist[KSTAT_HIST_NR];  /*< 処理時間のヒストグラム    */
+}kstat_latency;
+
+/** ページフォルト処理結果の統計
+ */
+typedef struct _kstat_pgflt{
+	uint64_t   count[KSTAT_PGFLT_NR];  /*< 処理結果ごとの発生回数  */
+}kstat_pgflt;
+
+void kstat_init_subsys(void);
+bool kstat_is_enabled(void);
+int kstat_control(int _cmd);
+void kstat_record_syscall(uint64_t _no, uint64_t _cycles);
+void kstat_record_trap(uint64_t _trapno, uint64_t _cycles);
+void kstat_record_pgflt(int _outcome);
+int kstat_get_latency(int _kind, uint64_t _no, kstat_latency *_res);
+void kstat_get_pgflt(kstat_pgflt *_res);
+void kstat_show(void);
+#endif  /*  _KERN_KSTAT_H   */
@@ -0,0 +1,111 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Shared memory ring channel relevant definitions                   */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_LPC_RING_H)
+#define  _KERN_LPC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/spinlock.h>
+#include <kern/list.h>
+#include <kern/rbtree.h>
+#include <kern/refcount.h>
+#include <kern/thread-sync.h>
+#include <kern/mutex.h>
+
+#define LPC_RING_ID_NONE     (0)   /*< 無効なチャネルID                          */
+#define LPC_RING_MIN_PAGES   (2)   /*< チャネルのページ数の下限(制御域+リング)   */
+#define LPC_RING_MAX_PAGES   (16)  /*< チャネルのページ数の上限                  */
+
+#define LPC_RING_SQ          (0)   /*< 要求(サブミッション)リング                */
+#define LPC_RING_CQ          (1)   /*< 完了(コンプリーション)リング              */
+#define LPC_RING_NR          (2)   /*< チャネルあたりのリング数                  */
+
+#define LPC_RING_CREATOR     (0)   /*< チャネル生成者のマップ情報                */
+#define LPC_RING_PEER        (1)   /*< 接続先のマップ情報                        */
+
+#define LPC_RING_ENT_WORDS   (4)   /*< リングエントリの語数                      */
+
+/** リングエントリ
+ */
+typedef struct _lpc_ring_ent{
+	uint64_t w[LPC_RING_ENT_WORDS];  /*< エントリの内容  */
+}lpc_ring_ent;
+
+/** リングの位置情報
+    @note 生産者はtailを, 消費者はheadを更新する.
+    消費者がカーネル内で待ち合わせる間はwaitingが非0になり,
+    生産者は空から非空になったリングについてのみカーネルを呼び出す.
+ */
+typedef struct _lpc_ring_idx{
+	volatile uint64_t      head;  /*< 次に取り出すエントリの通番          */
+	volatile uint64_t      tail;  /*< 次に格納するエントリの通番          */
+	volatile uint64_t   waiting;  /*< 消費者が待ち合わせ中                */
+	uint64_t            nr_ents;  /*< エントリ数(2の冪)                   */
+	uint64_t             offset;  /*< チャネル先頭からのエントリ配列位置  */
+	uint64_t            pad[3];   /*< キャッシュライン境界への詰め物      */
+}lpc_ring_idx;
+
+/** チャネル制御域(チャネルの先頭ページに配置)
+ */
+typedef struct _lpc_ring_ctrl{
+	lpc_ring_idx idx[LPC_RING_NR];  /*< 各リングの位置情報  */
+}lpc_ring_ctrl;
+
+struct _vm;
+struct _vma;
+
+/** リングチャネル
+ */
+typedef struct _lpc_ring{
+	RB_ENTRY(_lpc_ring)                node;  /*< チャネル表のノード              */
+	list                               link;  /*< 破棄処理用のリンク              */
+	refcnt                             refs;  /*< 参照カウンタ                    */
+	spinlock                           lock;  /*< 待ち合わせ用のロック            */
+	lpc_ring_id                          id;  /*< チャネルID                      */
+	endpoint                           peer;  /*< 接続を許可するエンドポイント    */
+	bool                               dead;  /*< 破棄済み                        */
+	struct _vm          *as[LPC_RING_NR];     /*< マップ先の仮想空間              */
+	struct _vma        *vma[LPC_RING_NR];     /*< マップ先の仮想アドレス領域      */
+	sync_obj           wait[LPC_RING_NR];     /*< リングごとの消費者待ちキュー    */
+	obj_cnt_type                   nr_pages;  /*< ページ数                        */
+	void                          *pages[];   /*< ページのカーネル仮想アドレス    */
+}lpc_ring;
+
+/** チャネル表
+ */
+typedef struct _lpc_ring_db{
+	spinlock                           lock;  /*< チャネル表のロック       */
+	mutex                         unmap_mtx;  /*< アンマップと仮想空間破棄の排他 */
+	lpc_ring_id                     next_id;  /*< 次に割り当てるチャネルID */
+	RB_HEAD(lpc_ring_tree, _lpc_ring)  head;  /*< チャネル表               */
+}lpc_ring_db;
+
+#define __LPC_RING_DB_INITIALIZER(_db)		\
+	{					\
+		.lock = __SPINLOCK_INITIALIZER,	\
+		.unmap_mtx = __MUTEX_INITIALIZER((_db).unmap_mtx, MTX_FLAG_EXCLUSIVE), \
+		.next_id = LPC_RING_ID_NONE + 1,\
+		.head   =RB_INITIALIZER(&(_db).head),  \
+	}
+
+int lpc_ring_create(endpoint _peer, obj_cnt_type _nr_pages, void *_addr,
+    lpc_ring_id *_idp);
+int lpc_ring_attach(lpc_ring_id _id, void *_addr);
+int lpc_ring_notify(lpc_ring_id _id, int _ring);
+int lpc_ring_wait(lpc_ring_id _id, int _ring, lpc_tmout _tmout);
+int lpc_ring_destroy(lpc_ring_id _id);
+void lpc_ring_release_as(struct _vm *_as);
+#endif  /*  _KERN_LPC_RING_H   */
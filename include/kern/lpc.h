@@ -21,6 +21,8 @@
 #include <kern/spinlock.h>
 #include <kern/queue.h>
 #include <kern/thread-sync.h>
+#include <kern/refcount.h>
+#include <kern/rbtree.h>
 #include <kern/messages.h>
 #include <kern/kresv-ids.h>
 
@@ -28,9 +30,50 @@
 #define LPC_INFINITE   (-1)            /*< ブロック通信                        */
 #define LPC_RECV_ANY   (ID_RESV_IDLE)  /*< 任意のスレッドからの送信を受け付け  */
 
+#define LPC_PORT_ANY      (ID_RESV_INVALID)  /*< ポートIDを自動割り当てする     */
+#define LPC_PORT_ID_BASE  (0x100000000ULL)   /*< 自動割り当てするポートIDの下限  */
+
+#define LPC_MSG_TYPE_NORMAL  (0x1)     /*< 通常メッセージ(msg_body全体を複写)  */
+#define LPC_MSG_TYPE_SHORT   (0x2)     /*< 短メッセージ(レジスタ渡し)          */
+#define LPC_MSG_TYPE_ANY     ( LPC_MSG_TYPE_NORMAL | LPC_MSG_TYPE_SHORT )
+
+#define LPC_MSG_FLAG_NONE    (0x0)     /*< 同期送信メッセージ                  */
+#define LPC_MSG_FLAG_ASYNC   (0x1)     /*< 非同期送信メッセージ                */
+#define LPC_MSG_FLAG_SRC_HEAD (0x2)    /*< 送信元索引に登録された先頭メッセージ  */
+
+#define LPC_REQ_ID_NONE          (0)   /*< 要求IDなし                          */
+#define LPC_WAIT_MAX_ENDPOINTS   (16)  /*< 多重待ち合わせ可能なエンドポイント数  */
+#define LPC_WAIT_READY_EVENT     (1ULL << 63)  /*< イベント受信可能を示すビット  */
+#define LPC_ASYNC_DEFAULT_DEPTH  (8)   /*< 非同期送信メッセージの既定の最大滞留数  */
+
+typedef uint32_t lpc_msg_type;         /*< メッセージ種別                      */
+typedef uint32_t lpc_msg_flags;        /*< メッセージ属性                      */
+
 struct _thread;
+struct _msg;
+struct _lpc_async_ctx;
+
+/** 多重待ち合わせスレッド
+    @note 待ち合わせるスレッドのスタック上に配置する
+ */
+typedef struct _lpc_waiter{
+	spinlock         lock;  /*< 待ち合わせ状態のロック                 */
+	sync_obj         wait;  /*< 待ち合わせ同期オブジェクト             */
+	bool            fired;  /*< 待ち合わせ登録後にメッセージが到着した */
+}lpc_waiter;
+
+/** 多重待ち合わせ登録情報
+    @note 待ち合わせ対象のメッセージキュー毎に登録する
+ */
+typedef struct _lpc_watch{
+	list             link;  /*< メッセージキューの監視者キューへのリンク  */
+	lpc_waiter    *waiter;  /*< 待ち合わせスレッド                        */
+}lpc_watch;
 
 /** メッセージキュー
+    @note 到着順のキューに加えて, 送信元毎の先頭メッセージを登録した
+    送信元索引を持つ. 同一送信元の後続メッセージは先頭メッセージから
+    到着順に環状リストでつなぐ.
  */
 typedef struct  _msg_queue{
 	spinlock          lock;  /*< メッセージキューのロック                        */
@@ -38,23 +81,99 @@ typedef struct  _msg_queue{
 	struct _thread  *owner;  /*< キューのオーナー                                */
 	sync_obj   wait_sender;  /*< 受付け待ちオブジェクト(受信者をキューイング)    */
 	sync_obj wait_reciever;  /*< 送信開始待ちオブジェクト(送信者をキューイング)  */
+	obj_cnt_type  nr_async;  /*< 滞留している非同期送信メッセージ数              */
+	obj_cnt_type async_limit;  /*< 非同期送信メッセージの最大滞留数(クレジット)  */
+	RB_HEAD(lpc_src_tree, _msg) srcidx;  /*< 送信元索引                          */
+	queue         watchers;  /*< 多重待ち合わせ中のスレッドの登録情報            */
+	bool              dead;  /*< キューが破棄された                              */
 }msg_queue;
 
 /** メッセージ
  */
 typedef struct  _msg{
 	list                link;  /*< メッセージキューへのリンク                     */
+	RB_ENTRY(_msg)     snode;  /*< 送信元索引のノード(送信元毎の先頭のみ)         */
+	list               slink;  /*< 同一送信元のメッセージをつなぐ環状リスト       */
 	struct   _msg_queue  *qp;  /*< キューイング先のメッセージキュー               */
 	endpoint             src;  /*< 送信元エンドポイント                           */
 	endpoint            dest;  /*< 送信元エンドポイント                           */
+	lpc_msg_type        type;  /*< メッセージ種別                                 */
+	lpc_msg_flags      flags;  /*< メッセージ属性                                 */
+	lpc_req_id        req_id;  /*< 要求ID                                         */
+	thr_prio            prio;  /*< 送信者の優先度                                 */
+	int               status;  /*< 非同期送信の配送結果                           */
+	struct _lpc_async_ctx *actx;  /*< 非同期送信の完了通知先(参照を保持)          */
 	spinlock          cqlock;  /*< 送信完了待ちキューのロック                     */
 	sync_obj      completion;  /*< 送信完了待ちオブジェクト(送信者をキューイング) */
 	msg_body            body;  /*< メッセージの本体                               */
 }msg;
 
+/** 非同期送信完了通知キュー
+    @note 受信された非同期送信メッセージは, 配送結果を格納して送信者の
+    完了通知キューに移され, 送信者が結果を回収した時点で解放される.
+    完了通知キューは所有スレッドと未完了の非同期送信メッセージから参照され,
+    最後の参照が解放された時点で解放される. 送信元のスレッドIDが
+    再利用されても, 完了通知は元の送信者のキューに配送される.
+ */
+typedef struct _lpc_async_ctx{
+	spinlock          lock;  /*< 完了通知キューのロック                   */
+	refcnt            refs;  /*< 参照カウンタ                             */
+	queue             cmpl;  /*< 完了通知キュー                           */
+	sync_obj          wait;  /*< 完了通知待ちオブジェクト                 */
+	lpc_req_id     next_id;  /*< 次に割り当てる要求ID(所有スレッドのみ更新)  */
+	bool              dead;  /*< 所有スレッドが終了した                   */
+}lpc_async_ctx;
+
+/** ポート
+    @note 複数の受信スレッドが待ち合わせ可能なエンドポイント
+ */
+typedef struct _lpc_port{
+	RB_ENTRY(_lpc_port)  node;  /*< ポート表のノード                 */
+	endpoint               id;  /*< ポートのエンドポイント           */
+	refcnt               refs;  /*< 参照カウンタ                     */
+	msg_queue            mque;  /*< メッセージキュー                 */
+}lpc_port;
+
+/** ポート表
+ */
+typedef struct _lpc_port_db{
+	spinlock                          lock;  /*< ポート表のロック             */
+	endpoint                       next_id;  /*< 次に割り当てるポートID       */
+	RB_HEAD(lpc_port_tree, _lpc_port) head;  /*< ポート表                     */
+}lpc_port_db;
+
+#define __LPC_PORT_DB_INITIALIZER(root)		\
+	{					\
+		.lock = __SPINLOCK_INITIALIZER,	\
+		.next_id = LPC_PORT_ID_BASE,    \
+		.head   =RB_INITIALIZER(root),  \
+	}
+
 void lpc_msg_queue_init(struct _msg_queue *_que);
+void lpc_msg_slot_init(struct _msg *_m);
 void lpc_destroy_msg_queue(msg_queue *_que);
 int lpc_send(endpoint _dest, lpc_tmout _tmout, void *_m);
 int lpc_recv(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_msg_src);
 int lpc_send_and_reply(endpoint _dest, void *_m);
+int lpc_recv_msg(endpoint _src, lpc_tmout _tmout, msg_body *_m, endpoint *_msg_src,
+    lpc_msg_type *_typep);
+int lpc_send_short(endpoint _dest, lpc_tmout _tmout, lpc_short_msg *_sm);
+int lpc_recv_short(endpoint _src, lpc_tmout _tmout, lpc_short_msg *_sm, endpoint *_msg_src);
+int lpc_short_call(endpoint _dest, lpc_short_msg *_sm);
+int lpc_send_async(endpoint _dest, void *_m, lpc_req_id *_idp);
+int lpc_async_wait(lpc_tmout _tmout, lpc_req_id *_idp, int *_statusp);
+int lpc_recv_req(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_msg_src,
+    lpc_req_id *_reqp);
+int lpc_set_async_depth(endpoint _ep, obj_cnt_type _depth);
+int lpc_recv_batch(endpoint _src, lpc_tmout _tmout, lpc_batch_ent *_ents, int _nr);
+int lpc_reply_batch(lpc_batch_ent *_ents, int _nr);
+int lpc_wait_any(endpoint *_eps, int _nr, lpc_tmout _tmout, uint64_t *_readyp);
+void lpc_async_ctx_init(lpc_async_ctx **_ctxp);
+void lpc_async_ctx_destroy(lpc_async_ctx **_ctxp);
+int lpc_port_recv_msg(endpoint _port, endpoint _src, lpc_tmout _tmout, msg_body *_m, 
+    endpoint *_msg_src, lpc_msg_type *_typep);
+int lpc_port_create(endpoint _id, endpoint *_portp);
+int lpc_port_destroy(endpoint _port);
+lpc_port *lpc_port_get(endpoint _port);
+void lpc_port_put(lpc_port *_port);
 #endif  /*  _KERN_LPC_H   */
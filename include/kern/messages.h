@@ -22,6 +22,16 @@
 #include <kern/vm-service.h>
 #include <kern/thread-service.h>
 
+#define LPC_SHORT_NR_WORDS  (5)  /*< 短メッセージの語数(レジスタ渡し)              */
+#define LPC_SHORT_REQ_WORD  (0)  /*< 要求コード(要求時)/処理結果(応答時)の格納位置  */
+
+/** 短メッセージ
+    @note システムコールの引数レジスタで受け渡しを行う
+ */
+typedef struct _lpc_short_msg{
+	uint64_t w[LPC_SHORT_NR_WORDS];  /*< メッセージ本体  */
+}lpc_short_msg;
+
 typedef struct _pri_string{
 	int    req;
 	int     rc;
@@ -35,6 +45,7 @@ typedef struct _kname_service_msg{
 	const char *name;
 	size_t       len;
 	int           rc;
+	uint64_t     gen;
 }kname_service_msg;
 
 typedef union _msg_body{
@@ -43,5 +54,17 @@ typedef union _msg_body{
 	thr_service            thr_msg;
 	proc_service          proc_msg;
 	vm_service              vm_msg;
+	lpc_short_msg        short_msg;
 }msg_body;
+
+#define LPC_BATCH_MAX_ENTRIES   (32)  /*< 一括送受信可能なメッセージ数の上限  */
+
+/** メッセージ一括送受信エントリ
+ */
+typedef struct _lpc_batch_ent{
+	endpoint        peer;  /*< 受信時: 送信元, 応答時: 応答先エンドポイント  */
+	lpc_req_id    req_id;  /*< 要求ID                                        */
+	int               rc;  /*< 応答時の送信結果                              */
+	msg_body        body;  /*< メッセージ本体                                */
+}lpc_batch_ent;
 #endif  /*  _KERN_MESSAGES_H   */
@@ -33,6 +33,16 @@ typedef struct _mutex{
 	struct _thread *owner;
 }mutex;
 
+#define __MUTEX_INITIALIZER(_mtx, _mtx_flags)				\
+	{								\
+	.lock = __SPINLOCK_INITIALIZER,					\
+	.mutex_waiter = __SYNC_OBJECT_INITIALIZER((_mtx).mutex_waiter,	\
+	    SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT),			\
+	.mtx_flags = (_mtx_flags),					\
+	.counter = 0,							\
+	.owner = NULL,							\
+	}
+
 void mutex_init(mutex *_mtx, mutex_flags _mtx_flags);
 void mutex_destroy(mutex *_mtx);
 bool mutex_lock(mutex *_mtx);
@@ -29,6 +29,7 @@ typedef enum _proc_serv_sendev_type{
 	PROC_SERV_SNDEV_THR=0,    /*<  スレッド固有イベント  */
 	PROC_SERV_SNDEV_PROC=1,   /*<  プロセス内共有イベント  */
 	PROC_SERV_SNDEV_ALLTHR=2, /*<  プロセス内スレッドへの同報イベント  */
+	PROC_SERV_SNDEV_NOTIFY=3, /*<  スレッドへの集約配送イベント  */
 }proc_serv_sendev_type;
 typedef struct _proc_sys_send_event{
 	tid                   dest;
@@ -32,6 +32,11 @@ typedef enum _proc_state{
 	PROC_PSTATE_EXIT=2,        /*< 終了                        */
 }proc_state;
 
+#define PROC_CAP_NONE   (0x0)  /*< 特権なし                              */
+#define PROC_CAP_KSTAT  (0x1)  /*< カーネル統計情報の採取状態を変更できる  */
+
+#define PROC_CAP_OPT_KSTAT  "kstat"  /*< PROC_CAP_KSTATを付与するブートオプション  */
+
 struct _thread;
 struct _vma;
 /** プロセス
@@ -42,6 +47,7 @@ typedef struct _proc{
 	RB_ENTRY(_proc)    mnode;  /*< プロセス一覧の赤黒木のノード  */
 	pid                  pid;  /*< プロセスID                    */
 	proc_state        status;  /*< プロセスの状態                */
+	uint32_t            caps;  /*< プロセスの特権                */
 	void              *entry;  /*< 開始アドレス                  */
 	vm                    vm;  /*< 仮想アドレス空間              */
 	struct _thread   *master;  /*< マスタスレッド                */
@@ -73,6 +79,7 @@ int proc_start(proc *_proc);
 int proc_destroy(proc *_proc);
 int proc_expand_stack(proc *_p, void *_new_top);
 int proc_expand_heap(proc *_p, void *_new_heap_end, void **_old_heap_endp);
+int proc_sbrk(proc *_p, intptr_t _inc, void **_old_heap_endp);
 bool active_proc_locked_by_self(void);
 void acquire_active_proc_lock(intrflags *_flags);
 void release_active_proc_lock(intrflags *_flags);
@@ -127,6 +127,8 @@ typedef struct _queue{
 
 void queue_add(struct _queue *, list *);
 void queue_add_top(struct _queue *, list *);
+void queue_insert_after(list *, list *);
+void queue_insert_before(list *, list *);
 struct _list *queue_ref_top(struct _queue *);
 struct _list *queue_get_top(struct _queue *);
 struct _list *queue_ref_last(struct _queue *);
@@ -0,0 +1,48 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  reader-writer semaphore relevant definitions                      */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_RWSEM_H)
+#define  _KERN_RWSEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/spinlock.h>
+#include <kern/thread-sync.h>
+
+struct _thread;
+
+/** 読み書きセマフォ
+    @note 書き込み待ちスレッドが存在する間は新たな読み込みロックを獲得させない
+    (書き込み優先). 解放時には待ちスレッドにロックを直接引き渡す.
+ */
+typedef struct _rwsem{
+	spinlock               lock;  /*< セマフォのロック                  */
+	sync_obj          rd_waiter;  /*< 読み込みロック待ちキュー          */
+	sync_obj          wr_waiter;  /*< 書き込みロック待ちキュー          */
+	obj_cnt_type        readers;  /*< 読み込みロック保持スレッド数      */
+	obj_cnt_type     rd_waiting;  /*< 読み込みロック待ちスレッド数      */
+	obj_cnt_type     wr_waiting;  /*< 書き込みロック待ちスレッド数      */
+	struct _thread       *owner;  /*< 書き込みロック保持スレッド        */
+}rwsem;
+
+void rwsem_init(rwsem *_sem);
+void rwsem_destroy(rwsem *_sem);
+bool rwsem_down_read(rwsem *_sem);
+void rwsem_up_read(rwsem *_sem);
+bool rwsem_down_write(rwsem *_sem);
+void rwsem_up_write(rwsem *_sem);
+bool rwsem_is_locked(rwsem *_sem);
+bool rwsem_write_locked_by_self(rwsem *_sem);
+#endif  /*  _KERN_RWSEM_H   */
@@ -21,5 +21,6 @@
 #include <kern/thread.h>
 
 void sched_schedule(void);
+void sched_set_prio(thread *_thr, thr_prio _prio);
 void sched_init_subsys(void);
 #endif  /*  _KERN_SCHED_H   */
@@ -0,0 +1,47 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Soft interrupt relevant definitions                               */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_SOFTIRQ_H)
+#define  _KERN_SOFTIRQ_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+
+#define SOFTIRQ_BATCH_MAX   (16)  /*< 割込み出口1回あたりの最大処理数  */
+
+/** 遅延割込み処理要求
+ */
+typedef struct _softirq_work{
+	list                      link;  /*< 遅延処理キューへのリンク  */
+	bool                    queued;  /*< キュー登録中              */
+	void (*func)(private_inf _data); /*< 遅延処理関数              */
+	private_inf               data;  /*< 遅延処理関数の引数        */
+}softirq_work;
+
+/** CPUごとの遅延割込み処理キュー
+ */
+typedef struct _softirq_cpu{
+	queue                      que;  /*< 遅延処理要求のキュー      */
+	bool                   running;  /*< 遅延処理実行中            */
+}softirq_cpu;
+
+void softirq_init_work(softirq_work *_work, void (*_func)(private_inf _data),
+    private_inf _data);
+bool softirq_raise(softirq_work *_work);
+void softirq_run_pending(void);
+void softirq_init_subsys(void);
+#endif  /*  _KERN_SOFTIRQ_H   */
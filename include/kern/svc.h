@@ -29,7 +29,55 @@
 #define SYS_YATOS_LPC_SEND           (7)
 #define SYS_YATOS_LPC_RECV           (8)
 #define SYS_YATOS_LPC_SEND_AND_REPLY (9)
-#define SYS_YATOS_MAX_NOSYS          (10)
+#define SYS_YATOS_FUTEX_WAIT         (10)
+#define SYS_YATOS_FUTEX_WAKE         (11)
+#define SYS_YATOS_KSTAT_CTRL         (12)
+#define SYS_YATOS_KSTAT_GET          (13)
+#define SYS_YATOS_BATCH              (14)
+#define SYS_YATOS_LPC_SHORT_SEND     (15)
+#define SYS_YATOS_LPC_SHORT_RECV     (16)
+#define SYS_YATOS_LPC_SHORT_CALL     (17)
+#define SYS_YATOS_LPC_SEND_ASYNC     (18)
+#define SYS_YATOS_LPC_ASYNC_WAIT     (19)
+#define SYS_YATOS_LPC_RECV_REQ       (20)
+#define SYS_YATOS_LPC_RECV_BATCH     (21)
+#define SYS_YATOS_LPC_REPLY_BATCH    (22)
+#define SYS_YATOS_LPC_WAIT_ANY       (23)
+#define SYS_YATOS_VM_GRANT           (24)
+#define SYS_YATOS_VM_GRANT_MAP       (25)
+#define SYS_YATOS_VM_GRANT_UNMAP     (26)
+#define SYS_YATOS_VM_GRANT_REVOKE    (27)
+#define SYS_YATOS_LPC_RING_CREATE    (28)
+#define SYS_YATOS_LPC_RING_ATTACH    (29)
+#define SYS_YATOS_LPC_RING_NOTIFY    (30)
+#define SYS_YATOS_LPC_RING_WAIT      (31)
+#define SYS_YATOS_LPC_RING_DESTROY   (32)
+#define SYS_YATOS_KNS_GENERATION     (33)
+#define SYS_YATOS_VM_SBRK            (34)
+#define SYS_YATOS_VM_MAP_ANON        (35)
+#define SYS_YATOS_VM_UNMAP_ANON      (36)
+#define SYS_YATOS_EV_MASK_ATTACH     (37)
+#define SYS_YATOS_EV_MASK_SYNC       (38)
+#define SYS_YATOS_EV_REG_BATCH       (39)
+#define SYS_YATOS_MAX_NOSYS          (40)
+
+#define SVC_BATCH_MAX_ENTRIES        (32)  /*< 一括処理可能な要求数の上限    */
+#define SVC_BATCH_NR_ARGS            (5)   /*< 要求あたりの引数の数          */
+
+#define SVC_BATCH_FLAG_NONE          (0)   /*< 全要求を処理する              */
+#define SVC_BATCH_FLAG_STOP_ON_ERROR (1)   /*< エラー発生時に処理を打ち切る  */
+
+/** システムコール一括処理要求
+ */
+typedef struct _svc_batch_entry{
+	uint64_t                       no;  /*< システムコール番号        */
+	uint64_t  args[SVC_BATCH_NR_ARGS];  /*< システムコール引数        */
+	int64_t                       res;  /*< システムコールの返り値    */
+}svc_batch_entry;
+
+struct _lpc_short_msg;
+struct _lpc_batch_ent;
+struct _evinfo;
 
 int svc_register_common_event_handler(void *_u_evhandler);
 int svc_thr_yield(void);
@@ -39,4 +87,38 @@ int svc_thr_wait(tid _wait_tid, thread_wait_flags _user_wflags, tid *_user_exit_
 int svc_lpc_send(endpoint _dest, lpc_tmout _tmout, void *_m);
 int svc_lpc_recv(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_msg_src);
 int svc_lpc_send_and_reply(endpoint _dest, void *_m);
+int svc_lpc_short_send(endpoint _dest, struct _lpc_short_msg *_sm);
+int svc_lpc_short_recv(endpoint _src, lpc_tmout _tmout, struct _lpc_short_msg *_sm,
+    endpoint *_msg_src);
+int svc_lpc_short_call(endpoint _dest, struct _lpc_short_msg *_sm);
+int svc_lpc_send_async(endpoint _dest, void *_m, lpc_req_id *_idp);
+int svc_lpc_async_wait(lpc_tmout _tmout, lpc_req_id *_idp, int *_statusp);
+int svc_lpc_recv_req(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_msg_src,
+    lpc_req_id *_reqp);
+int svc_lpc_recv_batch(endpoint _src, lpc_tmout _tmout, struct _lpc_batch_ent *_ents,
+    int _nr);
+int svc_lpc_reply_batch(struct _lpc_batch_ent *_ents, int _nr);
+int svc_lpc_wait_any(endpoint *_eps, int _nr, lpc_tmout _tmout, uint64_t *_readyp);
+int svc_vm_grant(endpoint _grantee, void *_start, size_t _size, vma_prot _prot,
+    vm_grant_id *_idp);
+int svc_vm_grant_map(vm_grant_id _id, void *_addr, vma_prot _prot);
+int svc_vm_grant_unmap(vm_grant_id _id);
+int svc_vm_grant_revoke(vm_grant_id _id);
+int svc_vm_sbrk(intptr_t _inc, void **_uoldp);
+int svc_vm_map_anon(void *_addr, size_t _size, vma_prot _prot, void **_uaddrp);
+int svc_vm_unmap_anon(void *_addr, size_t _size);
+int svc_lpc_ring_create(endpoint _peer, obj_cnt_type _nr_pages, void *_addr,
+    lpc_ring_id *_idp);
+int svc_lpc_ring_attach(lpc_ring_id _id, void *_addr);
+int svc_lpc_ring_notify(lpc_ring_id _id, int _ring);
+int svc_lpc_ring_wait(lpc_ring_id _id, int _ring, lpc_tmout _tmout);
+int svc_lpc_ring_destroy(lpc_ring_id _id);
+int svc_futex_wait(void *_uaddr, futex_val _val, futex_tmout _tmout);
+int svc_futex_wake(void *_uaddr, int _nr);
+int svc_kstat_ctrl(int _cmd);
+int svc_kstat_get(int _kind, uint64_t _no, void *_ubuf);
+int svc_kns_generation(uint64_t *_ugenp);
+int svc_ev_mask_attach(void **_uaddrp);
+int svc_ev_mask_sync(void);
+int svc_ev_register_batch(struct _evinfo *_uarray, obj_cnt_type _nr);
 #endif  /*  _KERN_SVC_H   */
@@ -19,7 +19,7 @@
 #include <kern/assert.h>
 #include <kern/kern_types.h>
 #include <kern/thread-que.h>
-#include <kern/thread-sync.h>
+#include <kern/workqueue.h>
 
 #include <thr/thr-internal.h>
 
@@ -27,8 +27,7 @@ struct _thread;
 /** スレッド回収処理関連データ構造
  */
 typedef struct _thread_reaper{
-	struct _thread *thr;  /*<  回収スレッド                        */
-	sync_obj        wai;  /*<  終了スレッド待ち合わせオブジェクト  */
+	work           work;  /*<  回収処理要求                        */
 	thread_queue     tq;  /*<  終了待ちスレッドのキュー            */
 }thread_reaper;
 
@@ -86,4 +86,5 @@ sync_reason sync_wait_with_callback(sync_obj *_obj, sync_callback _callback,
 void sync_init_object(sync_obj *_obj, sync_pol _pol, thr_state _wait_kind);
 sync_reason sync_wait(sync_obj *_obj, spinlock *_lock);
 void sync_wake(sync_obj *_obj, sync_reason _reason);
+sync_reason sync_wake_and_wait(sync_obj *_wobj, sync_obj *_obj, spinlock *_lock);
 #endif  /*  _KERN_THREAD_SYNC_H   */
@@ -94,15 +94,23 @@ typedef struct _thread{
 	queue              exit_waiters;  /*< 終了待ち合わせ子スレッド群                    */
 	queue                  children;  /*< 子スレッド群                                  */
 	thread_resource        resource;  /*< スレッド消費資源                              */
-	thr_prio                   prio;  /*< スレッドの静的優先度                          */
+	thr_prio                   prio;  /*< スレッドの実行優先度                          */
+	thr_prio              base_prio;  /*< スレッドの静的優先度                          */
 	thr_prio                  slice;  /*< スレッドのタイムスライス                      */
 	thr_prio              cur_slice;  /*< 現在のタイムスライス                          */
 	thread_flags          thr_flags;  /*< スレッドの属性コード                          */
+	bool                    handoff;  /*< CPU直接引き渡しの切り替え先として予約済み    */
 	thread_type                type;  /*< スレッド種別                                  */
 	kstack_type                 ksp;  /*< カーネルスタックの先頭アドレス                */
 	kstack_type            last_ksp;  /*< 最後にディスパッチしたときのスタックポインタ  */
 	fpu_context               fpctx;  /*< FPUのコンテキスト情報(16バイトアライン)       */
 	msg_queue                  mque;  /*< メッセージキュー                              */
+	msg                    lpc_slot;  /*< 送信用メッセージスロット                      */
+	endpoint         lpc_reply_port;  /*< 応答時に送信元とするポート                    */
+	endpoint       lpc_reply_client;  /*< 最後に受信した要求の送信元                    */
+	lpc_req_id        lpc_reply_req;  /*< 最後に受信した要求の要求ID                    */
+	bool             lpc_prio_lent;  /*< 要求元の優先度で処理中                        */
+	lpc_async_ctx        *lpc_async;  /*< 非同期送信完了通知キュー(初回使用時に割当て)  */
 	event_queue               evque;  /*< イベントキュー                                */
 }thread;
 
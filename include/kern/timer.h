@@ -20,6 +20,7 @@
 #include <kern/kern_types.h>
 #include <kern/spinlock.h>
 #include <kern/rbtree.h>
+#include <kern/queue.h>
 #include <kern/thread-sync.h>
 
 /**  タイマキュー
@@ -27,11 +28,13 @@
 typedef struct _timer_queue{
 	spinlock                              lock;  /*< タイマーキューのロック */
 	RB_HEAD(timer_queue, _timer_callout)  que;  /*< タイマキューののヘッド  */
+	queue                             expired;  /*< 発火済みで実行待ちのコールアウト  */
 }timer_queue;
 
-#define __TIMER_QUEUE_INITIALIZER(root)  {  \
+#define __TIMER_QUEUE_INITIALIZER(_tq)  {  \
 	.lock = __SPINLOCK_INITIALIZER,     \
-	.que = RB_INITIALIZER(root),        \
+	.que = RB_INITIALIZER(&(_tq).que),  \
+	.expired = __QUEUE_INITIALIZER(&(_tq).expired),  \
 	}
 
 /** タイマコールバック
@@ -42,6 +45,7 @@ typedef struct _timer_callout{
 	ticks                    expire;  /*< 次回発火時のtick値                     */
 	void   (*callout)(private_inf );  /*< コールアウト関数                       */
 	private_inf                data;  /*< コールアウト関数に渡す引数             */
+	list                       link;  /*< 発火済みコールアウトのキューへのリンク */
 }timer_callout;
 
 /** ティック管理
@@ -59,6 +63,9 @@ sync_reason tim_wait(tim_tmout _outms);
 sync_reason tim_wait_obj(sync_obj *_obj, tim_tmout _outms, spinlock *_lock);
 sync_reason tim_wait_with_callback(sync_obj *_obj, tim_tmout _outms, 
 				   sync_callback _callback, sync_callback_arg _arg);
+void tim_callout_add(timer_callout *_cbp, tim_tmout _outms,
+    void (*_func)(private_inf _data), private_inf _data);
+bool tim_callout_cancel(timer_callout *_cbp);
 void mdelay(delay_cnt _ms);
 void udelay(delay_cnt _us);
 
@@ -18,7 +18,10 @@
 #include <kern/assert.h>
 #include <kern/kern_types.h>
 
+struct _thread;
+
 void _setup_test_progs(void);
+void tst_start_kthread(struct _thread **_thrp, int (*_fn)(void *), void *_arg);
 
 extern void proc_create_test(void);
 extern void thread_test(void);
@@ -33,5 +36,12 @@ extern void mutex_test(void);
 extern void idbmap_test(void);
 extern void queue_test(void);
 extern void refcnt_test(void);
+extern void rwsem_test(void);
+extern void futex_test(void);
+extern void lpc_bench_test(void);
+extern void lpc_async_test(void);
+extern void lpc_batch_test(void);
+extern void lpc_stress_test(void);
+extern void lpc_wait_test(void);
 
 #endif  /*  _KERN_TST_PROGS_H   */
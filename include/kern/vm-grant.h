@@ -0,0 +1,80 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Page grant relevant definitions                                   */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_VM_GRANT_H)
+#define  _KERN_VM_GRANT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/spinlock.h>
+#include <kern/list.h>
+#include <kern/rbtree.h>
+#include <kern/refcount.h>
+#include <kern/mutex.h>
+
+#define VM_GRANT_ID_NONE        (0)     /*< 無効なグラントID                    */
+#define VM_GRANT_MAX_PAGES      (1024)  /*< 1グラントあたりのページ数の上限     */
+
+#define VM_GRANT_STATE_OFFERED  (0)     /*< 受信者のマップ待ち                  */
+#define VM_GRANT_STATE_MAPPING  (1)     /*< 受信者がマップ処理中                */
+#define VM_GRANT_STATE_MAPPED   (2)     /*< 受信者の仮想空間にマップ済み        */
+#define VM_GRANT_STATE_REVOKED  (3)     /*< 取り消し済み                        */
+
+struct _vm;
+struct _vma;
+
+/** ページグラント
+    @note 提供元のページのマップカウントを保持し, 提供元が
+    ページをアンマップしても受信者に引き渡すページを維持する
+ */
+typedef struct _vm_grant{
+	RB_ENTRY(_vm_grant)         node;  /*< グラント表のノード                   */
+	list                        link;  /*< 取り消し処理用のリンク               */
+	refcnt                      refs;  /*< 参照カウンタ                         */
+	vm_grant_id                   id;  /*< グラントID                           */
+	int                        state;  /*< グラントの状態                       */
+	struct _vm                *owner;  /*< 提供元の仮想空間                     */
+	endpoint                 grantee;  /*< 受信者のエンドポイント               */
+	vma_prot                    prot;  /*< 受信者に許可するアクセス属性         */
+	struct _vm            *mapped_as;  /*< マップ先の仮想空間                   */
+	struct _vma          *mapped_vma;  /*< マップ先の仮想アドレス領域           */
+	obj_cnt_type            nr_pages;  /*< ページ数                             */
+	void                   *pages[];   /*< ページのカーネル仮想アドレス         */
+}vm_grant;
+
+/** グラント表
+ */
+typedef struct _vm_grant_db{
+	spinlock                           lock;  /*< グラント表のロック       */
+	mutex                         unmap_mtx;  /*< アンマップと仮想空間破棄の排他 */
+	vm_grant_id                     next_id;  /*< 次に割り当てるグラントID */
+	RB_HEAD(vm_grant_tree, _vm_grant)  head;  /*< グラント表               */
+}vm_grant_db;
+
+#define __VM_GRANT_DB_INITIALIZER(_db)		\
+	{					\
+		.lock = __SPINLOCK_INITIALIZER,	\
+		.unmap_mtx = __MUTEX_INITIALIZER((_db).unmap_mtx, MTX_FLAG_EXCLUSIVE), \
+		.next_id = VM_GRANT_ID_NONE + 1,\
+		.head   =RB_INITIALIZER(&(_db).head),  \
+	}
+
+int vm_grant_create(endpoint _grantee, void *_start, size_t _size, vma_prot _prot,
+    vm_grant_id *_idp);
+int vm_grant_map(vm_grant_id _id, void *_addr, vma_prot _prot);
+int vm_grant_unmap(vm_grant_id _id);
+int vm_grant_revoke(vm_grant_id _id);
+void vm_grant_release_as(struct _vm *_as);
+#endif  /*  _KERN_VM_GRANT_H   */
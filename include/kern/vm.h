@@ -21,6 +21,7 @@
 #include <kern/spinlock.h>
 #include <kern/rbtree.h>
 #include <kern/mutex.h>
+#include <kern/rwsem.h>
 
 #include <hal/kernlayout.h>
 #include <hal/userlayout.h>
@@ -34,13 +35,16 @@
 #define VMA_FLAG_FIXED  (0)  /*<  領域長固定                              */
 #define VMA_FLAG_HEAP   (1)  /*<  ヒープ領域(アドレスの大きい方に伸長)    */
 #define VMA_FLAG_STACK  (2)  /*<  スタック領域(アドレスの小さい方に伸長)  */
+#define VMA_FLAG_GRANT  (4)  /*<  他プロセスから提供されたページの領域    */
+#define VMA_FLAG_ANON   (8)  /*<  匿名メモリ領域(vm_map_anonで生成)       */
 
 struct _proc;
 typedef struct _vm{
-	mutex                      asmtx;  /*< 仮想アドレス空間のmutex  */
-	struct _proc                  *p;  /*< プロセスへの参照         */
-	void                      *pgtbl;  /*< ページテーブル           */
-	RB_HEAD(vma_tree, _vma) vma_head;  /*< VMAのヘッド              */
+	rwsem                      asmtx;  /*< 仮想アドレス空間のセマフォ   */
+	spinlock              pgtbl_lock;  /*< ページテーブル更新ロック     */
+	struct _proc                  *p;  /*< プロセスへの参照             */
+	void                      *pgtbl;  /*< ページテーブル               */
+	RB_HEAD(vma_tree, _vma) vma_head;  /*< VMAのヘッド                  */
 }vm;
 
 typedef struct _vma{
@@ -63,6 +67,8 @@ int vm_create_vma(vm *_as, struct _vma **_vmapp, void *_start,
     size_t _size, vma_prot _prot, vma_flags _vflags);
 int vm_destroy_vma(struct _vma *_vmap);
 int vm_resize_area(vm *_as, void *_fault_addr, void *_new_addr, void **_old_addrp);
+int vm_map_anon(vm *_as, void *_addr, size_t _size, vma_prot _prot, void **_addrp);
+int vm_unmap_anon(vm *_as, void *_addr, size_t _size);
 int vm_copy_in(vm *_as, void *_dest, const void *_src, size_t _count);
 int vm_copy_out(vm *_as, void *_dest, const void *_src, size_t _count);
 bool vm_user_area_can_access(vm *as, void *start, size_t count, vma_prot prot);
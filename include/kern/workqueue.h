@@ -0,0 +1,72 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Kernel work queue relevant definitions                            */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_KERN_WORKQUEUE_H)
+#define  _KERN_WORKQUEUE_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/assert.h>
+#include <kern/kern_types.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+#include <kern/thread-sync.h>
+#include <kern/timer.h>
+
+#define WQ_NR_WORKERS      (2)                  /*< ワーカスレッド数              */
+#define WQ_WORKER_PRIO     (THR_MAX_PRIO - 3)   /*< ワーカスレッドの優先度        */
+
+#define WQ_PRIO_HIGH       (0)   /*< 高優先度の処理要求                  */
+#define WQ_PRIO_NORMAL     (1)   /*< 通常優先度の処理要求                */
+#define WQ_PRIO_LOW        (2)   /*< 低優先度の処理要求                  */
+#define WQ_PRIO_NR         (3)   /*< 処理要求の優先度数                  */
+
+#define WORK_STATE_IDLE    (0)   /*< 未登録                              */
+#define WORK_STATE_QUEUED  (1)   /*< ワークキューに登録済み              */
+#define WORK_STATE_DELAYED (2)   /*< タイマによる登録待ち                */
+
+/** ワークキュー処理要求
+ */
+typedef struct _work{
+	list                      link;  /*< ワークキューへのリンク      */
+	int                      state;  /*< 処理要求の状態              */
+	int                       prio;  /*< 処理要求の優先度            */
+	bool                   running;  /*< 処理関数の実行中            */
+	void (*func)(private_inf _data); /*< 処理関数                    */
+	private_inf               data;  /*< 処理関数の引数              */
+	timer_callout          callout;  /*< 遅延登録用のコールアウト    */
+}work;
+
+struct _thread;
+
+/** ワークキュー
+ */
+typedef struct _workqueue{
+	spinlock                  lock;  /*< ワークキューのロック              */
+	queue        que[WQ_PRIO_NR];    /*< 優先度ごとの処理要求キュー        */
+	obj_cnt_type        nr_pending;  /*< 登録済み/実行中の処理要求数       */
+	sync_obj                  wait;  /*< ワーカスレッドの待ち合わせキュー  */
+	sync_obj            flush_wait;  /*< 処理完了の待ち合わせキュー        */
+	struct _thread *workers[WQ_NR_WORKERS];  /*< ワーカスレッド            */
+}workqueue;
+
+void work_init(work *_work, void (*_func)(private_inf _data), private_inf _data,
+    int _prio);
+bool queue_work(work *_work);
+bool queue_delayed_work(work *_work, tim_tmout _outms);
+bool cancel_work(work *_work);
+void flush_work(work *_work);
+void flush_workqueue(void);
+void workqueue_init(void);
+#endif  /*  _KERN_WORKQUEUE_H   */
@@ -30,6 +30,9 @@ void _thr_init_kthread_params(struct _thread *_thr);
 void _ti_set_ti_with_thread(struct _thread *_thr);
 void _thr_init_reaper(void);
 void _sched_wakeup(struct _thread *_thr);
+bool _sched_reserve_handoff(struct _thread *_thr);
+void _sched_release_handoff(struct _thread *_thr);
+void sched_handoff(struct _thread *_next);
 void _sync_init_block(struct _sync_block *_blk);
 void _thr_enter_dead(void);
 void _thr_do_idle(void);
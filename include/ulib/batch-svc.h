@@ -0,0 +1,22 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  system call batching relevant definitions                         */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_ULIB_BATCH_SVC_H)
+#define  _ULIB_BATCH_SVC_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <ulib/yatos-ulib.h>
+
+void yatos_batch_set(svc_batch_entry *_ent, uint64_t _no, syscall_arg_type _arg1, 
+    syscall_arg_type _arg2, syscall_arg_type _arg3, syscall_arg_type _arg4, 
+    syscall_arg_type _arg5);
+int yatos_syscall_batch(svc_batch_entry *_ents, size_t _nr, uint64_t _flags);
+#endif  /*  _ULIB_BATCH_SVC_H   */
@@ -36,4 +36,5 @@ typedef struct _ev_handler_array{
 void __yatos_user_event_handler_init(void);
 int yatos_register_user_event_handler(event_no _id, ev_handler _handler);
 void __yatos_ulib_invoke_handler(event_no _id, evinfo *_info, event_frame *_evf);
+void __yatos_ulib_dispatch_events(event_no _id, evinfo *_info, event_frame *_evf);
 #endif  /*  __ULIB_EVENTS_H  */
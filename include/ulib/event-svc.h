@@ -19,4 +19,5 @@
 
 void _yatos_register_common_event_handler(void);
 void yatos_event_return(event_frame *_evf);
+int yatos_event_register_batch(evinfo *_array, size_t _nr);
 #endif  /*  _ULIB_EVHANDLER_H   */
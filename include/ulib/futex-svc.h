@@ -0,0 +1,49 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  futex system call and user mutex relevant definitions             */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_ULIB_FUTEX_SYSCALL_H)
+#define  _ULIB_FUTEX_SYSCALL_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/futex.h>
+
+#include <ulib/yatos-ulib.h>
+
+#define YATOS_MUTEX_UNLOCKED   (0)  /*< 未ロック                          */
+#define YATOS_MUTEX_LOCKED     (1)  /*< ロック中(待ちスレッドなし)        */
+#define YATOS_MUTEX_CONTENDED  (2)  /*< ロック中(待ちスレッドあり)        */
+
+/** ユーザmutex
+ */
+typedef struct _yatos_mutex{
+	volatile futex_val state;  /*< ロック状態                          */
+}yatos_mutex;
+
+/** ユーザ条件変数
+ */
+typedef struct _yatos_cond{
+	volatile futex_val   seq;  /*< 通知回数                            */
+}yatos_cond;
+
+#define YATOS_MUTEX_INITIALIZER  { .state = YATOS_MUTEX_UNLOCKED, }
+#define YATOS_COND_INITIALIZER   { .seq = 0, }
+
+int yatos_futex_wait(volatile futex_val *_uaddr, futex_val _val, futex_tmout _tmout);
+int yatos_futex_wake(volatile futex_val *_uaddr, int _nr);
+void yatos_mutex_init(yatos_mutex *_mtx);
+void yatos_mutex_lock(yatos_mutex *_mtx);
+bool yatos_mutex_trylock(yatos_mutex *_mtx);
+void yatos_mutex_unlock(yatos_mutex *_mtx);
+void yatos_cond_init(yatos_cond *_cv);
+int yatos_cond_wait(yatos_cond *_cv, yatos_mutex *_mtx, futex_tmout _tmout);
+void yatos_cond_signal(yatos_cond *_cv);
+void yatos_cond_broadcast(yatos_cond *_cv);
+#endif  /*  _ULIB_FUTEX_SYSCALL_H   */
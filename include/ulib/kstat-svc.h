@@ -0,0 +1,24 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  kernel statistics system call relevant definitions                */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_ULIB_KSTAT_SVC_H)
+#define  _ULIB_KSTAT_SVC_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/kstat.h>
+
+#include <ulib/yatos-ulib.h>
+
+int yatos_kstat_ctrl(int _cmd);
+int yatos_kstat_get_syscall(uint64_t _no, kstat_latency *_lat);
+int yatos_kstat_get_trap(uint64_t _trapno, kstat_latency *_lat);
+int yatos_kstat_get_pgflt(kstat_pgflt *_pf);
+#endif  /*  _ULIB_KSTAT_SVC_H   */
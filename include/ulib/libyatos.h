@@ -18,7 +18,11 @@
 #include <ulib/ev-handler.h>
 #include <ulib/thread-svc.h>
 #include <ulib/lpc-svc.h>
+#include <ulib/lpc-ring.h>
 #include <ulib/proc-svc.h>
 #include <ulib/vm-svc.h>
+#include <ulib/futex-svc.h>
+#include <ulib/kstat-svc.h>
+#include <ulib/batch-svc.h>
 
 #endif  /*  _ULIB_LIBYATOS_H   */
@@ -0,0 +1,36 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  shared memory ring channel relevant definitions                   */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_ULIB_LPC_RING_H)
+#define  _ULIB_LPC_RING_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/lpc-ring.h>
+
+#include <ulib/yatos-ulib.h>
+
+/** ユーザ側のリングチャネル情報
+ */
+typedef struct _yatos_lpc_ring{
+	lpc_ring_id    id;  /*< チャネルID                    */
+	void        *base;  /*< チャネルをマップしたアドレス  */
+}yatos_lpc_ring;
+
+int yatos_lpc_ring_create(yatos_lpc_ring *_ch, endpoint _peer, obj_cnt_type _nr_pages,
+    void *_addr);
+int yatos_lpc_ring_attach(yatos_lpc_ring *_ch, lpc_ring_id _id, void *_addr);
+int yatos_lpc_ring_notify(yatos_lpc_ring *_ch, int _ring);
+int yatos_lpc_ring_wait(yatos_lpc_ring *_ch, int _ring, lpc_tmout _tmout);
+int yatos_lpc_ring_destroy(yatos_lpc_ring *_ch);
+int yatos_lpc_ring_produce(yatos_lpc_ring *_ch, int _ring, const lpc_ring_ent *_ent);
+int yatos_lpc_ring_consume(yatos_lpc_ring *_ch, int _ring, lpc_ring_ent *_ent, 
+    lpc_tmout _tmout);
+#endif  /*  _ULIB_LPC_RING_H   */
@@ -18,4 +18,15 @@
 int yatos_lpc_send(endpoint _dest, lpc_tmout _tmout, void *_m);
 int yatos_lpc_recv(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_sender);
 int yatos_lpc_send_and_reply(endpoint _dest, void *_m);
+int yatos_lpc_short_send(endpoint _dest, lpc_short_msg *_sm);
+int yatos_lpc_short_recv(endpoint _src, lpc_tmout _tmout, lpc_short_msg *_sm, 
+    endpoint *_sender);
+int yatos_lpc_short_call(endpoint _dest, lpc_short_msg *_sm);
+int yatos_lpc_send_async(endpoint _dest, void *_m, lpc_req_id *_idp);
+int yatos_lpc_async_wait(lpc_tmout _tmout, lpc_req_id *_idp, int *_statusp);
+int yatos_lpc_recv_req(endpoint _src, lpc_tmout _tmout, void *_m, endpoint *_sender,
+    lpc_req_id *_reqp);
+int yatos_lpc_recv_batch(endpoint _src, lpc_tmout _tmout, lpc_batch_ent *_ents, int _nr);
+int yatos_lpc_reply_batch(lpc_batch_ent *_ents, int _nr);
+int yatos_lpc_wait_any(endpoint *_eps, int _nr, lpc_tmout _tmout, uint64_t *_readyp);
 #endif  /*  _ULIB_LPC_SYSCALL_H   */
@@ -18,6 +18,7 @@
 int yatos_proc_send_event(tid _dest, event_no  _id, event_data _data);
 int yatos_proc_send_proc_event(tid _dest, event_no  _id, event_data _data);
 int yatos_proc_bcast_proc_event(tid _dest, event_no  _id, event_data _data);
+int yatos_proc_notify_event(tid _dest, event_no  _id);
 int yatos_proc_create_thread(thr_prio _prio, int (*_start)(void *), void *_arg, 
     void *_sp, tid *_newidp);
 int yatos_proc_get_thread_resource(tid _id, thread_resource *_resp);
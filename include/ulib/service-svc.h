@@ -14,8 +14,29 @@
 #include <stdbool.h>
 
 #include <ulib/yatos-ulib.h>
+#include <ulib/futex-svc.h>
+
+#define YATOS_NS_CACHE_SIZE  (8)  /*< 名前解決キャッシュのエントリ数(2の冪)  */
+
+/** 名前解決キャッシュのエントリ
+ */
+typedef struct _yatos_ns_cache_ent{
+	bool                   valid;  /*< 有効なエントリ                */
+	kserv_hash              hash;  /*< サービス名のハッシュ値        */
+	kserv_gen                gen;  /*< 名前解決時の世代番号          */
+	endpoint                  ep;  /*< サービスのエンドポイント      */
+	char    name[KSERV_NAME_LEN];  /*< サービス名                    */
+}yatos_ns_cache_ent;
+
+/** 名前解決キャッシュ
+ */
+typedef struct _yatos_ns_cache{
+	yatos_mutex                          mtx;  /*< キャッシュの排他  */
+	yatos_ns_cache_ent ents[YATOS_NS_CACHE_SIZE];  /*< エントリ      */
+}yatos_ns_cache;
 
 int yatos_register_service(const char *_name);
 int yatos_unregister_service(const char *_name);
 int yatos_lookup_service(const char *_name, endpoint *_ep);
+void yatos_flush_service_cache(void);
 #endif  /*  _ULIB_SERVICE_SVC_H   */
@@ -24,6 +24,10 @@ int  yatos_thread_wait(tid _wait_tid, thread_wait_flags _wflags, tid *_exit_tidp
     exit_code *_rcp);
 int yatos_get_event_mask(event_mask *_msk);
 int yatos_set_event_mask(event_mask *msk);
+int yatos_ev_mask_attach(ev_mask_page **_pagep);
+void yatos_ev_mask_block(ev_mask_page *_pg, event_no _id);
+int yatos_ev_mask_unblock(ev_mask_page *_pg, event_no _id);
+int yatos_ev_mask_update(ev_mask_page *_pg, event_mask *_msk);
 
 void ev_mask_clr(event_mask *_maskp);
 bool ev_mask_test(event_mask *_mask, event_no _id);
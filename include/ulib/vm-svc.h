@@ -13,8 +13,18 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include <kern/vm.h>
+
 #include <ulib/yatos-ulib.h>
 
 void *yatos_vm_sbrk(intptr_t increment);
+void *yatos_vm_sbrk_service(intptr_t increment);
+int yatos_vm_map_anon(void *_addr, size_t _size, vma_prot _prot, void **_addrp);
+int yatos_vm_unmap_anon(void *_addr, size_t _size);
+int yatos_vm_grant(endpoint _grantee, void *_start, size_t _size, vma_prot _prot,
+    vm_grant_id *_idp);
+int yatos_vm_grant_map(vm_grant_id _id, void *_addr, vma_prot _prot);
+int yatos_vm_grant_unmap(vm_grant_id _id);
+int yatos_vm_grant_revoke(vm_grant_id _id);
 
 #endif  /*  _ULIB_VM_SVC_H   */
@@ -24,4 +24,6 @@
 struct _vm;
 struct _vma;
 int _vm_find_vma_nolock(struct _vm *as, void *vaddr, struct _vma **res);
+int _vm_remove_vma_nolock(struct _vm *as, struct _vma *vmap);
+int _vm_find_free_area_nolock(struct _vm *as, size_t size, void **addrp);
 #endif  /*  __VM_INTERNAL_H   */
@@ -32,6 +32,12 @@
 
 #define MISC_ENABLE             (0x000001A0)
 #define EFER                    (0xC0000080)
+#define STAR                    (0xC0000081)  /*< SYSCALL/SYSRETセレクタ       */
+#define LSTAR                   (0xC0000082)  /*< 64bit SYSCALLエントリアドレス */
+#define SFMASK                  (0xC0000084)  /*< SYSCALL時のRFLAGSマスク      */
+#define KERNEL_GS_BASE          (0xC0000102)  /*< SWAPGSで交換するGSベース     */
+
+#define EFER_SCE                (1 << 0)      /*< SYSCALL/SYSRET命令有効化     */
 
 #define CR0_PAGING              (1 << 31)
 #define CR0_CACHE_DISABLE       (1 << 30)
@@ -148,6 +154,8 @@ typedef struct _x86_64_cpu{
 	void              *gdtp;
 	void              *tssp;
 	uint64_t     tsc_per_us;
+	uint64_t syscall_kstack;  /*< SYSCALL命令で使用するカーネルスタック   */
+	uint64_t  syscall_ursp;  /*< SYSCALL命令発行時のユーザスタック退避先 */
 	fpu_context __attribute__((aligned(16))) fpuctxbuf;
 }x86_64_cpu;
 
@@ -156,6 +164,8 @@ typedef struct _x86_64_cpu{
 	.gdtp = NULL,		    \
 	.tssp = NULL,	            \
 	.tsc_per_us = 0,            \
+	.syscall_kstack = 0,        \
+	.syscall_ursp = 0,          \
 	.fpuctxbuf = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
 		      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
 		      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
@@ -168,16 +178,18 @@ typedef struct _x86_64_cpu{
 static inline void
 wrmsr(uint32_t msr_id, uint64_t msr_value){
 
-	asm volatile ( "wrmsr" : : "c" (msr_id), "A" (msr_value) );
+	asm volatile ( "wrmsr" : : "c" (msr_id), 
+	    "a" ( (uint32_t)( msr_value & 0xffffffff ) ), 
+	    "d" ( (uint32_t)( msr_value >> 32 ) ) );
 }
 
 static inline uint64_t 
 rdmsr(uint32_t msr_id) {
-	uint64_t msr_value;
+	uint32_t lo, hi;
 
-	asm volatile ( "rdmsr" : "=A" (msr_value) : "c" (msr_id) );
+	asm volatile ( "rdmsr" : "=a" (lo), "=d" (hi) : "c" (msr_id) );
 
-	return msr_value;
+	return ( (uint64_t)hi << 32 ) | lo;
 }
 
 struct _cpu;
@@ -186,6 +198,7 @@ void x86_64_fpuctx_save(void *_dest);
 void x86_64_fpuctx_restore(void *_src);
 void x86_64_enable_fpu_task_switch(void);
 void x86_64_disable_fpu_task_switch(void);
+void x86_64_init_syscall(x86_64_cpu *_ac);
 #endif  /*  !ASM_FILE  */
 
 #endif  /*  __HAL_ARCH_CPU_H  */
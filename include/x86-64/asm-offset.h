@@ -0,0 +1,35 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  OS kernel sample                                                  */
+/*  Copyright 2014 Takeharu KATO                                      */
+/*                                                                    */
+/*  structure offset definitions                                      */
+/*  Note: This file is generated automatically, don't edit by hand.   */ 
+/*                                                                    */
+/**********************************************************************/
+
+#if !defined(_HAL_ASM_OFFSET_H)
+#define _HAL_ASM_OFFSET_H
+
+#define THREAD_INFO_SIZE (40) /* sizeof(struct _thread_info) */
+#define TI_MAGIC_OFFSET (0) /* __asm_offsetof(struct _thread_info, magic) */
+#define TI_INTRCNT_OFFSET (4) /* __asm_offsetof(struct _thread_info, intrcnt) */
+#define TI_PREEMPT_OFFSET (8) /* __asm_offsetof(struct _thread_info, preempt) */
+#define TI_FLAGS_OFFSET (12) /* __asm_offsetof(struct _thread_info, flags) */
+#define TI_ARCH_FLAGS_OFFSET (16) /* __asm_offsetof(struct _thread_info, arch_flags) */
+#define TI_THREAD_OFFSET (24) /* __asm_offsetof(struct _thread_info, thr) */
+#define TI_CPU_OFFSET (32) /* __asm_offsetof(struct _thread_info, cpu) */
+#define CTX_RCX_OFFSET (16) /* __asm_offsetof(struct _trap_context, rcx) */
+#define CTX_R11_OFFSET (80) /* __asm_offsetof(struct _trap_context, r11) */
+#define CTX_TRAPNO_OFFSET (120) /* __asm_offsetof(struct _trap_context, trapno) */
+#define CTX_RIP_OFFSET (136) /* __asm_offsetof(struct _trap_context, rip) */
+#define CTX_CS_OFFSET (144) /* __asm_offsetof(struct _trap_context, cs) */
+#define CTX_RFLAGS_OFFSET (152) /* __asm_offsetof(struct _trap_context, rflags) */
+#define CTX_RSP_OFFSET (160) /* __asm_offsetof(struct _trap_context, rsp) */
+#define CTX_SS_OFFSET (168) /* __asm_offsetof(struct _trap_context, ss) */
+#define THR_FPCTX_OFFSET (848) /* __asm_offsetof(struct _thread, fpctx) */
+#define X86_64_CPU_SYSCALL_KSTACK_OFFSET (24) /* __asm_offsetof(struct _x86_64_cpu, syscall_kstack) */
+#define X86_64_CPU_SYSCALL_URSP_OFFSET (32) /* __asm_offsetof(struct _x86_64_cpu, syscall_ursp) */
+#define PAGE_FRAME_SIZE (248) /* sizeof(struct _page_frame) */
+#define EV_BITMAP_SIZE (8) /* sizeof(events_map) */
+#endif  /*  _HAL_ASM_OFFSET_H   */
@@ -0,0 +1,66 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Atomic operations                                                 */
+/*                                                                    */
+/**********************************************************************/
+#if !defined(_HAL_ATOMIC_H)
+#define  _HAL_ATOMIC_H 
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/** 指定されたアドレスの内容が期待値と等しい場合に新しい値に更新する
+    @param[in] addr   更新対象のアドレス
+    @param[in] oldval 期待値
+    @param[in] newval 更新する値
+    @return 更新前の値
+ */
+static inline uint32_t
+hal_atomic_cmpxchg32(volatile uint32_t *addr, uint32_t oldval, uint32_t newval) {
+	uint32_t prev;
+
+	__asm__ __volatile__( "lock; cmpxchgl %2, %1"
+	    : "=a" (prev), "+m" (*addr)
+	    : "r" (newval), "0" (oldval)
+	    : "memory", "cc");
+
+	return prev;
+}
+
+/** 指定されたアドレスの内容を新しい値とアトミックに交換する
+    @param[in] addr   更新対象のアドレス
+    @param[in] newval 更新する値
+    @return 交換前の値
+ */
+static inline uint32_t
+hal_atomic_xchg32(volatile uint32_t *addr, uint32_t newval) {
+
+	__asm__ __volatile__( "xchgl %0, %1"
+	    : "+r" (newval), "+m" (*addr)
+	    : 
+	    : "memory");
+
+	return newval;
+}
+
+/** 指定されたアドレスの内容に値をアトミックに加算する
+    @param[in] addr   更新対象のアドレス
+    @param[in] val    加算する値
+    @return 加算前の値
+ */
+static inline uint32_t
+hal_atomic_fetch_add32(volatile uint32_t *addr, uint32_t val) {
+
+	__asm__ __volatile__( "lock; xaddl %0, %1"
+	    : "+r" (val), "+m" (*addr)
+	    : 
+	    : "memory", "cc");
+
+	return val;
+}
+
+#endif  /*  _HAL_ATOMIC_H   */
@@ -15,8 +15,8 @@
 #define GDT_KERN_DATA32_SEL	   3
 #define GDT_KERN_CODE64_SEL	   4
 #define GDT_KERN_DATA64_SEL	   5
-#define GDT_USER_CODE64_SEL	   6
-#define GDT_USER_DATA64_SEL	   7
+#define GDT_USER_DATA64_SEL	   6
+#define GDT_USER_CODE64_SEL	   7
 #define GDT_TSS64_SEL	           8
 
 #define GDT_NULL1                0x0
@@ -25,10 +25,18 @@
 #define GDT_KERN_DATA32	        0x18
 #define GDT_KERN_CODE64	        0x20
 #define GDT_KERN_DATA64	        0x28
-#define GDT_USER_CODE64	        0x33
-#define GDT_USER_DATA64	        0x3b
+#define GDT_USER_DATA64	        0x33
+#define GDT_USER_CODE64	        0x3b
 #define GDT_TSS64	        0x40
 
+/*  SYSCALL/SYSRET命令で使用するセレクタ
+ *  SYSRET命令は, STARレジスタのユーザセレクタ基点 + 8 をスタックセグメント,
+ *  基点 + 16 をコードセグメントとして読み込むため, ユーザデータセグメントを
+ *  ユーザコードセグメントの直前に配置している.
+ */
+#define GDT_SYSCALL_KERN_BASE   GDT_KERN_CODE64          /*< SYSCALL時のCS (SSは+8)  */
+#define GDT_SYSRET_USER_BASE    (GDT_KERN_DATA64 | 3)    /*< SYSRET時のSS-8/CS-16    */
+
 #if defined(ASM_FILE)
 
 #define GDT_NULL_ENTRY 	.quad	0x0
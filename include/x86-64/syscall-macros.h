@@ -22,72 +22,139 @@
 typedef uint64_t syscall_arg_type;  /*< システムコール引数の型  */
 typedef int64_t  syscall_res_type;  /*< システムコール結果の型  */
 
+/** システムコール発行命令
+    @note SYSCALL命令ではrcx, r11が破壊される. int 0x90トラップでも
+    同一のレジスタコンベンションを使用するため, 両者を同じマクロで扱う.
+ */
+#define X86_64_SYSCALL_INSN_FAST  "syscall\n\t"    /*< SYSCALL/SYSRET   */
+#define X86_64_SYSCALL_INSN_TRAP  "int $0x90\n\t"  /*< 互換用トラップ   */
+
+#if defined(CONFIG_HAL_SYSCALL_USE_TRAP)
+#define X86_64_SYSCALL_INSN       X86_64_SYSCALL_INSN_TRAP
+#else
+#define X86_64_SYSCALL_INSN       X86_64_SYSCALL_INSN_FAST
+#endif  /*  CONFIG_HAL_SYSCALL_USE_TRAP  */
+
 /** システムコールマクロ
     @note 以下のようにレジスタに引数情報を設定して
-    int 0x90トラップを発行する
+    システムコール発行命令を実行する
 
     システムコール番号      rax
     第1引数                 rdi
     第2引数                 rsi
     第3引数                 rdx
     第4引数                 r10
-    第5引数(未使用)          r8
+    第5引数                 r8
 */
 
-#define syscall0( res, no)			\
+#define __syscall0(insn, res, no)		\
 	do{					\
-	__asm__ __volatile__ ("int $0x90\n\t"	\
+	__asm__ __volatile__ (insn		\
 	    : "=a" (res)			\
 	    : "a"(no)				\
 	    :  "memory", "cc", "r11", "rcx");	\
 	} while(0)
 
 
-#define syscall1( res, no, arg1)		\
+#define __syscall1(insn, res, no, arg1)		\
 	do{					\
-	__asm__ __volatile__ ("int $0x90\n\t"	\
+	__asm__ __volatile__ (insn		\
 	    : "=a" (res)			\
 	    : "a"(no), "D"(arg1)		\
 	    :  "memory", "cc", "r11", "rcx");	\
 	} while(0)
 
-#define syscall2( res, no, arg1, arg2)		\
+#define __syscall2(insn, res, no, arg1, arg2)	\
 	do{					\
-	__asm__ __volatile__ ("int $0x90\n\t"	\
+	__asm__ __volatile__ (insn		\
 	    : "=a" (res)			\
 	    : "a"(no), "D"(arg1), "S"(arg2)	\
 	    :  "memory", "cc", "r11", "rcx");	\
 	} while(0)
 
-#define syscall3( res, no, arg1, arg2, arg3)	        \
+#define __syscall3(insn, res, no, arg1, arg2, arg3)	\
 	do{					        \
-	__asm__ __volatile__ ("int $0x90\n\t"		\
+	__asm__ __volatile__ (insn			\
 	    : "=a" (res)				\
 	    : "a"(no), "D"(arg1), "S"(arg2), "d"(arg3)	\
 	    :  "memory", "cc", "r11", "rcx");	        \
 	} while(0)
 
-#define syscall4( res, no, arg1, arg2, arg3, arg4)			 \
+#define __syscall4(insn, res, no, arg1, arg2, arg3, arg4)		 \
 	do{								 \
 		register uint64_t r10 asm("r10") = (uint64_t)arg4;	 \
 									 \
-		__asm__ __volatile__ ("int $0x90\n\t"			 \
+		__asm__ __volatile__ (insn				 \
 		    : "=a" (res)					 \
 		    : "a"(no), "D"(arg1), "S"(arg2), "d"(arg3), "r"(r10) \
 		    :  "memory", "cc", "r11", "rcx");			 \
 	} while(0)
 
-#define syscall5( res, no, arg1, arg2, arg3, arg4, arg5)		 \
+#define __syscall5(insn, res, no, arg1, arg2, arg3, arg4, arg5)	 \
 	do{								 \
 		register uint64_t r10 asm("r10") = (uint64_t)arg4;	 \
 		register uint64_t  r8  asm("r8") = (uint64_t)arg5;	 \
 									 \
-		__asm__ __volatile__ ("int $0x90\n\t"			 \
+		__asm__ __volatile__ (insn				 \
 		    : "=a" (res)					 \
 		    : "a"(no), "D"(arg1), "S"(arg2), "d"(arg3),		 \
-		    , "r"(r10), "r"(r8)					 \
+		      "r"(r10), "r"(r8)					 \
+		    :  "memory", "cc", "r11", "rcx");			 \
+	} while(0)
+
+/** 短メッセージLPCのシステムコールマクロ
+    @note 第1引数(rdi)と短メッセージ(rsi, rdx, r10, r8, r9)を入出力として扱う
+ */
+#define __syscall_short(insn, res, no, arg1, w)				 \
+	do{								 \
+		register uint64_t r10 asm("r10") = (uint64_t)(w)[2];	 \
+		register uint64_t  r8  asm("r8") = (uint64_t)(w)[3];	 \
+		register uint64_t  r9  asm("r9") = (uint64_t)(w)[4];	 \
+		uint64_t __rdi = (uint64_t)(arg1);			 \
+		uint64_t __rsi = (uint64_t)(w)[0];			 \
+		uint64_t __rdx = (uint64_t)(w)[1];			 \
+									 \
+		__asm__ __volatile__ (insn				 \
+		    : "=a" (res), "+D"(__rdi), "+S"(__rsi), "+d"(__rdx), \
+		      "+r"(r10), "+r"(r8), "+r"(r9)			 \
+		    : "a"(no)						 \
 		    :  "memory", "cc", "r11", "rcx");			 \
+		(arg1) = __rdi;						 \
+		(w)[0] = __rsi;						 \
+		(w)[1] = __rdx;						 \
+		(w)[2] = r10;						 \
+		(w)[3] = r8;						 \
+		(w)[4] = r9;						 \
 	} while(0)
 
+#define syscall0(res, no)						\
+	__syscall0(X86_64_SYSCALL_INSN, res, no)
+#define syscall1(res, no, arg1)						\
+	__syscall1(X86_64_SYSCALL_INSN, res, no, arg1)
+#define syscall2(res, no, arg1, arg2)					\
+	__syscall2(X86_64_SYSCALL_INSN, res, no, arg1, arg2)
+#define syscall3(res, no, arg1, arg2, arg3)				\
+	__syscall3(X86_64_SYSCALL_INSN, res, no, arg1, arg2, arg3)
+#define syscall4(res, no, arg1, arg2, arg3, arg4)			\
+	__syscall4(X86_64_SYSCALL_INSN, res, no, arg1, arg2, arg3, arg4)
+#define syscall5(res, no, arg1, arg2, arg3, arg4, arg5)			\
+	__syscall5(X86_64_SYSCALL_INSN, res, no, arg1, arg2, arg3, arg4, arg5)
+#define syscall_short(res, no, arg1, w)					\
+	__syscall_short(X86_64_SYSCALL_INSN, res, no, arg1, w)
+
+/** int 0x90トラップによるシステムコールマクロ(互換用)
+ */
+#define trap_syscall0(res, no)						\
+	__syscall0(X86_64_SYSCALL_INSN_TRAP, res, no)
+#define trap_syscall1(res, no, arg1)					\
+	__syscall1(X86_64_SYSCALL_INSN_TRAP, res, no, arg1)
+#define trap_syscall2(res, no, arg1, arg2)				\
+	__syscall2(X86_64_SYSCALL_INSN_TRAP, res, no, arg1, arg2)
+#define trap_syscall3(res, no, arg1, arg2, arg3)			\
+	__syscall3(X86_64_SYSCALL_INSN_TRAP, res, no, arg1, arg2, arg3)
+#define trap_syscall4(res, no, arg1, arg2, arg3, arg4)			\
+	__syscall4(X86_64_SYSCALL_INSN_TRAP, res, no, arg1, arg2, arg3, arg4)
+#define trap_syscall5(res, no, arg1, arg2, arg3, arg4, arg5)		\
+	__syscall5(X86_64_SYSCALL_INSN_TRAP, res, no, arg1, arg2, arg3, arg4, arg5)
 
 #endif  /*  _HAL_SYSCALL_MACROS_H  */
@@ -8,7 +8,6 @@
 /**********************************************************************/
 #if !defined(__HAL_TRAPS_H)
 #define __HAL_TRAPS_H
-#include <stdint.h>
 
 #define X86_DIV_ERR       (0)
 #define X86_DEBUG_EX      (1)
@@ -43,6 +42,9 @@
 #define PGFLT_ECODE_RSV      (8)  /*<  予約                    */
 #define PGFLT_ECODE_INSTPREF (16) /*<  命令プリフェッチ        */
 
+#if !defined(ASM_FILE)
+#include <stdint.h>
+
 typedef struct _trap_context{
 	uint64_t rax;
 	uint64_t rbx;
@@ -69,5 +71,6 @@ typedef struct _trap_context{
 }trap_context;
 
 void x86_64_dispatch_syscall(trap_context *_ctx);
+#endif  /*  !ASM_FILE  */
 
 #endif  /*  __HAL_TRAPS_H  */
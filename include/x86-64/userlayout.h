@@ -10,6 +10,8 @@
 #define  _HAL_USERLAYOUT_H 
 
 #define USER_TEXT_TOP       (0x400000)
+#define USER_MMAP_BASE      (0x200000000000)  /*< 匿名メモリ領域の割当て開始位置(32TiB)  */
+#define USER_MMAP_LIMIT     (0x300000000000)  /*< 匿名メモリ領域の割当て上限(48TiB)      */
 #define USER_STACK_BOTTOM   (0x400000000000)  /*< 64TiB以前を使用. */
 #define USER_VADDR_LIMIT    (0x800000000000)  /*< x86-64 正規形アドレスのユーザ側最大値  */
 
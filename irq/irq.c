@@ -25,18 +25,20 @@
 #include <kern/thread.h>
 #include <kern/page.h>
 #include <kern/irq.h>
+#include <kern/softirq.h>
 
 static irq_manager irq_db;  /*<  割込み管理情報  */
 
 /** 割込みハンドラが登録されていることを確認する
-    @param[in] no      割込み番号
-    @param[in] handler 割込みハンドラ
+    @param[in] no        割込み番号
+    @param[in] handler   割込みハンドラ(NULLの場合は比較しない)
+    @param[in] thread_fn 割込みスレッド処理関数(NULLの場合は比較しない)
     @retval true 既に指定したハンドラが登録されている
     @note 割込みエントリロックの獲得は呼出元で実施する
  */
 static bool
 is_irq_handler_installed_nolock(intr_no no, ihandler_res (*handler)(intr_no _ino, 
-	private_inf _data, void *ctx)) {
+	private_inf _data, void *ctx), void (*thread_fn)(intr_no _ino, private_inf _data)) {
 	bool                  rc;
 	intrflags          flags;
 	irq_entry           *ent;
@@ -55,7 +57,8 @@ is_irq_handler_installed_nolock(intr_no no, ihandler_res (*handler)(intr_no _ino
 	     li = li->next) {
 
 		hndlrp = CONTAINER_OF(li, irq_handler, link);
-		if ( hndlrp->handler == handler ) {
+		if ( ( ( handler != NULL ) && ( hndlrp->handler == handler ) ) ||
+		    ( ( thread_fn != NULL ) && ( hndlrp->thread_fn == thread_fn ) ) ) {
 			
 			rc = true;
 			break;
@@ -66,42 +69,94 @@ is_irq_handler_installed_nolock(intr_no no, ihandler_res (*handler)(intr_no _ino
 	return rc;
 }
 
-/** 割込みハンドラを登録する
+/** 割込みスレッドの既定の割込みハンドラ
+    @param[in] no   割込み番号
+    @param[in] data プライベートデータ
+    @param[in] ctx  割込みコンテキスト
+    @retval IRQHDL_RES_WAKE_THREAD 割込みスレッドに処理を依頼
+ */
+static ihandler_res
+irq_default_primary_handler(intr_no __attribute__ ((unused)) no, 
+    private_inf __attribute__ ((unused)) data, void __attribute__ ((unused)) *ctx) {
+
+	return IRQHDL_RES_WAKE_THREAD;
+}
+
+/** 割込みスレッド
+    @param[in] arg 割込みハンドラの管理情報
+    @note 割込みスレッド処理関数の完了後に割込み線のマスクを解除する
+ */
+static int
+irq_thread(void *arg) {
+	int                   rc;
+	intrflags          flags;
+	irq_entry           *ent;
+	irq_handler        *hdlr;
+	sync_reason          res;
+
+	hdlr = (irq_handler *)arg;
+	ent = &irq_db.entries[hdlr->no];
+
+	while(1) {
+
+		spinlock_lock_disable_intr( &hdlr->tlock, &flags );
+		while( ( !hdlr->pending ) && ( !hdlr->stop ) ) {
+
+			res = sync_wait( &hdlr->wait, &hdlr->tlock );
+			kassert( res == SYNC_WAI_RELEASED );
+		}
+		if ( hdlr->stop ) {  /*  登録抹消済み  */
+
+			spinlock_unlock_restore_intr( &hdlr->tlock, &flags );
+			break;
+		}
+		hdlr->pending = false;
+		spinlock_unlock_restore_intr( &hdlr->tlock, &flags );
+
+		hdlr->thread_fn( hdlr->no, hdlr->private );  /*  スレッド処理を実行  */
+
+		/*
+		 * 同一要因での割込み受付けを再開
+		 */
+		spinlock_lock_disable_intr( &ent->lock, &flags );
+		if ( ( hdlr->masked ) && ( ent->controller != NULL ) ) {
+
+			rc = ent->controller->enable( hdlr->no );
+			kassert( rc == 0 );
+		}
+		hdlr->masked = false;
+		spinlock_unlock_restore_intr( &ent->lock, &flags );
+	}
+
+	kfree( hdlr );  /*  ハンドラ情報のメモリを解放  */
+	thr_exit(0);
+
+	return 0;
+}
+
+/** 割込みハンドラをIRQに追加する
     @param[in] no      割込み番号
-    @param[in] handler 割込みハンドラ
-    @param[in] iflags  割込みハンドラフラグ
-    @param[in] data    プライベートデータ
+    @param[in] hdlr    割込みハンドラの管理情報
     @retval    0       正常に登録した
-    @retval  -ENOMEM   メモリが不足している
     @retval  -EBUSY    既に同一のハンドラが同一のIRQに登録されている
-    @retval  -EPERM    割込みの占有が行えなかったまたは直接関数呼び出し型のハンドラと
-                       非関数呼び出し型のハンドラとで割込み線を共有させようとした
+    @retval  -EPERM    割込みの占有が行えなかった
  */
-int
-irq_register_irq_handler(intr_no no, ihandler_res (*handler)(intr_no _ino, private_inf _data, void *ctx), ihandler_flags iflags, private_inf data) {
+static int
+add_irq_handler(intr_no no, irq_handler *hdlr) {
 	int                   rc;
 	intrflags          flags;
 	irq_entry           *ent;
-	irq_handler        *hdlr;
+	ihandler_flags    iflags;
 
 	kassert( no < NR_IRQS );
 
-	/*
-	 * 割込みハンドラ情報用のメモリを獲得し, 割込みハンドラ情報を設定する
-	 */
-	hdlr = kmalloc( sizeof(irq_handler), KMALLOC_NORMAL );
-	if ( hdlr == NULL ) 
-		return -ENOMEM;
-
-	list_init( &hdlr->link );
-	hdlr->iflags = iflags;
-	hdlr->private = data;
-	hdlr->handler = handler;
-
 	ent = &irq_db.entries[no];
+	iflags = hdlr->iflags;
 
 	spinlock_lock_disable_intr( &ent->lock, &flags);
-	if ( is_irq_handler_installed_nolock(no, handler) ) {
+	if ( is_irq_handler_installed_nolock(no, 
+		( hdlr->thread_fn == NULL ) ? ( hdlr->handler ) : ( NULL ),
+		hdlr->thread_fn ) ) {
 
 		rc = -EBUSY;  /*  同一のハンドラが同一のIRQに登録済み  */
 		goto error_out;
@@ -132,9 +187,196 @@ irq_register_irq_handler(intr_no no, ihandler_res (*handler)(intr_no _ino, priva
 	return 0;
 
 error_out:		
-	kfree( hdlr );
 	spinlock_unlock_restore_intr( &ent->lock, &flags);
 
+	return rc;
+}
+
+/** 割込みハンドラを登録する
+    @param[in] no      割込み番号
+    @param[in] handler 割込みハンドラ
+    @param[in] iflags  割込みハンドラフラグ
+    @param[in] data    プライベートデータ
+    @retval    0       正常に登録した
+    @retval  -ENOMEM   メモリが不足している
+    @retval  -EBUSY    既に同一のハンドラが同一のIRQに登録されている
+    @retval  -EPERM    割込みの占有が行えなかったまたは直接関数呼び出し型のハンドラと
+                       非関数呼び出し型のハンドラとで割込み線を共有させようとした
+ */
+int
+irq_register_irq_handler(intr_no no, ihandler_res (*handler)(intr_no _ino, private_inf _data, void *ctx), ihandler_flags iflags, private_inf data) {
+	int                   rc;
+	irq_handler        *hdlr;
+
+	kassert( no < NR_IRQS );
+	kassert( handler != NULL );
+
+	/*
+	 * 割込みハンドラ情報用のメモリを獲得し, 割込みハンドラ情報を設定する
+	 */
+	hdlr = kmalloc( sizeof(irq_handler), KMALLOC_NORMAL );
+	if ( hdlr == NULL ) 
+		return -ENOMEM;
+
+	memset( hdlr, 0, sizeof(irq_handler) );
+	list_init( &hdlr->link );
+	hdlr->iflags = iflags;
+	hdlr->private = data;
+	hdlr->handler = handler;
+	hdlr->thread_fn = NULL;
+	hdlr->no = no;
+
+	rc = add_irq_handler(no, hdlr);
+	if ( rc != 0 )
+		kfree( hdlr );
+
+	return rc;
+}
+
+/** スレッド化割込みハンドラを登録する
+    @param[in] no        割込み番号
+    @param[in] handler   割込みハンドラ(NULLの場合は常に割込みスレッドに処理を依頼)
+    @param[in] thread_fn 割込みスレッド処理関数
+    @param[in] iflags    割込みハンドラフラグ
+    @param[in] data      プライベートデータ
+    @param[in] prio      割込みスレッドの優先度
+    @retval    0       正常に登録した
+    @retval  -EINVAL   優先度が不正
+    @retval  -ENOMEM   メモリが不足している
+    @retval  -EBUSY    既に同一のハンドラが同一のIRQに登録されている
+    @retval  -EPERM    割込みの占有が行えなかった
+    @note 割込みハンドラがIRQHDL_RES_WAKE_THREADを返却すると, 割込み線を
+    マスクしたまま割込みスレッドを起床し, 割込みスレッド処理関数の完了後に
+    マスクを解除する.
+ */
+int
+irq_register_threaded_irq_handler(intr_no no, 
+    ihandler_res (*handler)(intr_no _ino, private_inf _data, void *ctx), 
+    void (*thread_fn)(intr_no _ino, private_inf _data), ihandler_flags iflags,
+    private_inf data, int prio) {
+	int                   rc;
+	intrflags          flags;
+	irq_handler        *hdlr;
+
+	kassert( no < NR_IRQS );
+	kassert( thread_fn != NULL );
+
+	if ( ( THR_MIN_PRIO > prio ) || ( prio >= THR_MAX_PRIO ) )
+		return -EINVAL;
+
+	hdlr = kmalloc( sizeof(irq_handler), KMALLOC_NORMAL );
+	if ( hdlr == NULL ) 
+		return -ENOMEM;
+
+	memset( hdlr, 0, sizeof(irq_handler) );
+	list_init( &hdlr->link );
+	hdlr->iflags = iflags;
+	hdlr->private = data;
+	hdlr->handler = ( handler != NULL ) ? ( handler ) : 
+		( irq_default_primary_handler );
+	hdlr->thread_fn = thread_fn;
+	hdlr->no = no;
+	spinlock_init( &hdlr->tlock );
+	sync_init_object( &hdlr->wait, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT );
+	hdlr->pending = false;
+	hdlr->stop = false;
+	hdlr->masked = false;
+
+	/*
+	 * 割込みスレッドを生成する
+	 */
+	rc = thr_new_thread( &hdlr->thr );
+	if ( rc != 0 )
+		goto free_hdlr_out;
+
+	rc = thr_create_kthread( hdlr->thr, prio, THR_FLAG_NONE, THR_INVALID_TID,
+	    irq_thread, hdlr );
+	kassert( rc == 0 );
+
+	rc = thr_start( hdlr->thr, current->tid );
+	kassert( rc == 0 );
+
+	rc = add_irq_handler(no, hdlr);
+	if ( rc != 0 )
+		goto stop_thr_out;
+
+	return 0;
+
+stop_thr_out:
+	/*
+	 * 割込みスレッドに停止を依頼する(ハンドラ情報は割込みスレッドが解放する)
+	 */
+	spinlock_lock_disable_intr( &hdlr->tlock, &flags );
+	hdlr->stop = true;
+	spinlock_unlock_restore_intr( &hdlr->tlock, &flags );
+	sync_wake( &hdlr->wait, SYNC_WAI_RELEASED );
+
+	return rc;
+
+free_hdlr_out:
+	kfree( hdlr );
+
+	return rc;
+}
+
+/** スレッド化割込みハンドラの登録を抹消する
+    @param[in] no        割込み番号
+    @param[in] thread_fn 割込みスレッド処理関数
+    @retval    0       正常に登録を抹消した
+    @retval  -ENOENT   引数で指定したハンドラが登録されていない
+    @note ハンドラ情報は割込みスレッドの終了時に解放される
+ */
+int
+irq_unregister_threaded_irq_handler(intr_no no, 
+    void (*thread_fn)(intr_no _ino, private_inf _data)) {
+	int                   rc;
+	intrflags          flags;
+	irq_entry           *ent;
+	irq_handler       *hdlrp;
+	list                 *li;
+
+	kassert( no < NR_IRQS );
+	kassert( thread_fn != NULL );
+
+	ent = &irq_db.entries[no];
+
+	spinlock_lock_disable_intr( &ent->lock, &flags);
+
+	rc = -ENOENT;
+	queue_for_each(li, &ent->hdlr_que) {
+
+		hdlrp = CONTAINER_OF(li, irq_handler, link);
+		if ( hdlrp->thread_fn == thread_fn ) {  /*  抹消対象のハンドラが見つかった */
+
+			rc = 0;
+
+			list_del( &hdlrp->link );  /* 登録を抹消  */
+
+			if ( queue_is_empty(&ent->hdlr_que) )
+				irq_set_mask(no);  /* ハンドラ未登録の場合は割込みをマスク */
+			else if ( ( hdlrp->masked ) && ( ent->controller != NULL ) ) {
+
+				/*  割込みスレッドへの処理依頼中に割込み線をマスク
+				 *  していた場合は, 他のハンドラのために
+				 *  割込みの受付けを再開する
+				 */
+				rc = ent->controller->enable( no );
+				kassert( rc == 0 );
+			}
+			hdlrp->masked = false;
+
+			/*
+			 * 割込みスレッドに停止を依頼する
+			 */
+			spinlock_lock( &hdlrp->tlock );
+			hdlrp->stop = true;
+			spinlock_unlock( &hdlrp->tlock );
+			sync_wake( &hdlrp->wait, SYNC_WAI_RELEASED );
+			break;
+		}
+	}
+
+	spinlock_unlock_restore_intr( &ent->lock, &flags);
 
 	return rc;
 }
@@ -169,7 +411,8 @@ irq_unregister_irq_handler(intr_no no, ihandler_res (*handler)(intr_no _ino, pri
 				      次のノードを獲得 */
 
 		hdlrp = CONTAINER_OF(li, irq_handler, link);
-		if ( hdlrp->handler == handler ) {  /*  抹消対象のハンドラが見つかった */
+		if ( ( hdlrp->thread_fn == NULL ) && ( hdlrp->handler == handler ) ) {
+			/*  抹消対象のハンドラが見つかった */
 
 			rc = 0;
 
@@ -247,6 +490,20 @@ kcom_handle_irqs(intr_no no, void *ctx) {
 		res = hndlrp->handler( no, hndlrp->private, ctx);  /* ハンドラ呼出し  */
 		hal_cpu_restore_interrupt(&flags);  /*  CPUへの割込み状態を復元  */
 
+		if ( res == IRQHDL_RES_WAKE_THREAD ) {
+
+			/*  割込みスレッドに処理を依頼する. 割込み線は
+			 *  割込みスレッドの処理完了までマスクしたままにする
+			 */
+			kassert( hndlrp->thread_fn != NULL );
+			hndlrp->masked = true;  /*  割込みエントリのロック下で更新  */
+			spinlock_lock( &hndlrp->tlock );
+			hndlrp->pending = true;
+			spinlock_unlock( &hndlrp->tlock );
+			sync_wake( &hndlrp->wait, SYNC_WAI_RELEASED );
+			goto unlock_out;  /*  割込み処理完了  */
+		}
+
 		if ( res == IRQHDL_RES_HANDLED ) {
 			
 			/*  ハンドラ内で処理が完結する割込みだった場合は, 
@@ -406,4 +663,6 @@ irq_init_subsys(void) {
 		ent->spurious_cnt = 0;
 		ent->controller = NULL;
 	}
+
+	softirq_init_subsys();  /*  遅延割込み処理機構を初期化  */
 }
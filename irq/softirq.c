@@ -0,0 +1,131 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Soft interrupt routines                                           */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+#include <kern/thread.h>
+#include <kern/softirq.h>
+
+static softirq_cpu softirq_tbl[NR_CPUS];  /*<  CPUごとの遅延処理キュー  */
+
+/** 遅延割込み処理要求を初期化する
+    @param[in] work 遅延処理要求
+    @param[in] func 遅延処理関数
+    @param[in] data 遅延処理関数の引数
+ */
+void
+softirq_init_work(softirq_work *work, void (*func)(private_inf _data),
+    private_inf data) {
+
+	kassert( work != NULL );
+	kassert( func != NULL );
+
+	list_init( &work->link );
+	work->queued = false;
+	work->func = func;
+	work->data = data;
+}
+
+/** 自CPUの遅延割込み処理キューに処理要求を登録する
+    @param[in] work 遅延処理要求
+    @retval    真   新たに登録した
+    @retval    偽   既に登録済みだった
+    @note 割込みハンドラから呼び出し可能. 登録済みの要求は
+    処理されるまで1回分にまとめられる.
+ */
+bool
+softirq_raise(softirq_work *work) {
+	bool            rc;
+	intrflags    flags;
+	softirq_cpu   *cpu;
+
+	kassert( work != NULL );
+
+	hal_cpu_disable_interrupt(&flags);
+
+	cpu = &softirq_tbl[current_cpu()];
+
+	rc = !work->queued;
+	if ( rc ) {
+
+		work->queued = true;
+		queue_add( &cpu->que, &work->link );
+	}
+
+	hal_cpu_restore_interrupt(&flags);
+
+	return rc;
+}
+
+/** 自CPUの保留中の遅延割込み処理を実行する
+    @note 割込み出口から割込み許可状態で呼び出される. 1回の呼び出しで
+    処理する要求はSOFTIRQ_BATCH_MAX個までとし, 残りは次回の割込み出口で
+    処理する. 処理中はディスパッチを禁止し, 各処理関数は割込み許可状態で
+    実行する.
+ */
+void
+softirq_run_pending(void) {
+	int             nr;
+	intrflags    flags;
+	softirq_cpu   *cpu;
+	softirq_work *work;
+
+	ti_disable_dispatch();  /*  処理中のCPU移動/再入を防止  */
+
+	hal_cpu_disable_interrupt(&flags);
+
+	cpu = &softirq_tbl[current_cpu()];
+	if ( ( cpu->running ) || ( queue_is_empty( &cpu->que ) ) )
+		goto unlock_out;  /*  処理中または処理要求なし  */
+
+	cpu->running = true;
+
+	for( nr = 0; ( SOFTIRQ_BATCH_MAX > nr ) && ( !queue_is_empty( &cpu->que ) );
+	     ++nr) {
+
+		work = CONTAINER_OF(queue_get_top( &cpu->que ), softirq_work, link);
+		work->queued = false;  /*  処理中に再度登録可能にする  */
+
+		hal_cpu_restore_interrupt(&flags);
+		work->func( work->data );  /*  遅延処理を実行  */
+		hal_cpu_disable_interrupt(&flags);
+	}
+
+	cpu->running = false;
+
+unlock_out:
+	hal_cpu_restore_interrupt(&flags);
+
+	ti_enable_dispatch();  /*  遅延ディスパッチを処理  */
+}
+
+/** 遅延割込み処理機構を初期化する
+ */
+void
+softirq_init_subsys(void) {
+	int i;
+
+	for( i = 0; NR_CPUS > i; ++i) {
+
+		queue_init( &softirq_tbl[i].que );
+		softirq_tbl[i].running = false;
+	}
+}
@@ -50,7 +50,7 @@ dbg_console_thread(void __attribute__ ((unused)) *arg) {
 
 	/* デバッグ用コンソールサービスをカーネル内のネームサービスに登録
 	 */
-	rc = kns_register_kernel_service(ID_RESV_NAME_DBG_CONSOLE);
+	rc = kns_register_kernel_service(ID_RESV_NAME_DBG_CONSOLE, current->tid);
 	kassert( rc == 0 );
 #if defined(DEBUG_DBG_CON)
 	kprintf(KERN_INF, MSG_PREFIX "Register \"%s\" service by tid=%d rc=%d \n", 
@@ -0,0 +1,236 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Fast user-space mutex routines                                    */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+#include <kern/proc.h>
+#include <kern/vm.h>
+#include <kern/page.h>
+#include <kern/thread.h>
+#include <kern/thread-sync.h>
+#include <kern/timer.h>
+#include <kern/rwsem.h>
+#include <kern/futex.h>
+
+#define FUTEX_HASH_MULT    (0x9E3779B97F4A7C15ULL)  /*<  乗算ハッシュの係数  */
+
+static futex_bucket futex_tbl[FUTEX_HASH_SIZE];  /*<  futex待ちハッシュ表  */
+
+/** (仮想空間, アドレス)の組に対応するハッシュ表エントリを得る
+    @param[in] as    仮想空間
+    @param[in] uaddr 待ち合わせ対象のアドレス
+    @return ハッシュ表エントリ
+ */
+static futex_bucket *
+futex_bucket_of(vm *as, void *uaddr) {
+	uint64_t key;
+
+	key = ( (uintptr_t)as >> 4 ) ^ ( (uintptr_t)uaddr >> 2 );
+
+	return &futex_tbl[ ( key * FUTEX_HASH_MULT ) >> ( 64 - FUTEX_HASH_SHIFT ) ];
+}
+
+/** futex変数をカーネルから参照するアドレスを得る
+    @param[in]  as      操作対象の仮想空間
+    @param[in]  uaddr   futex変数のアドレス
+    @param[out] kvaddrp futex変数のカーネル仮想アドレス返却先
+    @retval     0       正常に参照できた
+    @retval    -EFAULT  futex変数にアクセスできない
+    @note 仮想空間の読み込みロックを獲得して呼び出す.
+    ページ未割り当ての場合はページを割り当てる.
+ */
+static int
+refer_futex_word_nolock(vm *as, void *uaddr, volatile futex_val **kvaddrp) {
+	int             rc;
+	uintptr_t   kvaddr;
+	vma_prot      prot;
+
+	kassert( as != NULL );
+	kassert( rwsem_is_locked(&as->asmtx) );
+	kassert( kvaddrp != NULL );
+
+	if ( as->p == hal_refer_kernel_proc() ) {  /*  カーネルスレッド  */
+
+		*kvaddrp = (volatile futex_val *)uaddr;
+		return 0;
+	}
+
+	if ( (uintptr_t)uaddr >= KERN_VMA_BASE )
+		return -EFAULT;
+
+	rc = hal_translate_user_page(as, (uintptr_t)uaddr, &kvaddr, &prot);
+	if ( rc != 0 ) {
+
+		rc = vm_map_newpage(as, uaddr);
+		if ( rc != 0 )
+			return -EFAULT;
+
+		rc = hal_translate_user_page(as, (uintptr_t)uaddr, &kvaddr, &prot);
+		if ( rc != 0 )
+			return -EFAULT;
+	}
+
+	if ( !( prot & VMA_PROT_R ) )
+		return -EFAULT;
+
+	*kvaddrp = (volatile futex_val *)( kvaddr +
+	    ( (uintptr_t)uaddr - PAGE_START((uintptr_t)uaddr) ) );
+
+	return 0;
+}
+
+/** futex変数の値が期待値である間休眠する
+    @param[in] as    待ち合わせ対象の仮想空間
+    @param[in] uaddr futex変数のアドレス
+    @param[in] val   期待値
+    @param[in] tmout タイムアウト時間(単位:ms, FUTEX_INFINITEの場合は無期限)
+    @retval    0          起床された
+    @retval   -EINVAL     アドレスの境界が不正
+    @retval   -EFAULT     futex変数にアクセスできない
+    @retval   -EAGAIN     futex変数の値が期待値と異なる
+    @retval   -ETIMEDOUT  タイムアウトした
+    @retval   -EINTR      イベントを受信した
+    @note 値の比較と待ちキューへの登録をハッシュ表エントリのロック下で行うことで
+    futex_wakeとの間で起床を取りこぼさないようにする.
+ */
+int
+futex_wait(vm *as, void *uaddr, futex_val val, futex_tmout tmout) {
+	int                      rc;
+	futex_bucket           *bkt;
+	futex_waiter              w;
+	volatile futex_val     *kvp;
+	sync_reason             res;
+	intrflags             flags;
+
+	kassert( as != NULL );
+
+	if ( ( (uintptr_t)uaddr ) & ( sizeof(futex_val) - 1 ) )
+		return -EINVAL;
+
+	list_init( &w.link );
+	w.as = as;
+	w.uaddr = uaddr;
+	sync_init_object( &w.wait, SYNC_WAKE_FLAG_ONE, THR_TSTATE_WAIT );
+
+	bkt = futex_bucket_of(as, uaddr);
+
+	rwsem_down_read( &as->asmtx );
+
+	rc = refer_futex_word_nolock(as, uaddr, &kvp);
+	if ( rc != 0 ) {
+
+		rwsem_up_read( &as->asmtx );
+		goto error_out;
+	}
+
+	spinlock_lock_disable_intr( &bkt->lock, &flags );
+
+	if ( *kvp != val ) {
+
+		rc = -EAGAIN;
+		rwsem_up_read( &as->asmtx );
+		goto unlock_out;
+	}
+
+	queue_add( &bkt->que, &w.link );  /*  待ちキューに登録  */
+
+	/*  休眠中にページが解放されることはないので仮想空間のロックを解放する  */
+	rwsem_up_read( &as->asmtx );
+
+	if ( tmout < 0 )
+		res = sync_wait( &w.wait, &bkt->lock );
+	else
+		res = tim_wait_obj( &w.wait, tmout, &bkt->lock );
+
+	if ( list_not_linked( &w.link ) ) {
+
+		rc = 0;  /*  futex_wakeにより起床された  */
+		goto unlock_out;
+	}
+
+	list_del( &w.link );  /*  待ちキューから外す  */
+
+	if ( res == SYNC_WAI_TIMEOUT )
+		rc = -ETIMEDOUT;
+	else
+		rc = -EINTR;
+
+unlock_out:
+	spinlock_unlock_restore_intr( &bkt->lock, &flags );
+
+error_out:
+	return rc;
+}
+
+/** futex変数で待ち合わせているスレッドを起床する
+    @param[in] as    待ち合わせ対象の仮想空間
+    @param[in] uaddr futex変数のアドレス
+    @param[in] nr    起床するスレッド数の上限(FUTEX_WAKE_ALLの場合は全スレッド)
+    @return    起床したスレッド数
+ */
+int
+futex_wake(vm *as, void *uaddr, int nr) {
+	int              woken;
+	futex_bucket      *bkt;
+	futex_waiter        *w;
+	list       *li, *next;
+	intrflags        flags;
+
+	kassert( as != NULL );
+
+	bkt = futex_bucket_of(as, uaddr);
+
+	woken = 0;
+
+	spinlock_lock_disable_intr( &bkt->lock, &flags );
+
+	queue_for_each_safe(li, &bkt->que, next) {
+
+		if ( ( nr >= 0 ) && ( woken >= nr ) )
+			break;
+
+		w = CONTAINER_OF(li, futex_waiter, link);
+		if ( ( w->as != as ) || ( w->uaddr != uaddr ) )
+			continue;
+
+		list_del( &w->link );  /*  起床済みであることを示す  */
+		sync_wake( &w->wait, SYNC_WAI_RELEASED );
+		++woken;
+	}
+
+	spinlock_unlock_restore_intr( &bkt->lock, &flags );
+
+	return woken;
+}
+
+/** futexハッシュ表を初期化する
+ */
+void
+futex_init_subsys(void) {
+	int i;
+
+	for( i = 0; FUTEX_HASH_SIZE > i; ++i) {
+
+		spinlock_init( &futex_tbl[i].lock );
+		queue_init( &futex_tbl[i].que );
+	}
+}
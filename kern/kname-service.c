@@ -20,7 +20,7 @@
 #include <kern/string.h>
 #include <kern/errno.h>
 #include <kern/spinlock.h>
-#include <kern/rbtree.h>
+#include <kern/queue.h>
 #include <kern/proc.h>
 #include <kern/thread.h>
 #include <kern/vm.h>
@@ -33,50 +33,66 @@
 
 /** サービスDB
  */
-static kserv_db service_db=__KSERV_DB_INITIALIZER( &service_db.head );
+static kserv_db service_db=__KSERV_DB_INITIALIZER;
 
-static int kserv_cmp(struct _kern_service *_a, struct _kern_service *_b);
+/** ハッシュ値に対応するハッシュ表のエントリを得る
+    @param[in] hash サービス名のハッシュ値
+    @return ハッシュ表のエントリ
+ */
+static queue *
+kserv_bucket_of(kserv_hash hash) {
 
-RB_GENERATE_STATIC(kserv_tree, _kern_service, node, kserv_cmp);
+	return &service_db.head[ hash & ( KSERV_HASH_SIZE - 1 ) ];
+}
 
-/** サービス名の比較関数
-    @param[in] a カーネルサービス情報1
-    @param[in] b カーネルサービス情報2
-    @retval 0  比較対象のカーネルサービス情報1とカーネルサービス情報2
-    名前が等しい
-    @retval 負 カーネルサービス情報1の方が辞書順に先の位置にある
-    @retval 正 カーネルサービス情報1の方が辞書順に後の位置にある
+/** サービス名からカーネルサービス情報を検索する
+    @param[in] name サービス名
+    @param[in] hash サービス名のハッシュ値
+    @retval    NULL     サービスが見つからなかった
+    @retval    非NULL   カーネルサービス情報
+    @note サービスDBのロックを獲得して呼び出す.
+    ハッシュ値が一致したエントリについてのみ名前を比較する.
  */
-static int
-kserv_cmp(struct _kern_service *a, struct _kern_service *b) {
+static kern_service *
+kserv_find_nolock(const char *name, kserv_hash hash) {
+	list          *li;
+	kern_service *ent;
+
+	kassert( spinlock_locked_by_self( &service_db.lock ) );
 
-	kassert( a != NULL );
-	kassert( b != NULL );
-	kassert( a->name != NULL );
-	kassert( b->name != NULL );
+	queue_for_each(li, kserv_bucket_of(hash)) {
 
-	return strcmp(a->name, b->name);
+		ent = CONTAINER_OF(li, kern_service, link);
+		if ( ( ent->hash == hash ) && ( strcmp(ent->name, name) == 0 ) )
+			return ent;
+	}
+
+	return NULL;
 }
 
 /** 名前からエンドポイントを検索する
-    @param[in] name サービス名
+    @param[in]  name サービス名
+    @param[out] genp 検索時点の世代番号格納先(NULLの場合は返却しない)
     @retval    ID_RESV_INVALID     サービスが見つからなかった
     @retval    != ID_RESV_INVALID  サービスのエンドポイント
  */
 static endpoint 
-lookup_endpoint_by_name(const char *name) {
+lookup_endpoint_by_name(const char *name, kserv_gen *genp) {
 	endpoint             rc;
-	kern_service serv, *res;
+	kern_service       *res;
+	kserv_hash         hash;
 
 	kassert( !ti_in_intr() );
 	kassert( name != NULL );
 
-	strncpy(serv.name, name, KSERV_NAME_LEN);
-	serv.name[KSERV_NAME_LEN - 1] = '\0';
+	hash = kserv_name_hash(name);
 
 	spinlock_lock( &service_db.lock );
 
-	res = RB_FIND(kserv_tree, &service_db.head, &serv);
+	if ( genp != NULL )
+		*genp = service_db.gen;
+
+	res = kserv_find_nolock(name, hash);
 	if ( res == NULL ) {
 
 		rc = ID_RESV_INVALID;  /* サービスが見つからなかった  */
@@ -100,11 +116,13 @@ unlock_out:
 static void
 handle_lookup_msg(endpoint src, kname_service_msg *knmsg, msg_body *rmsg, char *key) {
 	endpoint           serv_id;
+	kserv_gen              gen;
 
 	kassert( src != LPC_RECV_ANY );
 	kassert( rmsg != NULL );
 
-	serv_id = lookup_endpoint_by_name(key);
+	serv_id = lookup_endpoint_by_name(key, &gen);
+	knmsg->gen = gen;  /*  名前解決キャッシュの世代番号を返却  */
 	if ( serv_id == ID_RESV_INVALID ){
 			
 		/*  対象のサービスがいない場合  */
@@ -159,10 +177,14 @@ handle_register_msg(endpoint src, kname_service_msg *knmsg, msg_body *rmsg,
 	 * サービス名とIDを登録する
 	 */
 	strcpy(servp->name, key);
+	servp->hash = kserv_name_hash(servp->name);  /*  ハッシュ値を算出しておく  */
 	servp->id = id;
+	list_init( &servp->link );
 
 	spinlock_lock( &service_db.lock );
-	res = RB_INSERT(kserv_tree, &service_db.head, servp);
+	res = kserv_find_nolock(servp->name, servp->hash);
+	if ( res == NULL )
+		queue_add( kserv_bucket_of(servp->hash), &servp->link );
 	spinlock_unlock( &service_db.lock );
 
 	if ( res != NULL ){
@@ -200,7 +222,6 @@ static void
 handle_unregister_msg(endpoint src, kname_service_msg *knmsg, msg_body *rmsg, 
     char *key) {
 	kern_service  *res;
-	kern_service  serv;
 
 	kassert( !ti_in_intr() );
 	kassert( src != LPC_RECV_ANY );
@@ -210,17 +231,15 @@ handle_unregister_msg(endpoint src, kname_service_msg *knmsg, msg_body *rmsg,
 	/*
 	 * サービス名を検索し, 存在したら消去する
 	 */
-	strcpy(serv.name, key);
-
 	spinlock_lock( &service_db.lock );
 
-	res = RB_FIND(kserv_tree, &service_db.head, &serv);
+	res = kserv_find_nolock(key, kserv_name_hash(key));
 	if ( res == NULL ){
 			
 		/*  対象のサービスが存在しない  */
 #if defined(DEBUG_KNAMEDB)
 	kprintf(KERN_INF, "kernel name service: service not found name=%s\n", 
-	    serv.name);
+	    key);
 #endif  /*  DEBUG_KNAMEDB  */
 		knmsg->rc = -ENOENT;
 		goto unlock_out;
@@ -232,8 +251,14 @@ handle_unregister_msg(endpoint src, kname_service_msg *knmsg, msg_body *rmsg,
 #endif  /*  DEBUG_KNAMEDB  */
 	
 
-	RB_REMOVE(kserv_tree, &service_db.head, res);
+	list_del( &res->link );
 	kfree( res );
+	knmsg->rc = 0;
+
+	/*
+	 * 名前解決キャッシュを無効化するため世代番号を更新する
+	 */
+	++service_db.gen;
 
 unlock_out:
 	spinlock_unlock( &service_db.lock );
@@ -320,13 +345,14 @@ kname_service(void __attribute__ ((unused)) *arg) {
 	return 0;
 }
 
-/** 自スレッドをカーネルサービス提供者として登録する
+/** カーネルサービス提供者を登録する
     @param[in] name  サービス名
+    @param[in] id    サービスのエンドポイント(スレッドIDまたはポートID)
     @retval    0         正常終了
     @retval   -EFAULT    nameがNULL
  */
 int
-kns_register_kernel_service(const char *name){
+kns_register_kernel_service(const char *name, endpoint id){
 	int                  rc;
 	msg_body            msg;
 	kname_service_msg *nsrv;
@@ -342,7 +368,7 @@ kns_register_kernel_service(const char *name){
 	nsrv->req = KSERV_REG_SERVICE;
 	nsrv->name = name;
 	nsrv->len = strlen(nsrv->name);
-	nsrv->id = current->tid;
+	nsrv->id = id;
 	rc = lpc_send_and_reply(ID_RESV_NAME_SERV, &msg);
 	kassert( rc == 0 );
 
@@ -389,34 +415,38 @@ kns_unregister_kernel_service(const char *name) {
     @param[out] ep     エンドポイント格納先アドレス    
     @retval    0       正常終了
     @retval   -EFAULT  nameがNULL
+    @retval   -ENOENT  サービスが登録されていない
  */
 int
 kns_lookup_service_by_name(const char *name, endpoint *ep){
-	int                  rc;
-	msg_body            msg;
-	kname_service_msg *nsrv;
+	endpoint        id;
 
 	if ( name == NULL ) {
 		
 		return -EFAULT;
 	}
 
-	nsrv = &msg.kname_msg;
-	
-	memset( &msg, 0, sizeof(msg_body) );
-	nsrv->req = KSERV_LOOKUP;
-	nsrv->name = name;
-	nsrv->len = strlen(nsrv->name);
+	/*
+	 * カーネル内からはネームサービススレッドを経由せずに
+	 * ハッシュ表を直接検索する
+	 */
+	id = lookup_endpoint_by_name(name, NULL);
+	if ( id == ID_RESV_INVALID )
+		return -ENOENT;
 
-	rc = lpc_send_and_reply(ID_RESV_NAME_SERV, &msg);
-	kassert( rc == 0 );
+	*ep = id;
 
-	if ( nsrv->rc != 0 )
-		return nsrv->rc;
+	return 0;
+}
 
-	*ep = nsrv->id;
+/** 名前解決キャッシュの世代番号を得る
+    @return 現在の世代番号
+    @note 世代番号はサービスの登録を解除する度に更新される
+ */
+kserv_gen
+kns_current_generation(void) {
 
-	return 0;
+	return service_db.gen;
 }
 
 /** カーネルサービスの起動
@@ -424,9 +454,11 @@ kns_lookup_service_by_name(const char *name, endpoint *ep){
 void
 kernel_name_service_init(void) {
 	int rc;
+	int  i;
 
 	spinlock_init( &service_db.lock );
-	RB_INIT( &service_db.head );
+	for( i = 0; KSERV_HASH_SIZE > i; ++i) 
+		queue_init( &service_db.head[i] );
 
 	rc = thr_new_thread( &service_db.thr );
 	kassert( rc == 0 );
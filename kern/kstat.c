@@ -0,0 +1,262 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  kernel statistics routines                                        */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/kstat.h>
+
+/** カーネル統計情報
+ */
+static struct _kstat_info{
+	spinlock                              lock;  /*< 統計情報のロック          */
+	volatile bool                      enabled;  /*< 統計情報採取中            */
+	kstat_latency  syscalls[KSTAT_NR_SYSCALLS];  /*< システムコール毎の統計    */
+	kstat_latency        traps[KSTAT_NR_TRAPS];  /*< トラップ毎の統計          */
+	kstat_pgflt                          pgflt;  /*< ページフォルト処理結果    */
+}kstat_info;
+
+/** 処理時間に対応するヒストグラムのバケットを得る
+    @param[in] cycles 処理時間(TSCカウント)
+    @return バケットのインデクス
+ */
+static int
+kstat_hist_index(uint64_t cycles) {
+	int idx;
+
+	if ( cycles < 2 )
+		return 0;
+
+	idx = 63 - __builtin_clzll(cycles);
+	if ( idx >= KSTAT_HIST_NR )
+		idx = KSTAT_HIST_NR - 1;
+
+	return idx;
+}
+
+/** 処理時間を記録する
+    @param[in] lat    記録先
+    @param[in] cycles 処理時間(TSCカウント)
+ */
+static void
+kstat_add_latency(kstat_latency *lat, uint64_t cycles) {
+	intrflags flags;
+
+	spinlock_lock_disable_intr( &kstat_info.lock, &flags );
+	++lat->count;
+	lat->total += cycles;
+	++lat->hist[kstat_hist_index(cycles)];
+	spinlock_unlock_restore_intr( &kstat_info.lock, &flags );
+}
+
+/** 処理時間の統計を出力する
+    @param[in] name 統計対象の種別名
+    @param[in] no   統計対象の番号
+    @param[in] lat  出力対象の統計
+ */
+static void
+kstat_show_latency(const char *name, uint64_t no, kstat_latency *lat) {
+	int i;
+
+	if ( lat->count == 0 )
+		return;
+
+	kprintf(KERN_INF, "%s[%lu]: count=%lu avg=%lu cycles\n",
+	    name, no, lat->count, lat->total / lat->count);
+
+	for( i = 0; KSTAT_HIST_NR > i; ++i) {
+
+		if ( lat->hist[i] == 0 )
+			continue;
+
+		kprintf(KERN_INF, "    [2^%d, 2^%d): %lu\n", i, i + 1, lat->hist[i]);
+	}
+}
+
+/** 統計情報採取中であることを確認する
+    @retval true  統計情報採取中
+    @retval false 統計情報採取停止中
+ */
+bool
+kstat_is_enabled(void) {
+
+	return kstat_info.enabled;
+}
+
+/** 統計情報を操作する
+    @param[in] cmd 操作コマンド
+    @retval    0       正常終了
+    @retval   -EINVAL  不正なコマンド
+ */
+int
+kstat_control(int cmd) {
+	intrflags flags;
+
+	switch( cmd ) {
+
+	case KSTAT_CTRL_DISABLE:
+		kstat_info.enabled = false;
+		break;
+	case KSTAT_CTRL_ENABLE:
+		kstat_info.enabled = true;
+		break;
+	case KSTAT_CTRL_RESET:
+		spinlock_lock_disable_intr( &kstat_info.lock, &flags );
+		memset( &kstat_info.syscalls[0], 0, sizeof(kstat_info.syscalls) );
+		memset( &kstat_info.traps[0], 0, sizeof(kstat_info.traps) );
+		memset( &kstat_info.pgflt, 0, sizeof(kstat_info.pgflt) );
+		spinlock_unlock_restore_intr( &kstat_info.lock, &flags );
+		break;
+	case KSTAT_CTRL_SHOW:
+		kstat_show();
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/** システムコールの処理時間を記録する
+    @param[in] no     システムコール番号
+    @param[in] cycles 処理時間(TSCカウント)
+ */
+void
+kstat_record_syscall(uint64_t no, uint64_t cycles) {
+
+	if ( ( !kstat_info.enabled ) || ( no >= KSTAT_NR_SYSCALLS ) )
+		return;
+
+	kstat_add_latency( &kstat_info.syscalls[no], cycles );
+}
+
+/** トラップ/割込みの処理時間を記録する
+    @param[in] trapno トラップ番号
+    @param[in] cycles 処理時間(TSCカウント)
+ */
+void
+kstat_record_trap(uint64_t trapno, uint64_t cycles) {
+
+	if ( ( !kstat_info.enabled ) || ( trapno >= KSTAT_NR_TRAPS ) )
+		return;
+
+	kstat_add_latency( &kstat_info.traps[trapno], cycles );
+}
+
+/** ページフォルトの処理結果を記録する
+    @param[in] outcome 処理結果(KSTAT_PGFLT_DEMAND, KSTAT_PGFLT_STACK, KSTAT_PGFLT_SEGV)
+ */
+void
+kstat_record_pgflt(int outcome) {
+	intrflags flags;
+
+	kassert( ( 0 <= outcome ) && ( outcome < KSTAT_PGFLT_NR ) );
+
+	if ( !kstat_info.enabled )
+		return;
+
+	spinlock_lock_disable_intr( &kstat_info.lock, &flags );
+	++kstat_info.pgflt.count[outcome];
+	spinlock_unlock_restore_intr( &kstat_info.lock, &flags );
+}
+
+/** 処理時間の統計を取得する
+    @param[in]  kind 統計の種別(KSTAT_KIND_SYSCALL, KSTAT_KIND_TRAP)
+    @param[in]  no   システムコール番号またはトラップ番号
+    @param[out] res  統計返却先
+    @retval     0       正常に取得した
+    @retval    -EINVAL  種別または番号が不正
+ */
+int
+kstat_get_latency(int kind, uint64_t no, kstat_latency *res) {
+	kstat_latency *lat;
+	intrflags    flags;
+
+	kassert( res != NULL );
+
+	if ( ( kind == KSTAT_KIND_SYSCALL ) && ( no < KSTAT_NR_SYSCALLS ) )
+		lat = &kstat_info.syscalls[no];
+	else if ( ( kind == KSTAT_KIND_TRAP ) && ( no < KSTAT_NR_TRAPS ) )
+		lat = &kstat_info.traps[no];
+	else
+		return -EINVAL;
+
+	spinlock_lock_disable_intr( &kstat_info.lock, &flags );
+	memcpy( res, lat, sizeof(kstat_latency) );
+	spinlock_unlock_restore_intr( &kstat_info.lock, &flags );
+
+	return 0;
+}
+
+/** ページフォルト処理結果の統計を取得する
+    @param[out] res  統計返却先
+ */
+void
+kstat_get_pgflt(kstat_pgflt *res) {
+	intrflags    flags;
+
+	kassert( res != NULL );
+
+	spinlock_lock_disable_intr( &kstat_info.lock, &flags );
+	memcpy( res, &kstat_info.pgflt, sizeof(kstat_pgflt) );
+	spinlock_unlock_restore_intr( &kstat_info.lock, &flags );
+}
+
+/** 統計情報をコンソールに出力する
+ */
+void
+kstat_show(void) {
+	uint64_t        i;
+	kstat_latency lat;
+	kstat_pgflt    pf;
+
+	kprintf(KERN_INF, "kstat: %s\n", 
+	    ( kstat_info.enabled ) ? ("enabled") : ("disabled"));
+
+	for( i = 0; KSTAT_NR_SYSCALLS > i; ++i) {
+
+		kstat_get_latency(KSTAT_KIND_SYSCALL, i, &lat);
+		kstat_show_latency("syscall", i, &lat);
+	}
+
+	for( i = 0; KSTAT_NR_TRAPS > i; ++i) {
+
+		kstat_get_latency(KSTAT_KIND_TRAP, i, &lat);
+		kstat_show_latency("trap", i, &lat);
+	}
+
+	kstat_get_pgflt(&pf);
+	kprintf(KERN_INF, "page fault: demand=%lu stack=%lu segv=%lu\n",
+	    pf.count[KSTAT_PGFLT_DEMAND], pf.count[KSTAT_PGFLT_STACK], 
+	    pf.count[KSTAT_PGFLT_SEGV]);
+}
+
+/** カーネル統計情報を初期化する
+ */
+void
+kstat_init_subsys(void) {
+
+	memset( &kstat_info, 0, sizeof(kstat_info) );
+	spinlock_init( &kstat_info.lock );
+#if defined(CONFIG_KSTAT_BOOT_ENABLE)
+	kstat_info.enabled = true;   /*  起動時から統計情報を採取する  */
+#else
+	kstat_info.enabled = false;
+#endif  /*  CONFIG_KSTAT_BOOT_ENABLE  */
+}
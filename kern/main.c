@@ -23,6 +23,8 @@
 #include <kern/timer.h>
 #include <kern/page.h>
 #include <kern/kname-service.h>
+#include <kern/futex.h>
+#include <kern/kstat.h>
 
 #include <kern/tst-progs.h>
 
@@ -44,6 +46,13 @@ _setup_test_progs(void) {
 	//wait_test();
 	//thread_round_robin_test();
 	//mutex_test();
+	//rwsem_test();
+	//futex_test();
+	//lpc_bench_test();
+	//lpc_async_test();
+	//lpc_batch_test();
+	//lpc_stress_test();
+	//lpc_wait_test();
 }
 
 void
@@ -55,6 +64,8 @@ kcom_start_kernel(void) {
 	idle_init_subsys();
 	irq_init_subsys();
 	tim_init_subsys();
+	futex_init_subsys();
+	kstat_init_subsys();
 
 	hal_init_pic();
 
@@ -41,6 +41,7 @@ static thread *proc_service_thr;
     @retval    0       正常に送信した
     @retval   -ENOENT  要求元が存在しない
     @retval   -ENOMEM  メモリ不足により送信に失敗した
+    @retval   -EINVAL  集約配送できないイベントを指定した
  */
 static int
 handle_send_event(proc_sys_send_event *sndev, endpoint src) {
@@ -66,6 +67,9 @@ handle_send_event(proc_sys_send_event *sndev, endpoint src) {
 	src_tid = thr->tid;
 	release_all_thread_lock(&flags);
 
+	if ( sndev->type == PROC_SERV_SNDEV_NOTIFY )
+		return ev_notify(sndev->dest, sndev->id);  /*  ノードを割り当てない  */
+
 	rc = ev_alloc_node(sndev->id, &node);	
 	if ( rc != 0 ) 
 		goto error_out;
@@ -131,15 +135,19 @@ handle_send_event(proc_sys_send_event *sndev, endpoint src) {
 		if ( rc != 0 )
 			goto free_mem_out;
 
-		kfree(node);
+		ev_put_node(node);  /*  配送処理の参照を解放  */
 
 		break;
+	case PROC_SERV_SNDEV_NOTIFY:  /*  ノード割当て前に処理済み  */
+	default:
+		rc = -EINVAL;
+		goto free_mem_out;
 	}
 
 	return 0;
 
 free_mem_out:
-	kfree( node );
+	ev_put_node( node );
 error_out:
 	return rc;
 }
@@ -282,7 +290,7 @@ handle_proc_service(void __attribute__ ((unused)) *arg) {
 	endpoint                   src;
 	int                         rc;
 
-	rc = kns_register_kernel_service(ID_RESV_NAME_PROC);
+	rc = kns_register_kernel_service(ID_RESV_NAME_PROC, current->tid);
 	kassert( rc == 0 );
 	
 	while(1) {
@@ -0,0 +1,269 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  reader-writer semaphore routines                                  */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/thread.h>
+#include <kern/thread-sync.h>
+#include <kern/sched.h>
+#include <kern/rwsem.h>
+
+/** 待ちスレッドにロックを引き渡す
+    @param[in] sem 操作対象の読み書きセマフォ
+    @note 書き込み待ちスレッドを優先して起床する.
+    起床したスレッドはロック獲得済みの状態で待ちから復帰する.
+    @note セマフォのロックを獲得した状態で呼び出す
+ */
+static void
+handoff_lock_nolock(rwsem *sem) {
+	sync_block *blk;
+
+	kassert( spinlock_locked_by_self(&sem->lock) );
+	kassert( sem->owner == NULL );
+	kassert( sem->readers == 0 );
+
+	if ( sem->wr_waiting > 0 ) {
+
+		/*
+		 * 書き込み待ちキューの先頭スレッドを所有者にしてから起床する
+		 */
+		kassert( !queue_is_empty( &sem->wr_waiter.que ) );
+		blk = CONTAINER_OF(queue_ref_top( &sem->wr_waiter.que ),
+		    sync_block, olink);
+		sem->owner = blk->thr;
+		--sem->wr_waiting;
+		sync_wake( &sem->wr_waiter, SYNC_WAI_RELEASED);
+		return;
+	}
+
+	if ( sem->rd_waiting > 0 ) {
+
+		/*
+		 * 読み込み待ちスレッド全てを読み込みロック保持者として起床する
+		 */
+		sem->readers += sem->rd_waiting;
+		sem->rd_waiting = 0;
+		sync_wake( &sem->rd_waiter, SYNC_WAI_RELEASED);
+	}
+}
+
+/** 読み書きセマフォを初期化する
+    @param[in] sem 初期化対象の読み書きセマフォ
+ */
+void
+rwsem_init(rwsem *sem){
+
+	kassert( sem != NULL );
+
+	spinlock_init( &sem->lock );
+	sync_init_object( &sem->rd_waiter, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT);
+	sync_init_object( &sem->wr_waiter, SYNC_WAKE_FLAG_ONE, THR_TSTATE_WAIT);
+	sem->readers = 0;
+	sem->rd_waiting = 0;
+	sem->wr_waiting = 0;
+	sem->owner = NULL;
+}
+
+/** 読み書きセマフォを破棄する
+    @param[in] sem 破棄対象の読み書きセマフォ
+ */
+void
+rwsem_destroy(rwsem *sem){
+	intrflags flags;
+
+	kassert( sem != NULL );
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+	sem->readers = 0;
+	sem->rd_waiting = 0;
+	sem->wr_waiting = 0;
+	sem->owner = NULL;
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+
+	sync_wake( &sem->rd_waiter, SYNC_OBJ_DESTROYED);
+	sync_wake( &sem->wr_waiter, SYNC_OBJ_DESTROYED);
+}
+
+/** 読み込みロックを獲得する
+    @param[in] sem 操作対象の読み書きセマフォ
+    @retval    true  ロックを獲得した
+    @retval    false セマフォが破棄された
+ */
+bool
+rwsem_down_read(rwsem *sem){
+	intrflags flags;
+	sync_reason rc;
+	bool       ret;
+
+	kassert( sem != NULL );
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+	/*
+	 * 書き込みロック保持者または書き込み待ちスレッドがいる間は待ち合わせる
+	 */
+	while( ( sem->owner != NULL ) || ( sem->wr_waiting > 0 ) ) {
+
+		++sem->rd_waiting;
+		rc = sync_wait( &sem->rd_waiter, &sem->lock );
+		if ( rc == SYNC_WAI_RELEASED )
+			goto success_out;  /*  解放側で読み込み保持者として計上済み  */
+
+		if ( rc == SYNC_OBJ_DESTROYED ) {
+
+			ret = false;
+			goto unlock_out;
+		}
+
+		--sem->rd_waiting;  /*  イベント受信による起床  */
+	}
+
+	++sem->readers;
+
+success_out:
+	ret = true;
+
+unlock_out:
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+
+	return ret;
+}
+
+/** 読み込みロックを解放する
+    @param[in] sem 操作対象の読み書きセマフォ
+ */
+void
+rwsem_up_read(rwsem *sem){
+	intrflags flags;
+
+	kassert( sem != NULL );
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+
+	kassert( sem->readers > 0 );
+	kassert( sem->owner == NULL );
+
+	--sem->readers;
+	if ( sem->readers == 0 )
+		handoff_lock_nolock(sem);
+
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+}
+
+/** 書き込みロックを獲得する
+    @param[in] sem 操作対象の読み書きセマフォ
+    @retval    true  ロックを獲得した
+    @retval    false セマフォが破棄された
+ */
+bool
+rwsem_down_write(rwsem *sem){
+	intrflags flags;
+	sync_reason rc;
+	bool       ret;
+
+	kassert( sem != NULL );
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+
+	kassert( sem->owner != current );
+
+	while( ( sem->owner != NULL ) || ( sem->readers > 0 ) ) {
+
+		++sem->wr_waiting;
+		rc = sync_wait( &sem->wr_waiter, &sem->lock );
+		if ( rc == SYNC_WAI_RELEASED ) {
+
+			kassert( sem->owner == current );  /*  解放側で所有者に設定済み  */
+			goto success_out;
+		}
+
+		if ( rc == SYNC_OBJ_DESTROYED ) {
+
+			ret = false;
+			goto unlock_out;
+		}
+
+		--sem->wr_waiting;  /*  イベント受信による起床  */
+	}
+
+	sem->owner = current;
+
+success_out:
+	ret = true;
+
+unlock_out:
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+
+	return ret;
+}
+
+/** 書き込みロックを解放する
+    @param[in] sem 操作対象の読み書きセマフォ
+ */
+void
+rwsem_up_write(rwsem *sem){
+	intrflags flags;
+
+	kassert( sem != NULL );
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+
+	kassert( sem->owner == current );
+	kassert( sem->readers == 0 );
+
+	sem->owner = NULL;
+	handoff_lock_nolock(sem);
+
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+}
+
+/** 読み書きセマフォがいずれかのモードでロックされていることを確認する
+    @param[in] sem 操作対象の読み書きセマフォ
+    @retval    true  読み込みまたは書き込みロックされている
+    @retval    false ロックされていない
+ */
+bool
+rwsem_is_locked(rwsem *sem){
+	intrflags flags;
+	bool         rc;
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+	rc = ( ( sem->owner != NULL ) || ( sem->readers > 0 ) );
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+
+	return rc;
+}
+
+/** 自スレッドが書き込みロックを保持していることを確認する
+    @param[in] sem 操作対象の読み書きセマフォ
+    @retval    true  自スレッドが書き込みロックを保持している
+    @retval    false 自スレッドが書き込みロックを保持していない
+ */
+bool
+rwsem_write_locked_by_self(rwsem *sem){
+	intrflags flags;
+	bool         rc;
+
+	spinlock_lock_disable_intr( &sem->lock , &flags );
+	rc = ( sem->owner == current );
+	spinlock_unlock_restore_intr( &sem->lock, &flags);
+
+	return rc;
+}
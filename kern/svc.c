@@ -23,6 +23,12 @@
 #include <kern/proc.h>
 #include <kern/thread.h>
 #include <kern/vm.h>
+#include <kern/vm-grant.h>
+#include <kern/lpc-ring.h>
+#include <kern/futex.h>
+#include <kern/kstat.h>
+#include <kern/kname-service.h>
+#include <kern/async-event.h>
 
 /**  ユーザ空間のイベントハンドラアドレスを登録する
      @param[in] u_evhandler ハンドラアドレス
@@ -177,3 +183,469 @@ svc_lpc_send_and_reply(endpoint dest, void *m) {
 
 	return lpc_send_and_reply(dest, m);
 }
+
+/** 短メッセージを送信する
+    @param[in] dest  送信先エンドポイント
+    @param[in] sm    送信する短メッセージ(システムコール引数レジスタから取得済み)
+    @retval    0     正常に送信した
+ */
+int
+svc_lpc_short_send(endpoint dest, lpc_short_msg *sm) {
+
+	return lpc_send_short(dest, LPC_INFINITE, sm);
+}
+
+/** 短メッセージを受信する
+    @param[in]  src     送信元エンドポイント
+    @param[in]  tmout   タイムアウト時間(単位:ms)
+    @param[out] sm      受信した短メッセージの格納先
+    @param[out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @note 受信した短メッセージは, 呼出元でトラップコンテキストに書き戻す
+ */
+int
+svc_lpc_short_recv(endpoint src, lpc_tmout tmout, lpc_short_msg *sm, 
+    endpoint *msg_src){
+	
+	return lpc_recv_short(src, tmout, sm, msg_src);
+}
+
+/** 短メッセージを送信し短メッセージによる返信を待ち受ける
+    @param[in]     dest   送信先エンドポイント
+    @param[in,out] sm     送受信する短メッセージ
+    @retval    0       正常に受信した
+ */
+int
+svc_lpc_short_call(endpoint dest, lpc_short_msg *sm) {
+
+	return lpc_short_call(dest, sm);
+}
+
+/** メッセージを非同期に送信する
+    @param[in]  dest  送信先エンドポイント
+    @param[in]  m     送信電文
+    @param[out] idp   割り当てた要求ID格納先
+    @retval    0       送信先のキューに登録した
+    @retval   -EAGAIN  送信先のキューに空きがない
+ */
+int
+svc_lpc_send_async(endpoint dest, void *m, lpc_req_id *idp) {
+
+	return lpc_send_async(dest, m, idp);
+}
+
+/** 非同期送信の配送結果を回収する
+    @param[in]  tmout    タイムアウト時間(単位:ms)
+    @param[out] idp      配送結果に対応する要求ID格納先
+    @param[out] statusp  配送結果格納先
+    @retval    0       配送結果を回収した
+    @retval   -EAGAIN  回収可能な配送結果がない
+ */
+int
+svc_lpc_async_wait(lpc_tmout tmout, lpc_req_id *idp, int *statusp) {
+
+	return lpc_async_wait(tmout, idp, statusp);
+}
+
+/** 要求IDと共にメッセージを受信する
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @param[out]    reqp    受信したメッセージの要求ID格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+ */
+int
+svc_lpc_recv_req(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src,
+    lpc_req_id *reqp){
+
+	return lpc_recv_req(src, tmout, m, msg_src, reqp);
+}
+
+/** 複数のメッセージを一括して受信する
+    @param[in]  src   送信元エンドポイント
+    @param[in]  tmout タイムアウト時間(単位:ms)
+    @param[out] ents  受信したメッセージの格納先配列
+    @param[in]  nr    格納先配列の要素数
+    @return    正  受信したメッセージ数
+    @retval   -EAGAIN  電文がなかった
+ */
+int
+svc_lpc_recv_batch(endpoint src, lpc_tmout tmout, lpc_batch_ent *ents, int nr){
+
+	return lpc_recv_batch(src, tmout, ents, nr);
+}
+
+/** 一括受信したメッセージに一括して応答する
+    @param[in,out] ents  応答メッセージの配列
+    @param[in]     nr    配列の要素数
+    @return    0以上   送信に成功した応答数
+ */
+int
+svc_lpc_reply_batch(lpc_batch_ent *ents, int nr){
+
+	return lpc_reply_batch(ents, nr);
+}
+
+/** 複数のエンドポイントとイベントを同時に待ち合わせる
+    @param[in]  eps    待ち合わせ対象エンドポイントの配列
+    @param[in]  nr     配列の要素数
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[out] readyp 受信可能な要因のビットマップ返却先
+    @return    正  受信可能な要因の数
+    @retval   -EAGAIN     受信可能な要因がなかった(ポーリング時)
+    @retval   -ETIMEDOUT  タイムアウトした
+ */
+int
+svc_lpc_wait_any(endpoint *eps, int nr, lpc_tmout tmout, uint64_t *readyp){
+
+	return lpc_wait_any(eps, nr, tmout, readyp);
+}
+
+/** 自プロセスのページを指定した受信者に提供する
+    @param[in]  grantee 受信者のエンドポイント
+    @param[in]  start   提供する領域の開始アドレス
+    @param[in]  size    提供する領域の長さ
+    @param[in]  prot    受信者に許可するアクセス属性
+    @param[out] idp     グラントID返却先
+    @retval     0       正常に提供した
+    @retval    -EINVAL  領域の境界またはアクセス属性が不正
+    @retval    -EFAULT  提供する領域にアクセスできない
+ */
+int
+svc_vm_grant(endpoint grantee, void *start, size_t size, vma_prot prot,
+    vm_grant_id *idp){
+
+	return vm_grant_create(grantee, start, size, prot, idp);
+}
+
+/** 提供されたページを自プロセスの仮想空間にマップする
+    @param[in] id    グラントID
+    @param[in] addr  マップ先のアドレス
+    @param[in] prot  マップ時のアクセス属性
+    @retval     0       正常にマップした
+    @retval    -ENOENT  グラントが存在しない
+    @retval    -EPERM   受信者以外のスレッドから呼び出した
+ */
+int
+svc_vm_grant_map(vm_grant_id id, void *addr, vma_prot prot){
+
+	return vm_grant_map(id, addr, prot);
+}
+
+/** 提供されたページのマップを解除する
+    @param[in] id グラントID
+    @retval     0       正常にアンマップした
+    @retval    -ENOENT  グラントが自プロセスにマップされていない
+ */
+int
+svc_vm_grant_unmap(vm_grant_id id){
+
+	return vm_grant_unmap(id);
+}
+
+/** 提供したページを取り消す
+    @param[in] id グラントID
+    @retval     0       正常に取り消した
+    @retval    -ENOENT  グラントが存在しない
+    @retval    -EPERM   提供元以外のプロセスから呼び出した
+ */
+int
+svc_vm_grant_revoke(vm_grant_id id){
+
+	return vm_grant_revoke(id);
+}
+
+/** ヒープ範囲を伸縮する
+    @param[in]  inc    ヒープ終端の増分(負の場合は縮小, 0の場合は伸縮しない)
+    @param[out] uoldp  変更前のヒープ終端返却先ユーザ空間アドレス
+    @retval     0       正常に更新した
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -EINVAL  ヒープの先頭より前に縮小しようとした
+    @retval    -EBUSY   他の領域と衝突する
+    @retval    -ENOMEM  メモリ不足
+    @retval    -EFAULT  返却先にアクセスできない
+    @note VMサーバを経由せずに呼出元のコンテキストで処理する
+ */
+int
+svc_vm_sbrk(intptr_t inc, void **uoldp){
+	int        rc;
+	void *old_end;
+
+	if ( current->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	rc = proc_sbrk(current->p, inc, &old_end);
+	if ( rc != 0 )
+		return rc;
+
+	rc = vm_copy_out(&current->p->vm, uoldp, &old_end, sizeof(void *));
+
+	return ( rc < 0 ) ? ( rc ) : ( 0 );
+}
+
+/** 匿名メモリ領域を生成する
+    @param[in]  addr    領域の先頭アドレス(ページ境界, NULLの場合は空き領域に割り当てる)
+    @param[in]  size    領域長
+    @param[in]  prot    保護属性
+    @param[out] uaddrp  生成した領域の先頭アドレス返却先ユーザ空間アドレス
+    @retval     0       正常に生成した
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -EINVAL  アドレスまたは領域長が不正
+    @retval    -EBUSY   他の領域と衝突する
+    @retval    -ENOMEM  空き領域がないまたはメモリ不足
+    @retval    -EFAULT  返却先にアクセスできない
+ */
+int
+svc_vm_map_anon(void *addr, size_t size, vma_prot prot, void **uaddrp){
+	int        rc;
+	void  *mapped;
+
+	if ( current->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	rc = vm_map_anon(&current->p->vm, addr, size, 
+	    prot & ( VMA_PROT_R | VMA_PROT_W | VMA_PROT_X ), &mapped);
+	if ( rc != 0 )
+		return rc;
+
+	rc = vm_copy_out(&current->p->vm, uaddrp, &mapped, sizeof(void *));
+	if ( rc < 0 ) {
+
+		vm_unmap_anon(&current->p->vm, mapped, size);
+		return rc;
+	}
+
+	return 0;
+}
+
+/** 匿名メモリ領域を破棄する
+    @param[in] addr   領域の先頭アドレス
+    @param[in] size   領域長
+    @retval    0      正常に破棄した
+    @retval   -EPERM  カーネルスレッドから呼び出したまたは匿名メモリ領域ではない
+    @retval   -EINVAL 領域全体を指定していない
+    @retval   -ENOENT 指定したアドレスに領域がない
+ */
+int
+svc_vm_unmap_anon(void *addr, size_t size){
+
+	if ( current->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	return vm_unmap_anon(&current->p->vm, addr, size);
+}
+
+/** 共有メモリリングチャネルを生成し, 自プロセスの仮想空間にマップする
+    @param[in]  peer     接続を許可するエンドポイント
+    @param[in]  nr_pages チャネルのページ数
+    @param[in]  addr     マップ先のアドレス
+    @param[out] idp      チャネルID返却先
+    @retval     0       正常に生成した
+    @retval    -EINVAL  アドレスの境界またはページ数が不正
+    @retval    -EBUSY   マップ先の領域が使用中
+ */
+int
+svc_lpc_ring_create(endpoint peer, obj_cnt_type nr_pages, void *addr,
+    lpc_ring_id *idp){
+
+	return lpc_ring_create(peer, nr_pages, addr, idp);
+}
+
+/** 生成済みのリングチャネルを自プロセスの仮想空間にマップする
+    @param[in] id    チャネルID
+    @param[in] addr  マップ先のアドレス
+    @retval     0       正常にマップした
+    @retval    -ENOENT  チャネルが存在しない
+    @retval    -EPERM   接続を許可されていない
+ */
+int
+svc_lpc_ring_attach(lpc_ring_id id, void *addr){
+
+	return lpc_ring_attach(id, addr);
+}
+
+/** リングの消費者を起床する
+    @param[in] id    チャネルID
+    @param[in] ring  起床対象のリング
+    @retval     0       正常に起床した
+    @retval    -ENOENT  チャネルが存在しない
+ */
+int
+svc_lpc_ring_notify(lpc_ring_id id, int ring){
+
+	return lpc_ring_notify(id, ring);
+}
+
+/** リングが空でなくなるまで待ち合わせる
+    @param[in] id    チャネルID
+    @param[in] ring  待ち合わせ対象のリング
+    @param[in] tmout タイムアウト時間(単位:ms)
+    @retval     0          リングにエントリがある
+    @retval    -ETIMEDOUT  タイムアウトした
+    @retval    -EINTR      イベントを受信した
+ */
+int
+svc_lpc_ring_wait(lpc_ring_id id, int ring, lpc_tmout tmout){
+
+	return lpc_ring_wait(id, ring, tmout);
+}
+
+/** リングチャネルを破棄する
+    @param[in] id チャネルID
+    @retval     0       正常に破棄した
+    @retval    -ENOENT  チャネルが存在しない
+    @retval    -EPERM   チャネル生成者以外から呼び出した
+ */
+int
+svc_lpc_ring_destroy(lpc_ring_id id){
+
+	return lpc_ring_destroy(id);
+}
+
+/** futex変数の値が期待値である間休眠する
+    @param[in] uaddr futex変数のアドレス
+    @param[in] val   期待値
+    @param[in] tmout タイムアウト時間(単位:ms, FUTEX_INFINITEの場合は無期限)
+    @retval    0          起床された
+    @retval   -EINVAL     アドレスの境界が不正
+    @retval   -EFAULT     futex変数にアクセスできない
+    @retval   -EAGAIN     futex変数の値が期待値と異なる
+    @retval   -ETIMEDOUT  タイムアウトした
+    @retval   -EINTR      イベントを受信した
+ */
+int
+svc_futex_wait(void *uaddr, futex_val val, futex_tmout tmout) {
+
+	return futex_wait(&current->p->vm, uaddr, val, tmout);
+}
+
+/** futex変数で待ち合わせているスレッドを起床する
+    @param[in] uaddr futex変数のアドレス
+    @param[in] nr    起床するスレッド数の上限(FUTEX_WAKE_ALLの場合は全スレッド)
+    @return    起床したスレッド数
+ */
+int
+svc_futex_wake(void *uaddr, int nr) {
+
+	return futex_wake(&current->p->vm, uaddr, nr);
+}
+
+/** カーネル統計情報を操作する
+    @param[in] cmd 操作コマンド(KSTAT_CTRL_DISABLE, KSTAT_CTRL_ENABLE, 
+    KSTAT_CTRL_RESET, KSTAT_CTRL_SHOW)
+    @retval    0       正常終了
+    @retval   -EINVAL  不正なコマンド
+    @retval   -EPERM   特権のないプロセスから採取状態の変更/統計情報のクリアを要求した
+    @note 統計情報はシステム全体で共有するため, 採取の開始/停止, クリアは
+    カーネルまたはPROC_CAP_KSTAT特権を持つプロセスにのみ許可する.
+    特権のないプロセスには参照(KSTAT_CTRL_SHOW)のみを許可する.
+ */
+int
+svc_kstat_ctrl(int cmd) {
+
+	if ( ( current->p != hal_refer_kernel_proc() ) 
+	    && ( !( current->p->caps & PROC_CAP_KSTAT ) )
+	    && ( cmd != KSTAT_CTRL_SHOW ) )
+		return -EPERM;  /*  特権のないプロセスからは参照のみ可能  */
+
+	return kstat_control(cmd);
+}
+
+/** カーネル統計情報を取得する
+    @param[in]  kind 統計の種別(KSTAT_KIND_SYSCALL, KSTAT_KIND_TRAP, KSTAT_KIND_PGFLT)
+    @param[in]  no   システムコール番号またはトラップ番号(KSTAT_KIND_PGFLTの場合は未使用)
+    @param[out] ubuf 統計返却先ユーザ空間アドレス
+    (KSTAT_KIND_PGFLTの場合はkstat_pgflt, それ以外はkstat_latency)
+    @retval     0       正常に取得した
+    @retval    -EINVAL  種別または番号が不正
+    @retval    -EFAULT  返却先にアクセスできない
+ */
+int
+svc_kstat_get(int kind, uint64_t no, void *ubuf) {
+	int              rc;
+	kstat_latency   lat;
+	kstat_pgflt      pf;
+
+	if ( kind == KSTAT_KIND_PGFLT ) {
+
+		kstat_get_pgflt(&pf);
+		rc = vm_copy_out(&current->p->vm, ubuf, &pf, sizeof(kstat_pgflt));
+		goto out;
+	}
+
+	rc = kstat_get_latency(kind, no, &lat);
+	if ( rc != 0 )
+		goto out;
+
+	rc = vm_copy_out(&current->p->vm, ubuf, &lat, sizeof(kstat_latency));
+
+out:
+	return ( rc < 0 ) ? ( rc ) : ( 0 );
+}
+
+/** ネームサービスの世代番号を取得する
+    @param[out] ugenp 世代番号返却先ユーザ空間アドレス
+    @retval     0       正常に取得した
+    @retval    -EFAULT  返却先にアクセスできない
+    @note ユーザライブラリの名前解決キャッシュの有効性確認に使用する
+ */
+int
+svc_kns_generation(uint64_t *ugenp) {
+	int        rc;
+	kserv_gen gen;
+
+	gen = kns_current_generation();
+
+	rc = vm_copy_out(&current->p->vm, ugenp, &gen, sizeof(kserv_gen));
+
+	return ( rc < 0 ) ? ( rc ) : ( 0 );
+}
+
+/** 自スレッドに共有イベントマスクページを割り当てる
+    @param[out] uaddrp 共有マスクページのアドレス返却先ユーザ空間アドレス
+    @retval     0       正常に割り当てた
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -ENOMEM  メモリ不足
+    @retval    -EFAULT  返却先にアクセスできない
+ */
+int
+svc_ev_mask_attach(void **uaddrp) {
+	int      rc;
+	void  *addr;
+
+	rc = ev_mask_page_attach(&addr);
+	if ( rc != 0 )
+		return rc;
+
+	rc = vm_copy_out(&current->p->vm, uaddrp, &addr, sizeof(void *));
+
+	return ( rc < 0 ) ? ( rc ) : ( 0 );
+}
+
+/** 共有イベントマスクページのマスク解除を反映する
+    @retval     0       正常に反映した
+    @retval    -ENOENT  共有マスクページが割り当てられていない
+    @note 配送可能になったイベントはシステムコール復帰時に配送される
+ */
+int
+svc_ev_mask_sync(void) {
+
+	return ev_mask_page_sync();
+}
+
+/** 自スレッドのイベント一括配送先配列を登録する
+    @param[in] uarray 一括配送先配列のユーザ仮想アドレス(NULLの場合は登録解除)
+    @param[in] nr     配列の要素数(0の場合は登録解除)
+    @retval    0      正常に登録した
+    @retval   -EPERM  カーネルスレッドから呼び出した
+    @retval   -EINVAL 要素数が上限を超えている
+    @retval   -EFAULT 配列に書き込めない
+ */
+int
+svc_ev_register_batch(evinfo *uarray, obj_cnt_type nr) {
+
+	return ev_register_batch(uarray, nr);
+}
@@ -19,6 +19,7 @@
 #include <kern/messages.h>
 #include <kern/tst-progs.h>
 #include <kern/kname-service.h>
+#include <kern/workqueue.h>
 
 #include <thr/thr-internal.h>
 
@@ -30,6 +31,7 @@ system_threads_init(void) {
 
 	ti_disable_dispatch();
 
+	workqueue_init();            /*  カーネルワークキュー         */
 	_thr_init_reaper();          /*  スレッド回収処理             */
 	kernel_name_service_init();  /* カーネル内ネームサービス      */
 	dbg_console_service_init();  /* デバッグ用コンソールサービス  */
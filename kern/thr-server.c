@@ -26,7 +26,7 @@
 #include <kern/lpc.h>
 #include <kern/kname-service.h>
 
-static thread *thr_service_thr;
+static thread *thr_service_thr[KSERV_NR_RECEIVERS];
 
 //#define DEBUG_THR_SERVICE
 
@@ -56,7 +56,7 @@ handle_get_evmask(thr_sys_mask_op *mask, endpoint src) {
 		goto error_out;
 	}
 
-	memcpy( &mask->mask, &thr->evque.masks, sizeof(event_mask) );
+	memcpy( &mask->mask, ev_refer_mask( &thr->evque ), sizeof(event_mask) );
 	release_all_thread_lock(&flags);
 
 	return 0;
@@ -101,28 +101,72 @@ error_out:
 }
 
 
+/** 短メッセージによる要求を処理する
+    @param[in,out] sm  短メッセージ
+    @param[in]     src 呼出元エンドポイント
+    @note 要求時: w[0] 要求コード, w[1]以降 イベントマスク
+    応答時: w[0] 処理結果, w[1]以降 イベントマスク
+ */
+static void
+handle_short_request(lpc_short_msg *sm, endpoint src) {
+	thr_sys_mask_op mskop;
+	int                rc;
+
+	memcpy( &mskop.mask, &sm->w[1], sizeof(event_mask) );
+
+	switch( sm->w[LPC_SHORT_REQ_WORD] ) {
+	case THR_SERV_REQ_GET_EVMSK:
+
+		rc = handle_get_evmask(&mskop, src);
+		memcpy( &sm->w[1], &mskop.mask, sizeof(event_mask) );
+		break;
+	case THR_SERV_REQ_SET_EVMSK:
+
+		rc = handle_set_evmask(&mskop, src);
+		break;
+	default:
+		rc = -ENOSYS;
+		break;
+	}
+
+	sm->w[LPC_SHORT_REQ_WORD] = (uint64_t)(int64_t)rc;
+}
+
 /** スレッドサービス処理部
-    @param[in] arg スレッド引数(未使用)
+    @param[in] arg 受信スレッドの番号
  */
 static int
-handle_thr_service(void __attribute__ ((unused)) *arg) {
+handle_thr_service(void *arg) {
 	msg_body           msg;
 	thr_service      *smsg;
 	thr_sys_mask_op *mskop;
 	endpoint           src;
+	lpc_msg_type      type;
 	int                 rc;
 
-	rc = kns_register_kernel_service(ID_RESV_NAME_THR);
-	kassert( rc == 0 );
+	if ( (uintptr_t)arg == 0 ) {  /*  先頭の受信スレッドがサービスを登録  */
+
+		rc = kns_register_kernel_service(ID_RESV_NAME_THR, ID_RESV_THR);
+		kassert( rc == 0 );
+	}
 	
 	while(1) {
 
 		memset( &msg, 0, sizeof(msg_body) );
 		smsg  = &msg.thr_msg;
 
-		rc = lpc_recv(LPC_RECV_ANY, LPC_INFINITE, &msg, &src);
+		rc = lpc_port_recv_msg(ID_RESV_THR, LPC_RECV_ANY, LPC_INFINITE, &msg, 
+		    &src, &type);
 		kassert( rc == 0 );
 
+		if ( type == LPC_MSG_TYPE_SHORT ) {  /*  短メッセージによる要求  */
+
+			handle_short_request(&msg.short_msg, src);
+			rc = lpc_send_short(src, LPC_INFINITE, &msg.short_msg);
+			kassert( rc == 0 );
+			continue;
+		}
+
 #if defined(DEBUG_THR_SERVICE)
 		kprintf(KERN_INF, MSG_PREFIX "tid=%d thread=%p (src, req)=(%d, %d)\n", 
 		    current->tid, current, src, smsg->req);
@@ -161,15 +205,23 @@ handle_thr_service(void __attribute__ ((unused)) *arg) {
 void
 thr_service_init(void) {
 	int              rc;
+	int               i;
+	endpoint       port;
 
-	rc = thr_new_thread(&thr_service_thr);
+	rc = lpc_port_create(ID_RESV_THR, &port);
 	kassert( rc == 0 );
 
-	rc = thr_create_kthread(thr_service_thr, KSERV_KSERVICE_PRIO, THR_FLAG_NONE,
-	    ID_RESV_THR, handle_thr_service, (void *)ID_RESV_NAME_THR);
-	kassert( rc == 0 );
+	for( i = 0; KSERV_NR_RECEIVERS > i; ++i) {
 
-	rc = thr_start(thr_service_thr, current->tid);
-	kassert( rc == 0 );
+		rc = thr_new_thread(&thr_service_thr[i]);
+		kassert( rc == 0 );
+
+		rc = thr_create_kthread(thr_service_thr[i], KSERV_KSERVICE_PRIO, 
+		    THR_FLAG_NONE, THR_INVALID_TID, handle_thr_service, 
+		    (void *)(uintptr_t)i);
+		kassert( rc == 0 );
 
+		rc = thr_start(thr_service_thr[i], current->tid);
+		kassert( rc == 0 );
+	}
 }
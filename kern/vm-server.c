@@ -28,7 +28,7 @@
 #include <kern/proc-service.h>
 #include <kern/page.h>
 
-static thread *vm_service_thr;
+static thread *vm_service_thr[KSERV_NR_RECEIVERS];
 
 //#define DEBUG_VM_SERVICE
 
@@ -45,7 +45,6 @@ handle_sbrk(vm_sys_sbrk *sbrk,endpoint src) {
 	int            rc;
 	thread       *thr;
 	void     *cur_end;
-	void     *new_end;
 	intrflags   flags;
 
 	acquire_all_thread_lock( &flags );
@@ -57,36 +56,13 @@ handle_sbrk(vm_sys_sbrk *sbrk,endpoint src) {
 		goto unlock_out;
 	}
 
-	rc = proc_expand_heap(thr->p, NULL, &cur_end);
-
-	if ( rc != 0 ) 
-		goto unlock_out;
-
-	if ( sbrk->inc == 0 ) {
-		
-		rc = 0;
-		goto success_out;
-	}
-
-	new_end = ( PAGE_ALIGNED( (uintptr_t)(cur_end + sbrk->inc) ) ) ? 
-		( (void *)( cur_end + sbrk->inc ) )  :
-		( (void *)PAGE_NEXT( (uintptr_t)(cur_end + sbrk->inc) ) );
-
-	if ( new_end < thr->p->heap->start ) {
-	
-		rc = -EINVAL;
-		goto unlock_out;
-	}
-
-	rc = proc_expand_heap(thr->p, new_end, &cur_end);
+	rc = proc_sbrk(thr->p, sbrk->inc, &cur_end);
 	if ( rc != 0 ) 
 		goto unlock_out;
 
-success_out:
 	release_all_thread_lock(&flags);
 
-	if ( rc == 0 ) 
-		sbrk->old_heap_end = cur_end;
+	sbrk->old_heap_end = cur_end;
 
 	return 0;
 
@@ -95,28 +71,68 @@ unlock_out:
 	return rc;
 }
 
+/** 短メッセージによる要求を処理する
+    @param[in,out] sm  短メッセージ
+    @param[in]     src 呼出元エンドポイント
+    @note 要求時: w[0] 要求コード, w[1]以降 要求毎の引数
+    応答時: w[0] 処理結果, w[1]以降 要求毎の返却値
+ */
+static void
+handle_short_request(lpc_short_msg *sm, endpoint src) {
+	vm_sys_sbrk sbrk;
+	int           rc;
+
+	switch( sm->w[LPC_SHORT_REQ_WORD] ) {
+	case VM_SERV_REQ_SBRK:
+
+		memset( &sbrk, 0, sizeof(vm_sys_sbrk) );
+		sbrk.inc = (intptr_t)sm->w[1];
+		rc = handle_sbrk(&sbrk, src);
+		sm->w[1] = (uint64_t)sbrk.old_heap_end;
+		break;
+	default:
+		rc = -ENOSYS;
+		break;
+	}
+
+	sm->w[LPC_SHORT_REQ_WORD] = (uint64_t)(int64_t)rc;
+}
+
 /** プロセスサービス処理部
-    @param[in] arg スレッド引数(未使用)
+    @param[in] arg 受信スレッドの番号
  */
 static int
-handle_vm_service(void __attribute__ ((unused)) *arg) {
+handle_vm_service(void *arg) {
 	msg_body              msg;
 	vm_service          *smsg;
 	vm_sys_sbrk         *sbrk;
 	endpoint              src;
+	lpc_msg_type         type;
 	int                    rc;
 
-	rc = kns_register_kernel_service(ID_RESV_NAME_VM);
-	kassert( rc == 0 );
+	if ( (uintptr_t)arg == 0 ) {  /*  先頭の受信スレッドがサービスを登録  */
+
+		rc = kns_register_kernel_service(ID_RESV_NAME_VM, ID_RESV_VM);
+		kassert( rc == 0 );
+	}
 	
 	while(1) {
 
 		memset( &msg, 0, sizeof(msg_body) );
 		smsg  = &msg.vm_msg;
 
-		rc = lpc_recv(LPC_RECV_ANY, LPC_INFINITE, &msg, &src);
+		rc = lpc_port_recv_msg(ID_RESV_VM, LPC_RECV_ANY, LPC_INFINITE, &msg, 
+		    &src, &type);
 		kassert( rc == 0 );
 
+		if ( type == LPC_MSG_TYPE_SHORT ) {  /*  短メッセージによる要求  */
+
+			handle_short_request(&msg.short_msg, src);
+			rc = lpc_send_short(src, LPC_INFINITE, &msg.short_msg);
+			kassert( rc == 0 );
+			continue;
+		}
+
 #if defined(DEBUG_VM_SERVICE)
 		kprintf(KERN_INF, MSG_PREFIX "tid=%d thread=%p (src, req)=(%d, %d)\n", 
 		    current->tid, current, src, smsg->req);
@@ -147,15 +163,23 @@ handle_vm_service(void __attribute__ ((unused)) *arg) {
 void
 vm_service_init(void) {
 	int              rc;
+	int               i;
+	endpoint       port;
 
-	rc = thr_new_thread(&vm_service_thr);
+	rc = lpc_port_create(ID_RESV_VM, &port);
 	kassert( rc == 0 );
 
-	rc = thr_create_kthread(vm_service_thr, KSERV_KSERVICE_PRIO, THR_FLAG_NONE,
-	    ID_RESV_VM, handle_vm_service, (void *)ID_RESV_NAME_VM);
-	kassert( rc == 0 );
+	for( i = 0; KSERV_NR_RECEIVERS > i; ++i) {
 
-	rc = thr_start(vm_service_thr, current->tid);
-	kassert( rc == 0 );
+		rc = thr_new_thread(&vm_service_thr[i]);
+		kassert( rc == 0 );
 
+		rc = thr_create_kthread(vm_service_thr[i], KSERV_KSERVICE_PRIO, 
+		    THR_FLAG_NONE, THR_INVALID_TID, handle_vm_service, 
+		    (void *)(uintptr_t)i);
+		kassert( rc == 0 );
+
+		rc = thr_start(vm_service_thr[i], current->tid);
+		kassert( rc == 0 );
+	}
 }
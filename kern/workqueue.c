@@ -0,0 +1,337 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Kernel work queue routines                                        */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/list.h>
+#include <kern/thread.h>
+#include <kern/timer.h>
+#include <kern/workqueue.h>
+
+static workqueue kern_wq;  /*<  カーネルワークキュー  */
+
+/** 処理要求をワークキューに登録する
+    @param[in] wq   ワークキュー
+    @param[in] wk   処理要求
+    @note ワークキューのロックは呼出元で獲得する
+ */
+static void
+enqueue_work_nolock(workqueue *wq, work *wk) {
+
+	kassert( spinlock_locked_by_self( &wq->lock ) );
+	kassert( list_not_linked( &wk->link ) );
+
+	wk->state = WORK_STATE_QUEUED;
+	queue_add( &wq->que[wk->prio], &wk->link );
+	++wq->nr_pending;
+}
+
+/** 最も優先度の高い処理要求を取り出す
+    @param[in] wq   ワークキュー
+    @return    処理要求(処理要求がない場合はNULL)
+    @note ワークキューのロックは呼出元で獲得する
+ */
+static work *
+dequeue_work_nolock(workqueue *wq) {
+	int     i;
+	work  *wk;
+
+	kassert( spinlock_locked_by_self( &wq->lock ) );
+
+	for( i = 0; WQ_PRIO_NR > i; ++i) {
+
+		if ( !queue_is_empty( &wq->que[i] ) ) {
+
+			wk = CONTAINER_OF(queue_get_top( &wq->que[i] ), work, link);
+			wk->state = WORK_STATE_IDLE;  /*  処理中に再登録可能にする  */
+			return wk;
+		}
+	}
+
+	return NULL;
+}
+
+/** 遅延処理要求のタイマ満了処理
+    @param[in] data 処理要求
+ */
+static void
+delayed_work_timeout(private_inf data) {
+	intrflags  flags;
+	workqueue    *wq;
+	work         *wk;
+
+	wk = (work *)data;
+	wq = &kern_wq;
+
+	spinlock_lock_disable_intr( &wq->lock, &flags );
+	if ( wk->state == WORK_STATE_DELAYED )
+		enqueue_work_nolock(wq, wk);
+	spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+	sync_wake( &wq->wait, SYNC_WAI_RELEASED );  /*  ワーカスレッドを起床  */
+}
+
+/** ワーカスレッド
+    @param[in] arg 未使用
+ */
+static int
+worker_thread(void __attribute__ ((unused)) *arg) {
+	intrflags    flags;
+	workqueue      *wq;
+	work           *wk;
+	sync_reason    res;
+
+	wq = &kern_wq;
+
+	while(1) {
+
+		spinlock_lock_disable_intr( &wq->lock, &flags );
+		while( ( wk = dequeue_work_nolock(wq) ) == NULL ) {
+
+			res = sync_wait( &wq->wait, &wq->lock );
+			kassert( res == SYNC_WAI_RELEASED );
+		}
+		wk->running = true;
+		spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+		wk->func( wk->data );  /*  処理関数を実行  */
+
+		spinlock_lock_disable_intr( &wq->lock, &flags );
+		wk->running = false;
+		kassert( wq->nr_pending > 0 );
+		--wq->nr_pending;
+		spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+		sync_wake( &wq->flush_wait, SYNC_WAI_RELEASED );  /*  完了を通知  */
+	}
+
+	return 0;
+}
+
+/** 処理要求を初期化する
+    @param[in] wk   処理要求
+    @param[in] func 処理関数
+    @param[in] data 処理関数の引数
+    @param[in] prio 処理要求の優先度(WQ_PRIO_HIGH, WQ_PRIO_NORMAL, WQ_PRIO_LOW)
+ */
+void
+work_init(work *wk, void (*func)(private_inf _data), private_inf data, int prio) {
+
+	kassert( wk != NULL );
+	kassert( func != NULL );
+	kassert( ( prio >= 0 ) && ( WQ_PRIO_NR > prio ) );
+
+	list_init( &wk->link );
+	wk->state = WORK_STATE_IDLE;
+	wk->prio = prio;
+	wk->running = false;
+	wk->func = func;
+	wk->data = data;
+}
+
+/** 処理要求をワークキューに登録する
+    @param[in] wk 処理要求
+    @retval    真 新たに登録した
+    @retval    偽 既に登録済みまたは遅延登録待ちだった
+    @note 割込みハンドラから呼び出し可能. 処理関数の実行中に再登録した
+    場合は, 他のワーカスレッドで並行して実行されることがある.
+ */
+bool
+queue_work(work *wk) {
+	bool          rc;
+	intrflags  flags;
+	workqueue    *wq;
+
+	kassert( wk != NULL );
+
+	wq = &kern_wq;
+
+	spinlock_lock_disable_intr( &wq->lock, &flags );
+	rc = ( wk->state == WORK_STATE_IDLE );
+	if ( rc )
+		enqueue_work_nolock(wq, wk);
+	spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+	if ( rc )
+		sync_wake( &wq->wait, SYNC_WAI_RELEASED );  /*  ワーカスレッドを起床  */
+
+	return rc;
+}
+
+/** 指定時間経過後に処理要求をワークキューに登録する
+    @param[in] wk    処理要求
+    @param[in] outms 登録までの時間(単位:ms)
+    @retval    真    新たに遅延登録した
+    @retval    偽    既に登録済みまたは遅延登録待ちだった
+    @note 同一の処理要求に対するcancel_workと並行して呼び出してはならない
+ */
+bool
+queue_delayed_work(work *wk, tim_tmout outms) {
+	bool          rc;
+	intrflags  flags;
+	workqueue    *wq;
+
+	kassert( wk != NULL );
+
+	wq = &kern_wq;
+
+	spinlock_lock_disable_intr( &wq->lock, &flags );
+	rc = ( wk->state == WORK_STATE_IDLE );
+	if ( rc )
+		wk->state = WORK_STATE_DELAYED;
+	spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+	if ( rc )
+		tim_callout_add( &wk->callout, outms, delayed_work_timeout, wk );
+
+	return rc;
+}
+
+/** 未実行の処理要求を取り消す
+    @param[in] wk 処理要求
+    @retval    真 登録済みまたは遅延登録待ちの処理要求を取り消した
+    @retval    偽 処理要求は登録されていない
+    @note 実行中の処理関数の完了は待ち合わせない. 完了を待ち合わせる場合は
+    取り消し後にflush_workを呼び出す.
+ */
+bool
+cancel_work(work *wk) {
+	bool          rc;
+	int        state;
+	intrflags  flags;
+	workqueue    *wq;
+
+	kassert( wk != NULL );
+
+	wq = &kern_wq;
+
+	do{
+
+		spinlock_lock_disable_intr( &wq->lock, &flags );
+
+		rc = false;
+		state = wk->state;
+		if ( state == WORK_STATE_QUEUED ) {
+
+			list_del( &wk->link );
+			wk->state = WORK_STATE_IDLE;
+			kassert( wq->nr_pending > 0 );
+			--wq->nr_pending;
+			rc = true;
+		}
+
+		spinlock_unlock_restore_intr( &wq->lock, &flags );
+
+		if ( state != WORK_STATE_DELAYED )
+			break;
+
+		/*
+		 * タイマ満了前であればコールアウトを取り消す.
+		 * 満了済みの場合はワークキューに登録されているので再試行する.
+		 */
+		if ( tim_callout_cancel( &wk->callout ) ) {
+
+			spinlock_lock_disable_intr( &wq->lock, &flags );
+			kassert( wk->state == WORK_STATE_DELAYED );
+			wk->state = WORK_STATE_IDLE;
+			spinlock_unlock_restore_intr( &wq->lock, &flags );
+			rc = true;
+			break;
+		}
+	}while( 1 );
+
+	if ( rc )
+		sync_wake( &wq->flush_wait, SYNC_WAI_RELEASED );
+
+	return rc;
+}
+
+/** 処理要求の完了を待ち合わせる
+    @param[in] wk 処理要求
+    @note 登録済みまたは実行中の処理要求の完了を待ち合わせる.
+    遅延登録待ちの処理要求は待ち合わせない. ワーカスレッドから呼び出してはならない.
+ */
+void
+flush_work(work *wk) {
+	intrflags  flags;
+	workqueue    *wq;
+
+	kassert( wk != NULL );
+	kassert( !ti_in_intr() );
+
+	wq = &kern_wq;
+
+	spinlock_lock_disable_intr( &wq->lock, &flags );
+	while( ( wk->state == WORK_STATE_QUEUED ) || ( wk->running ) )
+		sync_wait( &wq->flush_wait, &wq->lock );
+	spinlock_unlock_restore_intr( &wq->lock, &flags );
+}
+
+/** ワークキュー中の全処理要求の完了を待ち合わせる
+    @note 呼び出し時点で登録済みまたは実行中の処理要求に加えて, 
+    待ち合わせ中に登録された処理要求の完了も待ち合わせる.
+    ワーカスレッドから呼び出してはならない.
+ */
+void
+flush_workqueue(void) {
+	intrflags  flags;
+	workqueue    *wq;
+
+	kassert( !ti_in_intr() );
+
+	wq = &kern_wq;
+
+	spinlock_lock_disable_intr( &wq->lock, &flags );
+	while( wq->nr_pending > 0 )
+		sync_wait( &wq->flush_wait, &wq->lock );
+	spinlock_unlock_restore_intr( &wq->lock, &flags );
+}
+
+/** ワークキューを初期化し, ワーカスレッドを起動する
+ */
+void
+workqueue_init(void) {
+	int            rc;
+	int             i;
+	workqueue     *wq;
+
+	wq = &kern_wq;
+
+	spinlock_init( &wq->lock );
+	for( i = 0; WQ_PRIO_NR > i; ++i)
+		queue_init( &wq->que[i] );
+	wq->nr_pending = 0;
+	sync_init_object( &wq->wait, SYNC_WAKE_FLAG_ONE, THR_TSTATE_WAIT );
+	sync_init_object( &wq->flush_wait, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT );
+
+	for( i = 0; WQ_NR_WORKERS > i; ++i) {
+
+		rc = thr_new_thread( &wq->workers[i] );
+		kassert( rc == 0 );
+
+		rc = thr_create_kthread( wq->workers[i], WQ_WORKER_PRIO, THR_FLAG_NONE,
+		    THR_INVALID_TID, worker_thread, (void *)(uintptr_t)i );
+		kassert( rc == 0 );
+
+		rc = thr_start( wq->workers[i], current->tid );
+		kassert( rc == 0 );
+	}
+}
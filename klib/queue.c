@@ -40,6 +40,34 @@ queue_add_top(struct _queue *head, list *node) {
 	head->next = node;
 }
 
+/** キュー内の指定したノードの直後にリストノードを挿入する
+    @param[in] pos  挿入位置のノード(キュー自身を指定した場合は先頭に挿入)
+    @param[in] node リストノード
+    @note 整列済みキューへの挿入に使用する
+ */
+void
+queue_insert_after(list *pos, list *node) {
+
+	node->prev = pos;
+	node->next = pos->next;
+	pos->next->prev = node;
+	pos->next = node;
+}
+
+/** キュー内の指定したノードの直前にリストノードを挿入する
+    @param[in] pos  挿入位置のノード(キュー自身を指定した場合は末尾に挿入)
+    @param[in] node リストノード
+    @note 環状リストの末尾(先頭ノードの直前)への追加にも使用する
+ */
+void
+queue_insert_before(list *pos, list *node) {
+
+	node->next = pos;
+	node->prev = pos->prev;
+	pos->prev->next = node;
+	pos->prev = node;
+}
+
 /** キューの先頭ノードを参照する
     @param[in] head 調査対象キュー
     @retval 先頭リストノードのアドレス
@@ -0,0 +1,64 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  system call batching routines                                     */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <ulib/yatos-ulib.h>
+#include <ulib/batch-svc.h>
+
+/** システムコール一括処理要求を設定する
+    @param[in] ent  設定対象の要求
+    @param[in] no   システムコール番号
+    @param[in] arg1 第1引数
+    @param[in] arg2 第2引数
+    @param[in] arg3 第3引数
+    @param[in] arg4 第4引数
+    @param[in] arg5 第5引数
+ */
+void
+yatos_batch_set(svc_batch_entry *ent, uint64_t no, syscall_arg_type arg1, 
+    syscall_arg_type arg2, syscall_arg_type arg3, syscall_arg_type arg4, 
+    syscall_arg_type arg5) {
+
+	ent->no = no;
+	ent->args[0] = arg1;
+	ent->args[1] = arg2;
+	ent->args[2] = arg3;
+	ent->args[3] = arg4;
+	ent->args[4] = arg5;
+	ent->res = -ENOSYS;
+}
+
+/** 複数のシステムコールを一括して発行する
+    @param[in] ents  システムコール要求配列
+    @param[in] nr    要求数(SVC_BATCH_MAX_ENTRIES以下)
+    @param[in] flags 処理フラグ(SVC_BATCH_FLAG_STOP_ON_ERROR)
+    @return    処理した要求数(各要求の返り値はents[i].resに格納される)
+    @retval   -1     一括処理に失敗した
+    @retval   errno == EINVAL 要求数が不正
+    @retval   errno == EFAULT 要求配列にアクセスできない
+ */
+int
+yatos_syscall_batch(svc_batch_entry *ents, size_t nr, uint64_t flags) {
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_BATCH, 
+	    (syscall_arg_type)ents, 
+	    (syscall_arg_type)nr, 
+	    (syscall_arg_type)flags);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return (int)res;
+}
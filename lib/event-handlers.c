@@ -98,6 +98,26 @@ __yatos_ulib_invoke_handler(event_no id, evinfo *info, event_frame *evf) {
 	handler(id, info, (void *)evf);
 }
 
+/** イベントフレームに格納されたイベントのハンドラを起動する
+    @param[in] id    イベントID
+    @param[in] info  イベント情報
+    @param[in] evf   イベントフレーム
+    @note 一括配送された場合は, 一括配送先配列中のイベントを順に処理する
+ */
+void
+__yatos_ulib_dispatch_events(event_no id, evinfo *info, event_frame *evf) {
+	obj_cnt_type i;
+
+	if ( evf->nr_infos == 0 ) {  /*  逐次配送  */
+
+		__yatos_ulib_invoke_handler(id, info, evf);
+		return;
+	}
+
+	for(i = 0; evf->nr_infos > i; ++i)
+		__yatos_ulib_invoke_handler(evf->infos[i].no, &evf->infos[i], evf);
+}
+
 /** ユーザハンドラを登録する
     @param[in] id      イベントID
     @param[in] handler ハンドラのアドレス
@@ -21,7 +21,7 @@
 static void
 common_event_handler(event_no  no, evinfo  *info, event_frame *evf) {
 
-	__yatos_ulib_invoke_handler(no, info, evf);
+	__yatos_ulib_dispatch_events(no, info, evf);
 	yatos_event_return(evf);
 }
 
@@ -45,3 +45,25 @@ yatos_event_return(event_frame *evf) {
 	syscall1( res, SYS_YATOS_EV_RETURN, evf);
 	/*  Never return here */
 }
+
+/** 自スレッドのイベント一括配送先配列を登録する
+    @param[in] array 一括配送先配列(NULLの場合は登録解除)
+    @param[in] nr    配列の要素数(EV_BATCH_MAX以下, 0の場合は登録解除)
+    @retval    0     正常に登録した
+    @retval   -1     登録に失敗した
+    @note 登録後は, 複数の保留中イベントを1回のハンドラ呼出しで受け取り,
+    ライブラリが配列中のイベントごとにハンドラを呼び出す.
+    配列はスレッドごとに用意する.
+ */
+int
+yatos_event_register_batch(evinfo *array, size_t nr) {
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_EV_REG_BATCH, (syscall_arg_type)array,
+	    (syscall_arg_type)nr);
+	set_errno(res);
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
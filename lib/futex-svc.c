@@ -0,0 +1,184 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  futex system call and user mutex routines                         */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <ulib/yatos-ulib.h>
+#include <ulib/futex-svc.h>
+
+#include <hal/atomic.h>
+
+/** futex変数の値が期待値である間休眠する
+    @param[in] uaddr futex変数のアドレス
+    @param[in] val   期待値
+    @param[in] tmout タイムアウト時間(単位:ms, FUTEX_INFINITEの場合は無期限)
+    @retval    0     起床された
+    @retval   -1     待ち合わせに失敗した
+    @retval   errno == EAGAIN    futex変数の値が期待値と異なる
+    @retval   errno == ETIMEDOUT タイムアウトした
+    @retval   errno == EINTR     イベントを受信した
+ */
+int
+yatos_futex_wait(volatile futex_val *uaddr, futex_val val, futex_tmout tmout) {
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_FUTEX_WAIT, 
+	    (syscall_arg_type)uaddr, 
+	    (syscall_arg_type)val, 
+	    (syscall_arg_type)tmout);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** futex変数で待ち合わせているスレッドを起床する
+    @param[in] uaddr futex変数のアドレス
+    @param[in] nr    起床するスレッド数の上限(FUTEX_WAKE_ALLの場合は全スレッド)
+    @return    起床したスレッド数
+    @retval   -1     起床に失敗した
+ */
+int
+yatos_futex_wake(volatile futex_val *uaddr, int nr) {
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_FUTEX_WAKE, 
+	    (syscall_arg_type)uaddr, 
+	    (syscall_arg_type)nr);
+
+	if ( res < 0 ) {
+
+		set_errno(res);
+		return -1;
+	}
+
+	return (int)res;
+}
+
+/** ユーザmutexを初期化する
+    @param[in] mtx 初期化対象のmutex
+ */
+void
+yatos_mutex_init(yatos_mutex *mtx) {
+
+	mtx->state = YATOS_MUTEX_UNLOCKED;
+}
+
+/** ユーザmutexを獲得する
+    @param[in] mtx 操作対象のmutex
+    @note 競合がない場合はカーネルに入らずに獲得する.
+    競合時は待ちスレッドありの状態に変更してからfutex待ちに入る.
+ */
+void
+yatos_mutex_lock(yatos_mutex *mtx) {
+	futex_val c;
+
+	c = hal_atomic_cmpxchg32(&mtx->state, YATOS_MUTEX_UNLOCKED, 
+	    YATOS_MUTEX_LOCKED);
+	if ( c == YATOS_MUTEX_UNLOCKED )
+		return;  /*  競合なし  */
+
+	if ( c != YATOS_MUTEX_CONTENDED )
+		c = hal_atomic_xchg32(&mtx->state, YATOS_MUTEX_CONTENDED);
+
+	while( c != YATOS_MUTEX_UNLOCKED ) {
+
+		yatos_futex_wait(&mtx->state, YATOS_MUTEX_CONTENDED, FUTEX_INFINITE);
+		c = hal_atomic_xchg32(&mtx->state, YATOS_MUTEX_CONTENDED);
+	}
+}
+
+/** ユーザmutexの獲得を試みる
+    @param[in] mtx 操作対象のmutex
+    @retval    true  獲得した
+    @retval    false 他のスレッドが獲得中
+ */
+bool
+yatos_mutex_trylock(yatos_mutex *mtx) {
+
+	return ( hal_atomic_cmpxchg32(&mtx->state, YATOS_MUTEX_UNLOCKED, 
+		YATOS_MUTEX_LOCKED) == YATOS_MUTEX_UNLOCKED );
+}
+
+/** ユーザmutexを解放する
+    @param[in] mtx 操作対象のmutex
+    @note 待ちスレッドがある場合のみカーネルに入って起床する
+ */
+void
+yatos_mutex_unlock(yatos_mutex *mtx) {
+
+	if ( hal_atomic_xchg32(&mtx->state, YATOS_MUTEX_UNLOCKED) 
+	    == YATOS_MUTEX_CONTENDED )
+		yatos_futex_wake(&mtx->state, 1);
+}
+
+/** ユーザ条件変数を初期化する
+    @param[in] cv 初期化対象の条件変数
+ */
+void
+yatos_cond_init(yatos_cond *cv) {
+
+	cv->seq = 0;
+}
+
+/** ユーザ条件変数で待ち合わせる
+    @param[in] cv    操作対象の条件変数
+    @param[in] mtx   条件変数に対応するmutex(獲得済みであること)
+    @param[in] tmout タイムアウト時間(単位:ms, FUTEX_INFINITEの場合は無期限)
+    @retval    0     通知を受けた
+    @retval   -1     タイムアウトまたはイベント受信により復帰した
+    @note 復帰時にはmutexを獲得した状態で返る
+ */
+int
+yatos_cond_wait(yatos_cond *cv, yatos_mutex *mtx, futex_tmout tmout) {
+	int        rc;
+	futex_val seq;
+
+	seq = cv->seq;
+	yatos_mutex_unlock(mtx);
+
+	rc = yatos_futex_wait(&cv->seq, seq, tmout);
+	if ( ( rc != 0 ) && ( *__errno() == EAGAIN ) )
+		rc = 0;  /*  待ちに入る前に通知された  */
+
+	/*
+	 * 他の待ちスレッドが残っている可能性があるため
+	 * 待ちスレッドありの状態でmutexを獲得する
+	 */
+	while( hal_atomic_xchg32(&mtx->state, YATOS_MUTEX_CONTENDED) 
+	    != YATOS_MUTEX_UNLOCKED )
+		yatos_futex_wait(&mtx->state, YATOS_MUTEX_CONTENDED, FUTEX_INFINITE);
+
+	return rc;
+}
+
+/** ユーザ条件変数で待ち合わせているスレッドを1つ起床する
+    @param[in] cv    操作対象の条件変数
+ */
+void
+yatos_cond_signal(yatos_cond *cv) {
+
+	hal_atomic_fetch_add32(&cv->seq, 1);
+	yatos_futex_wake(&cv->seq, 1);
+}
+
+/** ユーザ条件変数で待ち合わせている全スレッドを起床する
+    @param[in] cv    操作対象の条件変数
+ */
+void
+yatos_cond_broadcast(yatos_cond *cv) {
+
+	hal_atomic_fetch_add32(&cv->seq, 1);
+	yatos_futex_wake(&cv->seq, FUTEX_WAKE_ALL);
+}
@@ -0,0 +1,94 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  kernel statistics system call routines                            */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <ulib/yatos-ulib.h>
+#include <ulib/kstat-svc.h>
+
+/** カーネル統計情報を取得する(共通処理)
+    @param[in]  kind 統計の種別
+    @param[in]  no   システムコール番号またはトラップ番号
+    @param[out] buf  統計返却先
+    @retval     0    正常に取得した
+    @retval    -1    取得に失敗した
+ */
+static int
+kstat_get_common(int kind, uint64_t no, void *buf) {
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_KSTAT_GET, 
+	    (syscall_arg_type)kind, 
+	    (syscall_arg_type)no, 
+	    (syscall_arg_type)buf);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** カーネル統計情報を操作する
+    @param[in] cmd 操作コマンド(KSTAT_CTRL_DISABLE, KSTAT_CTRL_ENABLE, 
+    KSTAT_CTRL_RESET, KSTAT_CTRL_SHOW)
+    @retval    0   正常終了
+    @retval   -1   不正なコマンドまたは権限がない(KSTAT_CTRL_SHOW以外は特権が必要)
+ */
+int
+yatos_kstat_ctrl(int cmd) {
+	syscall_res_type res;
+
+	syscall1( res, SYS_YATOS_KSTAT_CTRL, (syscall_arg_type)cmd);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** システムコールの処理時間統計を取得する
+    @param[in]  no   システムコール番号
+    @param[out] lat  統計返却先
+    @retval     0    正常に取得した
+    @retval    -1    取得に失敗した
+ */
+int
+yatos_kstat_get_syscall(uint64_t no, kstat_latency *lat) {
+
+	return kstat_get_common(KSTAT_KIND_SYSCALL, no, lat);
+}
+
+/** トラップ/割込みの処理時間統計を取得する
+    @param[in]  trapno トラップ番号
+    @param[out] lat    統計返却先
+    @retval     0      正常に取得した
+    @retval    -1      取得に失敗した
+ */
+int
+yatos_kstat_get_trap(uint64_t trapno, kstat_latency *lat) {
+
+	return kstat_get_common(KSTAT_KIND_TRAP, trapno, lat);
+}
+
+/** ページフォルト処理結果の統計を取得する
+    @param[out] pf   統計返却先
+    @retval     0    正常に取得した
+    @retval    -1    取得に失敗した
+ */
+int
+yatos_kstat_get_pgflt(kstat_pgflt *pf) {
+
+	return kstat_get_common(KSTAT_KIND_PGFLT, 0, pf);
+}
@@ -0,0 +1,229 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  shared memory ring channel routines                               */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <ulib/yatos-ulib.h>
+#include <ulib/lpc-ring.h>
+
+/** リングの位置情報を得る
+    @param[in] ch   リングチャネル
+    @param[in] ring リング(LPC_RING_SQ/LPC_RING_CQ)
+    @return    リングの位置情報
+ */
+static lpc_ring_idx *
+ring_idx(yatos_lpc_ring *ch, int ring) {
+
+	return &( (lpc_ring_ctrl *)ch->base )->idx[ring];
+}
+
+/** 共有メモリリングチャネルを生成し, 自プロセスの仮想空間にマップする
+    @param[out] ch       リングチャネル
+    @param[in]  peer     接続を許可するエンドポイント
+    @param[in]  nr_pages チャネルのページ数(制御域を含む)
+    @param[in]  addr     マップ先のアドレス(ページ境界)
+    @retval     0        正常に生成した
+    @retval    -1        生成に失敗した
+ */
+int
+yatos_lpc_ring_create(yatos_lpc_ring *ch, endpoint peer, obj_cnt_type nr_pages,
+    void *addr) {
+	syscall_res_type res;
+
+	syscall4( res, SYS_YATOS_LPC_RING_CREATE, 
+	    (syscall_arg_type)peer, 
+	    (syscall_arg_type)nr_pages, 
+	    (syscall_arg_type)addr,
+	    (syscall_arg_type)&ch->id);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	ch->base = addr;
+
+	return 0;
+}
+
+/** 生成済みのリングチャネルを自プロセスの仮想空間にマップする
+    @param[out] ch    リングチャネル
+    @param[in]  id    チャネルID
+    @param[in]  addr  マップ先のアドレス(ページ境界)
+    @retval     0     正常にマップした
+    @retval    -1     マップに失敗した
+ */
+int
+yatos_lpc_ring_attach(yatos_lpc_ring *ch, lpc_ring_id id, void *addr) {
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_LPC_RING_ATTACH, 
+	    (syscall_arg_type)id, 
+	    (syscall_arg_type)addr);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	ch->id = id;
+	ch->base = addr;
+
+	return 0;
+}
+
+/** リングの消費者を起床する
+    @param[in] ch    リングチャネル
+    @param[in] ring  起床対象のリング
+    @retval     0    正常に起床した
+    @retval    -1    起床に失敗した
+ */
+int
+yatos_lpc_ring_notify(yatos_lpc_ring *ch, int ring) {
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_LPC_RING_NOTIFY, 
+	    (syscall_arg_type)ch->id, 
+	    (syscall_arg_type)ring);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** リングが空でなくなるまで待ち合わせる
+    @param[in] ch    リングチャネル
+    @param[in] ring  待ち合わせ対象のリング
+    @param[in] tmout タイムアウト時間(単位:ms)
+    @retval     0    リングにエントリがある
+    @retval    -1    待ち合わせに失敗した
+ */
+int
+yatos_lpc_ring_wait(yatos_lpc_ring *ch, int ring, lpc_tmout tmout) {
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_LPC_RING_WAIT, 
+	    (syscall_arg_type)ch->id, 
+	    (syscall_arg_type)ring,
+	    (syscall_arg_type)tmout);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** リングチャネルを破棄する
+    @param[in] ch    リングチャネル
+    @retval     0    正常に破棄した
+    @retval    -1    破棄に失敗した
+ */
+int
+yatos_lpc_ring_destroy(yatos_lpc_ring *ch) {
+	syscall_res_type res;
+
+	syscall1( res, SYS_YATOS_LPC_RING_DESTROY, 
+	    (syscall_arg_type)ch->id);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	ch->base = NULL;
+
+	return 0;
+}
+
+/** リングにエントリを格納する
+    @param[in] ch    リングチャネル
+    @param[in] ring  格納先のリング
+    @param[in] ent   格納するエントリ
+    @retval     0    正常に格納した
+    @retval    -1    リングが満杯(errno == EAGAIN)
+    @note 消費者が待ち合わせ中の場合のみシステムコールを発行する
+ */
+int
+yatos_lpc_ring_produce(yatos_lpc_ring *ch, int ring, const lpc_ring_ent *ent) {
+	lpc_ring_idx  *idx;
+	lpc_ring_ent *ents;
+	uint64_t      tail;
+
+	idx = ring_idx(ch, ring);
+	tail = idx->tail;
+
+	if ( ( tail - idx->head ) >= idx->nr_ents ) {
+
+		set_errno(-EAGAIN);
+		return -1;
+	}
+
+	ents = (lpc_ring_ent *)( ch->base + idx->offset );
+	memcpy( &ents[ tail & ( idx->nr_ents - 1 ) ], ent, sizeof(lpc_ring_ent) );
+
+	__sync_synchronize();  /*  エントリの書き込みを先に完了させる  */
+	idx->tail = tail + 1;
+	__sync_synchronize();  /*  tail更新後に待ち合わせ中フラグを参照する  */
+
+	if ( idx->waiting )
+		return yatos_lpc_ring_notify(ch, ring);  /*  ドアベル  */
+
+	return 0;
+}
+
+/** リングからエントリを取り出す
+    @param[in]  ch    リングチャネル
+    @param[in]  ring  取り出し元のリング
+    @param[out] ent   取り出したエントリの格納先
+    @param[in]  tmout タイムアウト時間(単位:ms, LPC_NON_BLOCKの場合は待ち合わせない)
+    @retval     0     正常に取り出した
+    @retval    -1     取り出しに失敗した(errnoに要因を設定)
+ */
+int
+yatos_lpc_ring_consume(yatos_lpc_ring *ch, int ring, lpc_ring_ent *ent, 
+    lpc_tmout tmout) {
+	int             rc;
+	lpc_ring_idx  *idx;
+	lpc_ring_ent *ents;
+	uint64_t      head;
+
+	idx = ring_idx(ch, ring);
+	ents = (lpc_ring_ent *)( ch->base + idx->offset );
+
+	while( 1 ) {
+
+		head = idx->head;
+		if ( head != idx->tail )
+			break;
+
+		if ( tmout == LPC_NON_BLOCK ) {
+
+			set_errno(-EAGAIN);
+			return -1;
+		}
+
+		rc = yatos_lpc_ring_wait(ch, ring, tmout);
+		if ( rc != 0 )
+			return -1;  /*  errnoは設定済み  */
+	}
+
+	__sync_synchronize();  /*  tailの参照後にエントリを読み込む  */
+	memcpy( ent, &ents[ head & ( idx->nr_ents - 1 ) ], sizeof(lpc_ring_ent) );
+	__sync_synchronize();  /*  エントリの読み込み後に領域を返却する  */
+	idx->head = head + 1;
+
+	return 0;
+}
@@ -82,3 +82,236 @@ yatos_lpc_send_and_reply(endpoint dest, void *m) {
 
 	return 0;
 }
+
+/** 短メッセージを送信する
+    @param[in] dest  送信先エンドポイント
+    @param[in] sm    送信する短メッセージ
+    @retval    0     正常に送信した
+    @retval   -1     送信に失敗した
+    @note 短メッセージはレジスタ経由で受け渡す
+ */
+int
+yatos_lpc_short_send(endpoint dest, lpc_short_msg *sm){
+	syscall_res_type   res;
+	syscall_arg_type   arg;
+	lpc_short_msg      tmp;
+
+	arg = (syscall_arg_type)dest;
+	memcpy(&tmp, sm, sizeof(lpc_short_msg));
+
+	syscall_short( res, SYS_YATOS_LPC_SHORT_SEND, arg, tmp.w);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 短メッセージを受信する
+    @param[in]  src    送信元エンドポイント
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[out] sm     受信した短メッセージの格納先
+    @param[out] sender 送信元エンドポイントの格納先
+    @retval    0     正常に受信した
+    @retval   -1     受信に失敗した
+ */
+int 
+yatos_lpc_short_recv(endpoint src, lpc_tmout tmout, lpc_short_msg *sm, 
+    endpoint *sender){
+	syscall_res_type   res;
+	syscall_arg_type   arg;
+	lpc_short_msg      tmp;
+
+	arg = (syscall_arg_type)src;
+	memset(&tmp, 0, sizeof(lpc_short_msg));
+	tmp.w[0] = (uint64_t)tmout;
+
+	syscall_short( res, SYS_YATOS_LPC_SHORT_RECV, arg, tmp.w);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	memcpy(sm, &tmp, sizeof(lpc_short_msg));
+	if ( sender != NULL )
+		*sender = (endpoint)arg;
+
+	return 0;
+}
+
+/** 短メッセージを送信後短メッセージによるリプライを待ち合わせる
+    @param[in]     dest  送信先エンドポイント
+    @param[in,out] sm    送受信する短メッセージ
+    @retval    0     正常に受信した
+    @retval   -1     送受信に失敗した
+ */
+int
+yatos_lpc_short_call(endpoint dest, lpc_short_msg *sm) {
+	syscall_res_type   res;
+	syscall_arg_type   arg;
+
+	arg = (syscall_arg_type)dest;
+
+	syscall_short( res, SYS_YATOS_LPC_SHORT_CALL, arg, sm->w);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** LPCメッセージを非同期に送信する
+    @param[in]  dest  送信先エンドポイント
+    @param[in]  m     送信電文
+    @param[out] idp   割り当てられた要求IDの格納先
+    @retval    0     送信先のキューに登録した
+    @retval   -1     送信に失敗した(送信先のキューに空きがない場合はEAGAIN)
+ */
+int
+yatos_lpc_send_async(endpoint dest, void *m, lpc_req_id *idp){
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_LPC_SEND_ASYNC, 
+	    (syscall_arg_type)dest, 
+	    (syscall_arg_type)m,
+	    (syscall_arg_type)idp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 非同期送信の配送結果を回収する
+    @param[in]  tmout    タイムアウト時間(単位:ms)
+    @param[out] idp      配送結果に対応する要求IDの格納先
+    @param[out] statusp  配送結果の格納先
+    @retval    0     配送結果を回収した
+    @retval   -1     回収に失敗した
+ */
+int
+yatos_lpc_async_wait(lpc_tmout tmout, lpc_req_id *idp, int *statusp){
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_LPC_ASYNC_WAIT, 
+	    (syscall_arg_type)tmout, 
+	    (syscall_arg_type)idp,
+	    (syscall_arg_type)statusp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 要求IDと共にLPCメッセージを受信する
+    @param[in]  src    送信元エンドポイント
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[out] m      受信電文
+    @param[out] sender 送信元エンドポイントの格納先
+    @param[out] reqp   要求IDの格納先(応答の場合は対応する要求の要求ID)
+    @retval    0     正常に受信した
+    @retval   -1     受信に失敗した
+ */
+int 
+yatos_lpc_recv_req(endpoint src, lpc_tmout tmout, void *m, endpoint *sender,
+    lpc_req_id *reqp){
+	syscall_res_type res;
+
+	syscall5( res, SYS_YATOS_LPC_RECV_REQ, 
+	    (syscall_arg_type)src, 
+	    (syscall_arg_type)tmout, 
+	    (syscall_arg_type)m,
+	    (syscall_arg_type)sender,
+	    (syscall_arg_type)reqp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 複数のLPCメッセージを一括して受信する
+    @param[in]  src   送信元エンドポイント
+    @param[in]  tmout 最初のメッセージを待ち合わせるタイムアウト時間(単位:ms)
+    @param[out] ents  受信したメッセージの格納先配列
+    @param[in]  nr    格納先配列の要素数
+    @return    正    受信したメッセージ数
+    @retval   -1     受信に失敗した
+ */
+int 
+yatos_lpc_recv_batch(endpoint src, lpc_tmout tmout, lpc_batch_ent *ents, int nr){
+	syscall_res_type res;
+
+	syscall4( res, SYS_YATOS_LPC_RECV_BATCH, 
+	    (syscall_arg_type)src, 
+	    (syscall_arg_type)tmout, 
+	    (syscall_arg_type)ents,
+	    (syscall_arg_type)nr);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return (int)res;
+}
+
+/** 一括受信したLPCメッセージに一括して応答する
+    @param[in,out] ents  応答メッセージの配列(各要素のrcに送信結果を返却)
+    @param[in]     nr    配列の要素数
+    @return    0以上 送信に成功した応答数
+    @retval   -1     応答に失敗した
+ */
+int 
+yatos_lpc_reply_batch(lpc_batch_ent *ents, int nr){
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_LPC_REPLY_BATCH, 
+	    (syscall_arg_type)ents,
+	    (syscall_arg_type)nr);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return (int)res;
+}
+
+/** 複数のエンドポイントとイベントを同時に待ち合わせる
+    @param[in]  eps    待ち合わせ対象エンドポイントの配列
+    @param[in]  nr     配列の要素数
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[out] readyp 受信可能な要因のビットマップ返却先
+    @return    正  受信可能な要因の数
+    @retval   -1   待ち合わせに失敗した
+ */
+int 
+yatos_lpc_wait_any(endpoint *eps, int nr, lpc_tmout tmout, uint64_t *readyp){
+	syscall_res_type res;
+
+	syscall4( res, SYS_YATOS_LPC_WAIT_ANY, 
+	    (syscall_arg_type)eps, 
+	    (syscall_arg_type)nr, 
+	    (syscall_arg_type)tmout,
+	    (syscall_arg_type)readyp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return (int)res;
+}
@@ -148,6 +148,44 @@ yatos_proc_bcast_proc_event(tid dest, event_no  id, event_data data) {
 	return 0;
 }
 
+/** 指定したスレッドにイベントを集約配送する
+    @param[in] dest 送信先スレッドのID
+    @param[in] id   イベントID
+    @note 付帯情報を持たないイベントの発生回数のみを通知する
+ */
+int
+yatos_proc_notify_event(tid dest, event_no  id) {
+	int                      rc;
+	msg_body                msg;
+	proc_service          *pmsg;
+	proc_sys_send_event  *sndev;
+
+	pmsg= &msg.proc_msg;
+	sndev = &pmsg->proc_service_calls.sndev;
+
+	memset( &msg, 0, sizeof(msg_body) );
+
+	pmsg->req = PROC_SERV_REQ_SNDEV;
+	sndev->dest = dest;
+	sndev->type = PROC_SERV_SNDEV_NOTIFY;
+	sndev->id = id;
+
+	rc = yatos_lpc_send_and_reply( ID_RESV_PROC, &msg );
+	if ( rc != 0 ) {
+
+		set_errno(rc);
+		return -1;
+	}
+
+	if ( pmsg->rc != 0 ) {
+
+		set_errno(pmsg->rc);
+		return -1;
+	}
+
+	return 0;
+}
+
 /** ユーザスレッドを生成する
     @param[in] prio   生成するスレッドの優先度
     @param[in] start  開始アドレス
@@ -15,6 +15,99 @@
 #include <ulib/service-svc.h>
 #include <ulib/thread-svc.h>
 #include <ulib/lpc-svc.h>
+#include <ulib/futex-svc.h>
+
+/** 名前解決キャッシュ
+ */
+static yatos_ns_cache ns_cache = { .mtx = YATOS_MUTEX_INITIALIZER, };
+
+/** ネームサービスの世代番号を取得する
+    @param[out] genp 世代番号格納先
+    @retval    0     正常終了
+    @retval    負    取得失敗
+ */
+static int
+ns_cache_generation(kserv_gen *genp) {
+	syscall_res_type res;
+
+	syscall1( res, SYS_YATOS_KNS_GENERATION, (syscall_arg_type)genp);
+
+	return (int)res;
+}
+
+/** 名前解決キャッシュを検索する
+    @param[in]  name サービス名
+    @param[in]  hash サービス名のハッシュ値
+    @param[out] ep   エンドポイント格納先アドレス
+    @retval     true  キャッシュ中に有効な解決結果があった
+    @retval     false キャッシュ中に有効な解決結果がなかった
+    @note 解決後にサービスの登録が解除されていた場合(世代番号の不一致)は
+    無効なエントリとして扱う
+ */
+static bool
+ns_cache_lookup(const char *name, kserv_hash hash, endpoint *ep) {
+	bool                  hit;
+	kserv_gen             gen;
+	yatos_ns_cache_ent   *ent;
+
+	if ( ns_cache_generation(&gen) != 0 )
+		return false;
+
+	ent = &ns_cache.ents[ hash & ( YATOS_NS_CACHE_SIZE - 1 ) ];
+
+	yatos_mutex_lock( &ns_cache.mtx );
+
+	hit = ( ent->valid ) && ( ent->gen == gen ) && ( ent->hash == hash ) &&
+		( strcmp(ent->name, name) == 0 );
+	if ( hit )
+		*ep = ent->ep;
+
+	yatos_mutex_unlock( &ns_cache.mtx );
+
+	return hit;
+}
+
+/** 名前解決結果をキャッシュに登録する
+    @param[in] name サービス名
+    @param[in] hash サービス名のハッシュ値
+    @param[in] gen  名前解決時の世代番号
+    @param[in] ep   サービスのエンドポイント
+ */
+static void
+ns_cache_insert(const char *name, kserv_hash hash, kserv_gen gen, endpoint ep) {
+	size_t                len;
+	yatos_ns_cache_ent   *ent;
+
+	len = strlen(name);
+	if ( len >= KSERV_NAME_LEN )
+		return;  /*  ネームサービス側で切り詰められる名前はキャッシュしない  */
+
+	ent = &ns_cache.ents[ hash & ( YATOS_NS_CACHE_SIZE - 1 ) ];
+
+	yatos_mutex_lock( &ns_cache.mtx );
+
+	memcpy(ent->name, name, len + 1);
+	ent->hash = hash;
+	ent->gen = gen;
+	ent->ep = ep;
+	ent->valid = true;
+
+	yatos_mutex_unlock( &ns_cache.mtx );
+}
+
+/** 名前解決キャッシュを破棄する
+ */
+void
+yatos_flush_service_cache(void) {
+	int i;
+
+	yatos_mutex_lock( &ns_cache.mtx );
+
+	for( i = 0; YATOS_NS_CACHE_SIZE > i; ++i)
+		ns_cache.ents[i].valid = false;
+
+	yatos_mutex_unlock( &ns_cache.mtx );
+}
 
 /** 自スレッドをサービス提供者として登録する
     @param[in] name  サービス名
@@ -89,12 +182,15 @@ yatos_unregister_service(const char *name) {
     @param[out] ep   エンドポイント格納先アドレス
     @retval    0     正常終了
     @retval    負    登録失敗
+    @note 名前解決キャッシュに有効な結果がある場合はネームサービスに
+    問い合わせずに返却する
  */
 int 
 yatos_lookup_service(const char *name, endpoint *ep){
 	int                  rc;
 	msg_body            msg;
 	kname_service_msg *nsrv;
+	kserv_hash         hash;
 
 	if ( ( name == NULL ) || ( ep == NULL ) ) {
 
@@ -102,6 +198,10 @@ yatos_lookup_service(const char *name, endpoint *ep){
 		return -1;
 	}
 
+	hash = kserv_name_hash(name);
+	if ( ns_cache_lookup(name, hash, ep) )
+		return 0;  /*  キャッシュヒット  */
+
 	nsrv = &msg.kname_msg;
 	
 	memset( &msg, 0, sizeof(msg_body) );
@@ -122,6 +222,7 @@ yatos_lookup_service(const char *name, endpoint *ep){
 	}
 
 	*ep = nsrv->id;
+	ns_cache_insert(name, hash, nsrv->gen, nsrv->id);
 
 	return 0;
 }
@@ -82,9 +82,7 @@ yatos_thread_wait(tid wait_tid, thread_wait_flags wflags, tid *exit_tidp, exit_c
 int
 yatos_get_event_mask(event_mask *msk) {
 	int                      rc;
-	msg_body                msg;
-	thr_service           *smsg;
-	thr_sys_mask_op       *argp;
+	lpc_short_msg            sm;
 
 	if ( msk == NULL ) {
 
@@ -92,27 +90,27 @@ yatos_get_event_mask(event_mask *msk) {
 		return -1;
 	}
 	
-	smsg= &msg.thr_msg;
-	argp = &smsg->thr_service_calls.maskop;
+	memset( &sm, 0, sizeof(lpc_short_msg) );
 
-	memset( &msg, 0, sizeof(msg_body) );
+	/*
+	 * 短メッセージで要求する
+	 * 要求時: w[0] 要求コード
+	 * 応答時: w[0] 処理結果, w[1]以降 イベントマスク
+	 */
+	sm.w[LPC_SHORT_REQ_WORD] = THR_SERV_REQ_GET_EVMSK;
 
-	smsg->req = THR_SERV_REQ_GET_EVMSK;
+	rc = yatos_lpc_short_call( ID_RESV_THR, &sm );
+	if ( rc != 0 )
+		return -1;  /*  errnoは設定済み  */
 
-	rc = yatos_lpc_send_and_reply( ID_RESV_THR, &msg );
+	rc = (int)(int64_t)sm.w[LPC_SHORT_REQ_WORD];
 	if ( rc != 0 ) {
 
-		set_errno(rc);
-		return -1;
-	}
-
-	if ( smsg->rc != 0 ) {
-
-		set_errno( smsg->rc );
+		set_errno( rc );
 		return -1;
 	}
 	
-	memcpy(msk, &argp->mask, sizeof(event_mask) );
+	memcpy(msk, &sm.w[1], sizeof(event_mask) );
 
 	return 0;
 }
@@ -125,9 +123,7 @@ yatos_get_event_mask(event_mask *msk) {
 int
 yatos_set_event_mask(event_mask *msk) {
 	int                      rc;
-	msg_body                msg;
-	thr_service           *smsg;
-	thr_sys_mask_op       *argp;
+	lpc_short_msg            sm;
 
 	if ( msk == NULL ) {
 
@@ -135,26 +131,105 @@ yatos_set_event_mask(event_mask *msk) {
 		return -1;
 	}
 	
-	smsg= &msg.thr_msg;
-	argp = &smsg->thr_service_calls.maskop;
+	memset( &sm, 0, sizeof(lpc_short_msg) );
 
-	memset( &msg, 0, sizeof(msg_body) );
+	/*
+	 * 短メッセージで要求する
+	 * 要求時: w[0] 要求コード, w[1]以降 イベントマスク
+	 * 応答時: w[0] 処理結果
+	 */
+	sm.w[LPC_SHORT_REQ_WORD] = THR_SERV_REQ_SET_EVMSK;
+	memcpy(&sm.w[1], msk, sizeof(event_mask) );
 
-	smsg->req = THR_SERV_REQ_SET_EVMSK;
-	memcpy(&argp->mask, msk, sizeof(event_mask) );
+	rc = yatos_lpc_short_call( ID_RESV_THR, &sm );
+	if ( rc != 0 )
+		return -1;  /*  errnoは設定済み  */
 
-	rc = yatos_lpc_send_and_reply( ID_RESV_THR, &msg );
+	rc = (int)(int64_t)sm.w[LPC_SHORT_REQ_WORD];
 	if ( rc != 0 ) {
 
-		set_errno(rc);
+		set_errno( rc );
 		return -1;
 	}
+	
+	return 0;
+}
 
-	if ( smsg->rc != 0 ) {
+/** 自スレッドに共有イベントマスクページを割り当てる
+    @param[out] pagep 共有マスクページのアドレス返却先
+    @retval     0   正常に割り当てた
+    @retval    -1   割り当てに失敗した
+    @note 割り当て後はyatos_ev_mask_block/unblock/updateによりシステムコールを
+    発行せずにマスクを更新できる
+ */
+int
+yatos_ev_mask_attach(ev_mask_page **pagep) {
+	syscall_res_type res;
 
-		set_errno( smsg->rc );
+	syscall1( res, SYS_YATOS_EV_MASK_ATTACH, (syscall_arg_type)pagep);
+	set_errno(res);
+	if ( res < 0 )
 		return -1;
-	}
-	
+
 	return 0;
 }
+
+/** 共有マスクページ上の保留通知を確認し, 必要に応じてカーネルに通知する
+    @param[in] pg 共有マスクページ
+    @retval    0   正常に通知した
+    @retval   -1   通知に失敗した
+    @note マスク中に保留されたイベントがある場合のみシステムコールを発行する.
+    配送可能になったイベントはシステムコール復帰時に配送される.
+ */
+static int
+notify_masked_events(ev_mask_page *pg) {
+	syscall_res_type res;
+
+	if ( !pg->pending )
+		return 0;  /*  保留中のイベントがない  */
+
+	syscall0( res, SYS_YATOS_EV_MASK_SYNC);
+	set_errno(res);
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 共有マスクページ上でイベントをマスクする
+    @param[in] pg 共有マスクページ
+    @param[in] id マスクするイベント番号
+ */
+void
+yatos_ev_mask_block(ev_mask_page *pg, event_no id) {
+
+	ev_mask_set( &pg->masks, id );
+}
+
+/** 共有マスクページ上でイベントのマスクを解除する
+    @param[in] pg 共有マスクページ
+    @param[in] id マスクを解除するイベント番号
+    @retval    0   正常に解除した
+    @retval   -1   保留中のイベントの通知に失敗した
+ */
+int
+yatos_ev_mask_unblock(ev_mask_page *pg, event_no id) {
+
+	ev_mask_unset( &pg->masks, id );
+
+	return notify_masked_events(pg);
+}
+
+/** 共有マスクページ上のイベントマスクを更新する
+    @param[in] pg  共有マスクページ
+    @param[in] msk 設定するイベントマスク
+    @retval    0   正常に更新した
+    @retval   -1   保留中のイベントの通知に失敗した
+ */
+int
+yatos_ev_mask_update(ev_mask_page *pg, event_mask *msk) {
+
+	memcpy( &pg->masks, msk, sizeof(event_mask) );
+
+	return notify_masked_events(pg);
+}
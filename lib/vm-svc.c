@@ -16,34 +16,201 @@
 #include <ulib/lpc-svc.h>
 #include <ulib/utils.h>
 
+/** ヒープ範囲を伸縮する
+    @param[in] increment ヒープ終端の増分(負の場合は縮小)
+    @retval    非NULL    更新前のヒープ終端
+    @retval    NULL      更新に失敗した
+    @note 呼出元のコンテキストでカーネル内で直接処理する
+ */
 void *
 yatos_vm_sbrk(intptr_t increment) {
+	syscall_res_type res;
+	void        *old_end;
+
+	syscall2( res, SYS_YATOS_VM_SBRK, 
+	    (syscall_arg_type)increment, 
+	    (syscall_arg_type)&old_end);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return NULL;
+
+	return old_end;
+}
+
+/** VMサーバを経由してヒープ範囲を伸縮する
+    @param[in] increment ヒープ終端の増分(負の場合は縮小)
+    @retval    非NULL    更新前のヒープ終端
+    @retval    NULL      更新に失敗した
+    @note 互換性のために残しているLPC版の実装
+ */
+void *
+yatos_vm_sbrk_service(intptr_t increment) {
 	int               rc;
-	msg_body         msg;
-	vm_service   *pmsg;
-	vm_sys_sbrk  *sbrk;
+	lpc_short_msg     sm;
 
-	pmsg= &msg.vm_msg;
-	sbrk = &pmsg->vm_service_calls.sbrk;
+	memset( &sm, 0, sizeof(lpc_short_msg) );
 
-	memset( &msg, 0, sizeof(msg_body) );
+	/*
+	 * 短メッセージで要求する
+	 * 要求時: w[0] 要求コード, w[1] 増分
+	 * 応答時: w[0] 処理結果,   w[1] 更新前のヒープ終端
+	 */
+	sm.w[LPC_SHORT_REQ_WORD] = VM_SERV_REQ_SBRK;
+	sm.w[1] = (uint64_t)increment;
 
-	pmsg->req = VM_SERV_REQ_SBRK;
-	sbrk->inc = increment;
+	rc = yatos_lpc_short_call( ID_RESV_VM, &sm );
+	if ( rc != 0 ) 
+		return NULL;  /*  errnoは設定済み  */
 
-	rc = yatos_lpc_send_and_reply( ID_RESV_VM, &msg );
+	rc = (int)(int64_t)sm.w[LPC_SHORT_REQ_WORD];
 	if ( rc != 0 ) {
 
 		set_errno(rc);
 		return NULL;
 	}
 
-	if ( pmsg->rc != 0 ) {
+	return (void *)sm.w[1];
+}
 
-		set_errno(pmsg->rc);
-		return NULL;
-	}
+/** 自プロセスのページを指定した受信者に提供する
+    @param[in]  grantee 受信者のエンドポイント
+    @param[in]  start   提供する領域の開始アドレス(ページ境界)
+    @param[in]  size    提供する領域の長さ(ページサイズの倍数)
+    @param[in]  prot    受信者に許可するアクセス属性
+    @param[out] idp     グラントID返却先
+    @retval     0       正常に提供した
+    @retval    -1       提供に失敗した
+ */
+int
+yatos_vm_grant(endpoint grantee, void *start, size_t size, vma_prot prot,
+    vm_grant_id *idp) {
+	syscall_res_type res;
 
-	return sbrk->old_heap_end;
+	syscall5( res, SYS_YATOS_VM_GRANT, 
+	    (syscall_arg_type)grantee, 
+	    (syscall_arg_type)start, 
+	    (syscall_arg_type)size,
+	    (syscall_arg_type)prot,
+	    (syscall_arg_type)idp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
 }
 
+/** 提供されたページを自プロセスの仮想空間にマップする
+    @param[in] id    グラントID
+    @param[in] addr  マップ先のアドレス(ページ境界)
+    @param[in] prot  マップ時のアクセス属性
+    @retval     0       正常にマップした
+    @retval    -1       マップに失敗した
+ */
+int
+yatos_vm_grant_map(vm_grant_id id, void *addr, vma_prot prot) {
+	syscall_res_type res;
+
+	syscall3( res, SYS_YATOS_VM_GRANT_MAP, 
+	    (syscall_arg_type)id, 
+	    (syscall_arg_type)addr, 
+	    (syscall_arg_type)prot);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 提供されたページのマップを解除する
+    @param[in] id グラントID
+    @retval     0       正常にアンマップした
+    @retval    -1       アンマップに失敗した
+ */
+int
+yatos_vm_grant_unmap(vm_grant_id id) {
+	syscall_res_type res;
+
+	syscall1( res, SYS_YATOS_VM_GRANT_UNMAP, 
+	    (syscall_arg_type)id);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 提供したページを取り消す
+    @param[in] id グラントID
+    @retval     0       正常に取り消した
+    @retval    -1       取り消しに失敗した
+ */
+int
+yatos_vm_grant_revoke(vm_grant_id id) {
+	syscall_res_type res;
+
+	syscall1( res, SYS_YATOS_VM_GRANT_REVOKE, 
+	    (syscall_arg_type)id);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 匿名メモリ領域を割り当てる
+    @param[in]  addr   割当て先の先頭アドレス(ページ境界, NULLの場合はカーネルが選択)
+    @param[in]  size   領域長
+    @param[in]  prot   アクセス属性
+    @param[out] addrp  割り当てた領域の先頭アドレス返却先
+    @retval     0      正常に割り当てた
+    @retval    -1      割当てに失敗した
+ */
+int
+yatos_vm_map_anon(void *addr, size_t size, vma_prot prot, void **addrp) {
+	syscall_res_type res;
+
+	syscall4( res, SYS_YATOS_VM_MAP_ANON, 
+	    (syscall_arg_type)addr, 
+	    (syscall_arg_type)size,
+	    (syscall_arg_type)prot,
+	    (syscall_arg_type)addrp);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
+
+/** 匿名メモリ領域を解放する
+    @param[in] addr  領域の先頭アドレス
+    @param[in] size  領域長(割当て時の長さ)
+    @retval    0     正常に解放した
+    @retval   -1     解放に失敗した
+ */
+int
+yatos_vm_unmap_anon(void *addr, size_t size) {
+	syscall_res_type res;
+
+	syscall2( res, SYS_YATOS_VM_UNMAP_ANON, 
+	    (syscall_arg_type)addr, 
+	    (syscall_arg_type)size);
+
+	set_errno(res);
+
+	if ( res < 0 )
+		return -1;
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Local process communication port routines                         */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/rbtree.h>
+#include <kern/refcount.h>
+#include <kern/thread.h>
+#include <kern/page.h>
+#include <kern/lpc.h>
+
+/** ポート表
+ */
+static lpc_port_db port_db = __LPC_PORT_DB_INITIALIZER( &port_db.head );
+
+static int lpc_port_cmp(struct _lpc_port *_a, struct _lpc_port *_b);
+
+RB_GENERATE_STATIC(lpc_port_tree, _lpc_port, node, lpc_port_cmp);
+
+/** ポートIDの比較関数
+    @param[in] a ポート1
+    @param[in] b ポート2
+    @retval 0  ポート1とポート2のIDが等しい
+    @retval 負 ポート1のIDがポート2のIDより小さい
+    @retval 正 ポート1のIDがポート2のIDより大きい
+ */
+static int
+lpc_port_cmp(struct _lpc_port *a, struct _lpc_port *b) {
+
+	kassert( a != NULL );
+	kassert( b != NULL );
+
+	if ( a->id < b->id )
+		return -1;
+
+	if ( a->id > b->id )
+		return 1;
+
+	return 0;
+}
+
+/** ポートを解放する
+    @param[in] port 解放するポート
+    @note ポート表から取り外し済みで, 参照者がいない状態で呼び出す
+ */
+static void
+lpc_port_free(lpc_port *port) {
+
+	kassert( port != NULL );
+	kassert( queue_is_empty( &port->mque.que ) );
+
+	kfree(port);
+}
+
+/** ポートを生成する
+    @param[in]  id    ポートID(LPC_PORT_ANYの場合は自動割り当て, 
+                      それ以外の場合は予約ID)
+    @param[out] portp 生成したポートのエンドポイント格納先
+    @retval     0        正常に生成した
+    @retval    -EINVAL   予約IDでないIDを指定した
+    @retval    -EBUSY    指定したIDのポートが既に存在する
+    @retval    -ENOMEM   メモリ不足
+ */
+int
+lpc_port_create(endpoint id, endpoint *portp) {
+	lpc_port  *port, *res;
+
+	kassert( portp != NULL );
+
+	if ( ( id != LPC_PORT_ANY ) && 
+	    ( ( id == ID_RESV_IDLE ) || ( id >= ID_NR_RESVED ) ) )
+		return -EINVAL;
+
+	port = kmalloc( sizeof(lpc_port), KMALLOC_NORMAL );
+	if ( port == NULL )
+		return -ENOMEM;
+
+	refcnt_init( &port->refs );
+	lpc_msg_queue_init( &port->mque );
+	/*  
+	 * 受信者は先頭の1スレッドだけを起床し, 
+	 * 空いている受信者が順に次のメッセージを受信する
+	 */
+	sync_init_object( &port->mque.wait_sender, SYNC_WAKE_FLAG_ONE, 
+	    THR_TSTATE_WAIT);
+
+	spinlock_lock( &port_db.lock );
+
+	if ( id == LPC_PORT_ANY ) 
+		port->id = port_db.next_id++;  /*  IDを割り当てる  */
+	else
+		port->id = id;
+
+	res = RB_INSERT(lpc_port_tree, &port_db.head, port);
+
+	spinlock_unlock( &port_db.lock );
+
+	if ( res != NULL ) {  /*  登録済み  */
+
+		kfree(port);
+		return -EBUSY;
+	}
+
+	*portp = port->id;
+
+	return 0;
+}
+
+/** ポートを破棄する
+    @param[in] id    破棄するポートのエンドポイント
+    @retval    0        正常に破棄した
+    @retval   -ENOENT   ポートが存在しない
+    @note 待ち合わせている送信者, 受信者は-ENOENTで復帰する
+ */
+int
+lpc_port_destroy(endpoint id) {
+	int           rc;
+	lpc_port    key;
+	lpc_port  *port;
+
+	key.id = id;
+
+	spinlock_lock( &port_db.lock );
+	port = RB_FIND(lpc_port_tree, &port_db.head, &key);
+	if ( port == NULL ) {
+
+		spinlock_unlock( &port_db.lock );
+		return -ENOENT;
+	}
+	RB_REMOVE(lpc_port_tree, &port_db.head, port);  /*  以降の検索を抑止  */
+	spinlock_unlock( &port_db.lock );
+
+	refcnt_mark_deleted( &port->refs );
+	lpc_destroy_msg_queue( &port->mque );  /*  待ちスレッドを起床  */
+
+	rc = refcnt_put( &port->refs, NULL );
+	if ( rc == 0 )
+		lpc_port_free(port);  /*  最後の参照者が解放  */
+
+	return 0;
+}
+
+/** ポートへの参照を獲得する
+    @param[in] id    ポートのエンドポイント
+    @return 非NULL 参照を獲得したポート
+    @return NULL   ポートが存在しない
+ */
+lpc_port *
+lpc_port_get(endpoint id) {
+	int           rc;
+	lpc_port    key;
+	lpc_port  *port;
+
+	key.id = id;
+
+	spinlock_lock( &port_db.lock );
+
+	port = RB_FIND(lpc_port_tree, &port_db.head, &key);
+	if ( port != NULL ) {
+
+		rc = refcnt_get( &port->refs, NULL );
+		if ( rc != 0 )
+			port = NULL;  /*  破棄中  */
+	}
+
+	spinlock_unlock( &port_db.lock );
+
+	return port;
+}
+
+/** ポートへの参照を解放する
+    @param[in] port 操作対象のポート
+    @note 破棄済みのポートの最後の参照を解放した場合はポートを解放する
+ */
+void
+lpc_port_put(lpc_port *port) {
+	int rc;
+
+	kassert( port != NULL );
+
+	rc = refcnt_put( &port->refs, NULL );
+	if ( rc == 0 )
+		lpc_port_free(port);
+}
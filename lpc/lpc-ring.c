@@ -0,0 +1,623 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Shared memory ring channel routines                               */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/rbtree.h>
+#include <kern/refcount.h>
+#include <kern/proc.h>
+#include <kern/thread.h>
+#include <kern/thread-sync.h>
+#include <kern/timer.h>
+#include <kern/vm.h>
+#include <kern/page.h>
+#include <kern/rwsem.h>
+#include <kern/mutex.h>
+#include <kern/lpc-ring.h>
+
+/** チャネル表
+ */
+static lpc_ring_db ring_db = __LPC_RING_DB_INITIALIZER( ring_db );
+
+static int lpc_ring_cmp(struct _lpc_ring *_a, struct _lpc_ring *_b);
+
+RB_GENERATE_STATIC(lpc_ring_tree, _lpc_ring, node, lpc_ring_cmp);
+
+/** チャネルIDの比較関数
+    @param[in] a チャネル1
+    @param[in] b チャネル2
+    @retval 0  チャネル1とチャネル2のIDが等しい
+    @retval 負 チャネル1のIDがチャネル2のIDより小さい
+    @retval 正 チャネル1のIDがチャネル2のIDより大きい
+ */
+static int
+lpc_ring_cmp(struct _lpc_ring *a, struct _lpc_ring *b) {
+
+	kassert( a != NULL );
+	kassert( b != NULL );
+
+	if ( a->id < b->id )
+		return -1;
+
+	if ( a->id > b->id )
+		return 1;
+
+	return 0;
+}
+
+/** チャネルを解放する
+    @param[in] r 解放するチャネル
+ */
+static void
+lpc_ring_free(lpc_ring *r) {
+	obj_cnt_type i;
+
+	kassert( r != NULL );
+
+	for( i = 0; r->nr_pages > i; ++i)
+		free_page( r->pages[i] );
+
+	kfree(r);
+}
+
+/** チャネルへの参照を得る
+    @param[in] id チャネルID
+    @return    チャネル(見つからなかった場合はNULL)
+ */
+static lpc_ring *
+lpc_ring_get(lpc_ring_id id) {
+	int           rc;
+	lpc_ring     key;
+	lpc_ring      *r;
+
+	key.id = id;
+
+	spinlock_lock( &ring_db.lock );
+
+	r = RB_FIND(lpc_ring_tree, &ring_db.head, &key);
+	if ( r != NULL ) {
+
+		rc = refcnt_get( &r->refs, NULL );
+		if ( rc != 0 )
+			r = NULL;  /*  破棄中  */
+	}
+
+	spinlock_unlock( &ring_db.lock );
+
+	return r;
+}
+
+/** チャネルへの参照を解放する
+    @param[in] r 操作対象のチャネル
+    @note 破棄済みのチャネルの最後の参照を解放した場合はチャネルを解放する
+ */
+static void
+lpc_ring_put(lpc_ring *r) {
+	int rc;
+
+	kassert( r != NULL );
+
+	rc = refcnt_put( &r->refs, NULL );
+	if ( rc == 0 )
+		lpc_ring_free(r);
+}
+
+/** 自スレッドの仮想空間がチャネルをマップしていることを確認する
+    @param[in] r 操作対象のチャネル
+    @retval    true  マップしている
+    @retval    false マップしていない
+ */
+static bool
+lpc_ring_is_mapped_by_self(lpc_ring *r) {
+	bool rc;
+	vm  *as;
+
+	as = &current->p->vm;
+
+	spinlock_lock( &ring_db.lock );
+	rc = ( ( ( r->as[LPC_RING_CREATOR] == as ) && ( r->vma[LPC_RING_CREATOR] != NULL ) )
+	    || ( ( r->as[LPC_RING_PEER] == as ) && ( r->vma[LPC_RING_PEER] != NULL ) ) );
+	spinlock_unlock( &ring_db.lock );
+
+	return rc;
+}
+
+/** チャネルのページを仮想空間にマップする
+    @param[in]  r     操作対象のチャネル
+    @param[in]  as    マップ先の仮想空間
+    @param[in]  addr  マップ先のアドレス
+    @param[out] vmapp マップした仮想アドレス領域の返却先
+    @retval     0       正常にマップした
+    @retval    -EBUSY   マップ先の領域が使用中
+    @retval    -ENOMEM  メモリ不足
+    @note 同一のページフレームを両端の仮想空間にマップする
+ */
+static int
+lpc_ring_map(lpc_ring *r, vm *as, void *addr, vma **vmapp) {
+	int             rc;
+	obj_cnt_type     i;
+
+	rwsem_down_write( &as->asmtx );
+
+	rc = vm_create_vma(as, vmapp, addr, r->nr_pages * PAGE_SIZE,
+	    VMA_PROT_R | VMA_PROT_W, VMA_FLAG_FIXED);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	for( i = 0; r->nr_pages > i; ++i) {
+
+		rc = hal_map_user_page(as, (uintptr_t)( addr + i * PAGE_SIZE ),
+		    (uintptr_t)r->pages[i], VMA_PROT_R | VMA_PROT_W);
+		kassert( rc == 0 );
+	}
+
+unlock_out:
+	rwsem_up_write( &as->asmtx );
+
+	return rc;
+}
+
+/** チャネルの待ち合わせを終了させ, 参照を解放する
+    @param[in] r 操作対象のチャネル
+    @note チャネル表から取り外し済みのチャネルについて呼び出す
+ */
+static void
+lpc_ring_shutdown(lpc_ring *r) {
+	int          i;
+	intrflags flags;
+
+	spinlock_lock_disable_intr( &r->lock, &flags );
+	for( i = 0; LPC_RING_NR > i; ++i)
+		sync_wake( &r->wait[i], SYNC_OBJ_DESTROYED );
+	spinlock_unlock_restore_intr( &r->lock, &flags );
+
+	refcnt_mark_deleted( &r->refs );
+	lpc_ring_put(r);
+}
+
+/** 共有メモリリングチャネルを生成し, 自プロセスの仮想空間にマップする
+    @param[in]  peer     接続を許可するエンドポイント
+    @param[in]  nr_pages チャネルのページ数(制御域を含む)
+    @param[in]  addr     マップ先のアドレス(ページ境界)
+    @param[out] idp      チャネルID返却先
+    @retval     0       正常に生成した
+    @retval    -EINVAL  アドレスの境界またはページ数が不正
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -EBUSY   マップ先の領域が使用中
+    @retval    -ENOMEM  メモリ不足
+    @retval    -EFAULT  チャネルIDを返却できなかった
+ */
+int
+lpc_ring_create(endpoint peer, obj_cnt_type nr_pages, void *addr,
+    lpc_ring_id *idp) {
+	int              rc;
+	int               i;
+	vm              *as;
+	lpc_ring         *r;
+	lpc_ring       *res;
+	lpc_ring_ctrl *ctrl;
+	uint64_t    nr_ents;
+	lpc_ring_id      id;
+
+	as = &current->p->vm;
+	if ( as->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( ( !PAGE_ALIGNED( (uintptr_t)addr ) ) || ( LPC_RING_MIN_PAGES > nr_pages )
+	    || ( nr_pages > LPC_RING_MAX_PAGES ) )
+		return -EINVAL;
+
+	r = kmalloc( sizeof(lpc_ring) + sizeof(void *) * nr_pages, KMALLOC_NORMAL );
+	if ( r == NULL )
+		return -ENOMEM;
+
+	list_init( &r->link );
+	refcnt_init( &r->refs );
+	spinlock_init( &r->lock );
+	r->id = LPC_RING_ID_NONE;
+	r->peer = peer;
+	r->dead = false;
+	for( i = 0; LPC_RING_NR > i; ++i) {
+
+		r->as[i] = NULL;
+		r->vma[i] = NULL;
+		sync_init_object( &r->wait[i], SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT );
+	}
+
+	for( r->nr_pages = 0; nr_pages > r->nr_pages; ++r->nr_pages) {
+
+		rc = get_free_page( &r->pages[r->nr_pages] );
+		if ( rc != 0 )
+			goto free_out;
+
+		memset( r->pages[r->nr_pages], 0, PAGE_SIZE );
+	}
+
+	/*
+	 * 先頭ページ以降を要求リングと完了リングで等分する
+	 */
+	nr_ents = ( ( nr_pages - 1 ) * PAGE_SIZE ) / ( 2 * sizeof(lpc_ring_ent) );
+	while( nr_ents & ( nr_ents - 1 ) )
+		nr_ents &= nr_ents - 1;  /*  2の冪に切り下げる  */
+
+	ctrl = (lpc_ring_ctrl *)r->pages[0];
+	for( i = 0; LPC_RING_NR > i; ++i) {
+
+		ctrl->idx[i].nr_ents = nr_ents;
+		ctrl->idx[i].offset = PAGE_SIZE + i * nr_ents * sizeof(lpc_ring_ent);
+	}
+
+	rc = lpc_ring_map(r, as, addr, &r->vma[LPC_RING_CREATOR]);
+	if ( rc != 0 )
+		goto free_out;
+	r->as[LPC_RING_CREATOR] = as;
+
+	/*
+	 * チャネル表に登録する
+	 */
+	spinlock_lock( &ring_db.lock );
+	id = ring_db.next_id++;
+	r->id = id;
+	res = RB_INSERT(lpc_ring_tree, &ring_db.head, r);
+	kassert( res == NULL );
+	spinlock_unlock( &ring_db.lock );
+
+	rc = vm_copy_out(as, idp, &id, sizeof(lpc_ring_id));
+	if ( rc < 0 ) {
+
+		lpc_ring_destroy(id);
+		return -EFAULT;
+	}
+
+	return 0;
+
+free_out:
+	lpc_ring_free(r);
+	return rc;
+}
+
+/** 生成済みのリングチャネルを自プロセスの仮想空間にマップする
+    @param[in] id    チャネルID
+    @param[in] addr  マップ先のアドレス(ページ境界)
+    @retval     0       正常にマップした
+    @retval    -EINVAL  アドレスの境界が不正
+    @retval    -ENOENT  チャネルが存在しない(接続中に破棄された場合を含む)
+    @retval    -EPERM   接続を許可されていないスレッドから呼び出した
+    @retval    -EBUSY   接続済み, またはマップ先の領域が使用中
+    @retval    -ENOMEM  メモリ不足
+ */
+int
+lpc_ring_attach(lpc_ring_id id, void *addr) {
+	int             rc;
+	bool          undo;
+	vm             *as;
+	vma          *vmap;
+	lpc_ring        *r;
+
+	as = &current->p->vm;
+	if ( as->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( !PAGE_ALIGNED( (uintptr_t)addr ) )
+		return -EINVAL;
+
+	r = lpc_ring_get(id);
+	if ( r == NULL )
+		return -ENOENT;
+
+	if ( r->peer != current->tid ) {
+
+		rc = -EPERM;
+		goto put_out;
+	}
+
+	spinlock_lock( &ring_db.lock );
+	if ( r->as[LPC_RING_PEER] != NULL ) {
+
+		spinlock_unlock( &ring_db.lock );
+		rc = -EBUSY;
+		goto put_out;
+	}
+	r->as[LPC_RING_PEER] = as;  /*  他の接続要求を排他する  */
+	spinlock_unlock( &ring_db.lock );
+
+	rc = lpc_ring_map(r, as, addr, &vmap);
+
+	/*
+	 * 接続中に破棄された場合はマップを取り消す
+	 */
+	undo = false;
+	spinlock_lock( &ring_db.lock );
+	if ( rc != 0 )
+		r->as[LPC_RING_PEER] = NULL;
+	else if ( r->dead ) {
+
+		undo = true;
+		rc = -ENOENT;
+	} else
+		r->vma[LPC_RING_PEER] = vmap;
+	spinlock_unlock( &ring_db.lock );
+
+	if ( undo )
+		vm_destroy_vma(vmap);
+
+put_out:
+	lpc_ring_put(r);
+
+	return rc;
+}
+
+/** リングの消費者を起床する(ドアベル)
+    @param[in] id    チャネルID
+    @param[in] ring  起床対象のリング(LPC_RING_SQ/LPC_RING_CQ)
+    @retval     0       正常に起床した
+    @retval    -EINVAL  リングの指定が不正
+    @retval    -ENOENT  チャネルが存在しない
+    @retval    -EPERM   チャネルをマップしていないプロセスから呼び出した
+    @note 生産者は消費者が待ち合わせ中の場合にのみ呼び出せばよい
+ */
+int
+lpc_ring_notify(lpc_ring_id id, int ring) {
+	int             rc;
+	lpc_ring        *r;
+	intrflags    flags;
+
+	if ( ( 0 > ring ) || ( ring >= LPC_RING_NR ) )
+		return -EINVAL;
+
+	r = lpc_ring_get(id);
+	if ( r == NULL )
+		return -ENOENT;
+
+	if ( !lpc_ring_is_mapped_by_self(r) ) {
+
+		rc = -EPERM;
+		goto put_out;
+	}
+
+	spinlock_lock_disable_intr( &r->lock, &flags );
+	sync_wake( &r->wait[ring], SYNC_WAI_RELEASED );
+	spinlock_unlock_restore_intr( &r->lock, &flags );
+
+	rc = 0;
+
+put_out:
+	lpc_ring_put(r);
+
+	return rc;
+}
+
+/** リングが空でなくなるまで待ち合わせる
+    @param[in] id    チャネルID
+    @param[in] ring  待ち合わせ対象のリング(LPC_RING_SQ/LPC_RING_CQ)
+    @param[in] tmout タイムアウト時間(単位:ms)
+    @retval     0          リングにエントリがある
+    @retval    -EINVAL     リングの指定が不正
+    @retval    -ENOENT     チャネルが存在しないか破棄された
+    @retval    -EPERM      チャネルをマップしていないプロセスから呼び出した
+    @retval    -EAGAIN     リングが空だった(ポーリング時)
+    @retval    -ETIMEDOUT  タイムアウトした
+    @retval    -EINTR      イベントを受信した
+    @note 待ち合わせ中フラグの設定後に再度リングを確認することで,
+    生産者のドアベルを取りこぼさないようにする.
+ */
+int
+lpc_ring_wait(lpc_ring_id id, int ring, lpc_tmout tmout) {
+	int             rc;
+	lpc_ring        *r;
+	lpc_ring_idx  *idx;
+	sync_reason    res;
+	intrflags    flags;
+
+	if ( ( 0 > ring ) || ( ring >= LPC_RING_NR ) )
+		return -EINVAL;
+
+	r = lpc_ring_get(id);
+	if ( r == NULL )
+		return -ENOENT;
+
+	if ( !lpc_ring_is_mapped_by_self(r) ) {
+
+		rc = -EPERM;
+		goto put_out;
+	}
+
+	idx = &( (lpc_ring_ctrl *)r->pages[0] )->idx[ring];
+
+	spinlock_lock_disable_intr( &r->lock, &flags );
+
+	while( 1 ) {
+
+		idx->waiting = 1;
+		__sync_synchronize();  /*  生産者のtail更新と順序付ける  */
+
+		if ( idx->head != idx->tail ) {
+
+			rc = 0;
+			break;
+		}
+
+		if ( r->dead ) {
+
+			rc = -ENOENT;
+			break;
+		}
+
+		if ( tmout == 0 ) {
+
+			rc = -EAGAIN;
+			break;
+		}
+
+		if ( tmout < 0 )
+			res = sync_wait( &r->wait[ring], &r->lock );
+		else
+			res = tim_wait_obj( &r->wait[ring], tmout, &r->lock );
+
+		if ( res == SYNC_WAI_TIMEOUT ) {
+
+			rc = -ETIMEDOUT;
+			break;
+		}
+
+		if ( res == SYNC_OBJ_DESTROYED ) {
+
+			rc = -ENOENT;
+			break;
+		}
+
+		if ( res != SYNC_WAI_RELEASED ) {
+
+			rc = -EINTR;
+			break;
+		}
+	}
+
+	idx->waiting = 0;
+
+	spinlock_unlock_restore_intr( &r->lock, &flags );
+
+put_out:
+	lpc_ring_put(r);
+
+	return rc;
+}
+
+/** リングチャネルを破棄する
+    @param[in] id チャネルID
+    @retval     0       正常に破棄した
+    @retval    -ENOENT  チャネルが存在しない
+    @retval    -EPERM   チャネル生成者以外のプロセスから呼び出した
+    @note 両端の仮想空間からアンマップし, 待ち合わせ中の消費者を起床する.
+    アンマップが完了するまで接続先の仮想空間の破棄(lpc_ring_release_as)と
+    排他する.
+ */
+int
+lpc_ring_destroy(lpc_ring_id id) {
+	int            rc;
+	lpc_ring      key;
+	lpc_ring       *r;
+	vma     *vmas[LPC_RING_NR];
+	int             i;
+
+	key.id = id;
+
+	mutex_lock( &ring_db.unmap_mtx );
+	spinlock_lock( &ring_db.lock );
+
+	r = RB_FIND(lpc_ring_tree, &ring_db.head, &key);
+	if ( r == NULL ) {
+
+		rc = -ENOENT;
+		goto unlock_out;
+	}
+
+	if ( r->as[LPC_RING_CREATOR] != &current->p->vm ) {
+
+		rc = -EPERM;
+		goto unlock_out;
+	}
+
+	RB_REMOVE(lpc_ring_tree, &ring_db.head, r);
+	r->dead = true;
+	for( i = 0; LPC_RING_NR > i; ++i) {
+
+		vmas[i] = r->vma[i];
+		r->vma[i] = NULL;
+	}
+
+	spinlock_unlock( &ring_db.lock );
+
+	for( i = 0; LPC_RING_NR > i; ++i)
+		if ( vmas[i] != NULL )
+			vm_destroy_vma(vmas[i]);
+
+	mutex_unlock( &ring_db.unmap_mtx );
+
+	lpc_ring_shutdown(r);
+
+	return 0;
+
+unlock_out:
+	spinlock_unlock( &ring_db.lock );
+	mutex_unlock( &ring_db.unmap_mtx );
+
+	return rc;
+}
+
+/** 破棄する仮想空間に関連するリングチャネルを解放する
+    @param[in] as 破棄する仮想空間
+    @note 仮想空間の破棄前に呼び出す.
+    asが生成したチャネルは破棄し, asが接続したチャネルは接続を解除する
+    (asの仮想アドレス領域は仮想空間の破棄時に解放される).
+    スリープ可能なロックを獲得するため, スピンロックを保持せずに呼び出す.
+ */
+void
+lpc_ring_release_as(vm *as) {
+	queue          delq;
+	lpc_ring   *r, *next;
+	vma         *peer_vma;
+
+	kassert( as != NULL );
+
+	queue_init( &delq );
+
+	mutex_lock( &ring_db.unmap_mtx );  /*  他プロセスからのアンマップと排他  */
+	spinlock_lock( &ring_db.lock );
+
+	for( r = RB_MIN(lpc_ring_tree, &ring_db.head); r != NULL; r = next) {
+
+		next = RB_NEXT(lpc_ring_tree, &ring_db.head, r);
+
+		if ( r->as[LPC_RING_CREATOR] == as ) {
+
+			RB_REMOVE(lpc_ring_tree, &ring_db.head, r);
+			r->dead = true;
+			r->vma[LPC_RING_CREATOR] = NULL;
+			if ( r->as[LPC_RING_PEER] == as )
+				r->vma[LPC_RING_PEER] = NULL;
+			queue_add( &delq, &r->link );
+		} else if ( r->as[LPC_RING_PEER] == as ) {
+
+			r->as[LPC_RING_PEER] = NULL;
+			r->vma[LPC_RING_PEER] = NULL;
+		}
+	}
+
+	spinlock_unlock( &ring_db.lock );
+
+	/*
+	 * 他プロセスにマップされているチャネルをアンマップしてから解放する
+	 */
+	while( !queue_is_empty( &delq ) ) {
+
+		r = CONTAINER_OF(queue_get_top( &delq ), lpc_ring, link);
+
+		peer_vma = r->vma[LPC_RING_PEER];
+		r->vma[LPC_RING_PEER] = NULL;
+		if ( peer_vma != NULL )
+			vm_destroy_vma(peer_vma);
+
+		lpc_ring_shutdown(r);
+	}
+
+	mutex_unlock( &ring_db.unmap_mtx );
+}
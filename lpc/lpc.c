@@ -47,102 +47,499 @@ is_msg_queue_empty_nolock(msg_queue *que) {
 	return queue_is_empty( &que->que );
 }
 
+static int lpc_src_cmp(struct _msg *_a, struct _msg *_b);
+
+RB_GENERATE_STATIC(lpc_src_tree, _msg, snode, lpc_src_cmp);
+
+/** 送信元エンドポイントの比較関数
+    @param[in] a メッセージ1
+    @param[in] b メッセージ2
+    @retval 0  メッセージ1とメッセージ2の送信元が等しい
+    @retval 負 メッセージ1の送信元がメッセージ2の送信元より小さい
+    @retval 正 メッセージ1の送信元がメッセージ2の送信元より大きい
+ */
+static int
+lpc_src_cmp(struct _msg *a, struct _msg *b) {
+
+	if ( a->src < b->src )
+		return -1;
+
+	if ( a->src > b->src )
+		return 1;
+
+	return 0;
+}
+
+/** 多重待ち合わせ中のスレッドを起床する
+    @param[in] que 操作対象のメッセージキュー
+    @note メッセージキューのロックを獲得して呼び出す
+ */
+static void
+lpc_notify_watchers_nolock(msg_queue *que){
+	list          *li;
+	lpc_watch      *w;
+
+	kassert( spinlock_locked_by_self( &que->lock ) );
+
+	queue_for_each(li, &que->watchers) {
+
+		w = CONTAINER_OF(li, lpc_watch, link);
+		spinlock_lock( &w->waiter->lock );
+		w->waiter->fired = true;
+		sync_wake( &w->waiter->wait, SYNC_WAI_RELEASED );
+		spinlock_unlock( &w->waiter->lock );
+	}
+}
+
 /** メッセージをキューに追加する
     @param[in] que 追加対象のメッセージキュー
     @param[in] m   追加対象のメッセージ
     @retval  0      正常に追加した
     @retval -EINVAL メッセージの状態が不正
+    @note キューは送信者の優先度の降順に並べ, 同一優先度内では到着順とする
  */
 static int
 lpc_msg_add_nolock(msg_queue *que, msg *m){
-	intrflags flags;
+	msg          *h;
+	list        *li;
 
 	kassert( que != NULL );
 	kassert( m != NULL );
 	kassert( spinlock_locked_by_self( &que->lock ) );
+	kassert( list_not_linked( &m->slink ) );
+	kassert( !( m->flags & LPC_MSG_FLAG_SRC_HEAD ) );
+
+	/*
+	 * 送信者の優先度の降順に並べる(同一優先度内では到着順)
+	 * 末尾から, 追加するメッセージ以上の優先度のメッセージを探して
+	 * その直後に挿入する
+	 */
+	queue_reverse_for_each(li, &que->que) {
 
-	hal_cpu_disable_interrupt( &flags );
-	queue_add( &que->que, &m->link);
+		if ( CONTAINER_OF(li, msg, link)->prio >= m->prio )
+			break;
+	}
+	queue_insert_after(li, &m->link);
 	m->qp = que;
-	hal_cpu_restore_interrupt( &flags );
+
+	h = RB_FIND(lpc_src_tree, &que->srcidx, m);
+	if ( h == NULL ) {  /*  送信元の先頭メッセージとして索引に登録  */
+
+		m->flags |= LPC_MSG_FLAG_SRC_HEAD;
+		RB_INSERT(lpc_src_tree, &que->srcidx, m);
+	} else  /*  同一送信元の環状リストの末尾(先頭の直前)に追加  */
+		queue_insert_before(&h->slink, &m->slink);
+
+	lpc_notify_watchers_nolock(que);  /*  多重待ち合わせ中のスレッドを起床  */
 	
 	return 0;
 }
 
-/** メッセージ用のメモリを獲得する
-    @param[in] mp       メッセージ領域のアドレスを格納するポインタ変数のアドレス
-    @param[in] pgflags  メモリ獲得方針
-    @retval    0        正常に獲得できた
-    @retval   -ENOMEM   メモリ獲得に失敗した
+/** 受信した要求の送信者の優先度で自スレッドを動作させる
+    @param[in] prio 要求の送信者の優先度
+    @note 送信者の優先度が静的優先度より低い場合も送信者の優先度に下げて
+    処理し, 低優先度の要求の処理が高優先度のスレッドの実行を妨げないようにする.
+    応答を送信した時点(lpc_restore_prio)で静的優先度に戻す
  */
-static int
-lpc_msg_alloc(msg **mp, pgalloc_flags pgflags) {
-	msg   *m;
+static void
+lpc_lend_prio(thr_prio prio) {
 
-	kassert( mp != NULL );
+	current->lpc_prio_lent = true;
+	sched_set_prio(current, prio);
+}
 
-	m = (msg *)kmalloc(sizeof(msg), pgflags);
-	if ( m == NULL ) 
-		return -ENOMEM;
+/** 要求元から借用した優先度を返却し, 静的優先度に戻す
+ */
+static void
+lpc_restore_prio(void) {
+
+	if ( !current->lpc_prio_lent )
+		return;
+
+	current->lpc_prio_lent = false;
+	sched_set_prio(current, current->base_prio);
+}
+
+/** メッセージをキューから取り除く
+    @param[in] que 操作対象のメッセージキュー
+    @param[in] m   取り除くメッセージ
+    @note 送信元の先頭メッセージを取り除いた場合は, 同一送信元の
+    次のメッセージを送信元索引に登録する
+ */
+static void
+lpc_msg_del_nolock(msg_queue *que, msg *m){
+	msg          *n;
+
+	kassert( que != NULL );
+	kassert( m != NULL );
+	kassert( spinlock_locked_by_self( &que->lock ) );
+
+	list_del( &m->link );
+
+	if ( !( m->flags & LPC_MSG_FLAG_SRC_HEAD ) ) {
+
+		kassert( !list_not_linked( &m->slink ) );
+		list_del( &m->slink );
+		return;
+	}
+
+	RB_REMOVE(lpc_src_tree, &que->srcidx, m);
+	m->flags &= ~LPC_MSG_FLAG_SRC_HEAD;
+
+	if ( list_not_linked( &m->slink ) )
+		return;  /*  同一送信元のメッセージがない  */
+
+	n = CONTAINER_OF(m->slink.next, struct _msg, slink);
+	list_del( &m->slink );
+	n->flags |= LPC_MSG_FLAG_SRC_HEAD;
+	RB_INSERT(lpc_src_tree, &que->srcidx, n);
+}
+
+/** 送信用メッセージスロットを初期化する
+    @param[in] m  初期化対象のメッセージスロット
+    @note 送信者はメッセージが受信されるかキューから取り外されるまで
+    lpc_sendから復帰しないため, メッセージはスレッド毎に1つ用意した
+    スロットを再利用する(送信時のメモリ獲得を行わない)
+ */
+void
+lpc_msg_slot_init(msg *m) {
+
+	kassert( m != NULL );
 
 	/*
 	 * リンク, 状態, 送信完了同期オブジェクトを初期化
 	 */
 	list_init( &m->link );
-	m->qp = NULL;
+	list_init( &m->slink );
 	sync_init_object( &m->completion, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT );
 	spinlock_init( &m->cqlock );
+	m->qp = NULL;
+	m->src = THR_INVALID_TID;
+	m->dest = THR_INVALID_TID;
+	m->flags = LPC_MSG_FLAG_NONE;
+	m->req_id = LPC_REQ_ID_NONE;
+	m->prio = THR_RR_PRIO;
+	m->status = 0;
+	m->actx = NULL;
+}
+
+/** メッセージの処理完了を送信者に通知する
+    @param[in] m      通知対象のメッセージ
+    @param[in] reason 起床要因
+    @note メッセージキューのロックを獲得して呼び出す.
+    送信完了待ちキューのロック下でキューイング先をクリアすることで
+    送信者にメッセージスロットの所有権を返却する.
+    配送結果(0: 受信された, -ENOENT: キューが破棄された)をメッセージに記録する.
+ */
+static void
+lpc_msg_complete_nolock(msg *m, sync_reason reason) {
+
+	kassert( m != NULL );
+	kassert( list_not_linked( &m->link ) );
+
+	spinlock_lock( &m->cqlock );
+	m->status = ( reason == SYNC_OBJ_DESTROYED ) ? ( -ENOENT ) : ( 0 );
+	m->qp = NULL;
+	sync_wake( &m->completion, reason );
+	spinlock_unlock( &m->cqlock );
+}
+
+/** 非同期送信完了通知キューへの参照を解放する
+    @param[in] ctx 操作対象の完了通知キュー
+    @note 最後の参照を解放した場合は完了通知キューを解放する
+ */
+static void
+lpc_async_ctx_put(lpc_async_ctx *ctx) {
+	refcnt_val old;
+
+	kassert( ctx != NULL );
+
+	refcnt_put( &ctx->refs, &old );
+	if ( old == REFCNT_INITIAL_VAL ) {  /*  最終参照者  */
+
+		kassert( queue_is_empty( &ctx->cmpl ) );
+		kfree( ctx );
+	}
+}
+
+/** 自スレッドの非同期送信完了通知キューを得る
+    @param[out] ctxp 完了通知キューの返却先
+    @retval     0       正常に取得した
+    @retval    -ENOMEM  メモリ不足
+    @note 初回使用時に完了通知キューを割り当てる
+ */
+static int
+lpc_async_ctx_get_current(lpc_async_ctx **ctxp) {
+	lpc_async_ctx *ctx;
+
+	kassert( ctxp != NULL );
+
+	if ( current->lpc_async != NULL ) {
+
+		*ctxp = current->lpc_async;
+		return 0;
+	}
 
-	m->src = current->tid;  /*  送信元エンドポイントを自スレッドに設定  */
-	*mp = m;
+	ctx = kmalloc( sizeof(lpc_async_ctx), KMALLOC_NORMAL );
+	if ( ctx == NULL )
+		return -ENOMEM;
+
+	spinlock_init( &ctx->lock );
+	refcnt_init( &ctx->refs );  /*  所有スレッドからの参照  */
+	queue_init( &ctx->cmpl );
+	sync_init_object( &ctx->wait, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT);
+	ctx->next_id = LPC_REQ_ID_NONE + 1;
+	ctx->dead = false;
+
+	current->lpc_async = ctx;
+	*ctxp = ctx;
 
 	return 0;
 }
 
-/** メッセージ領域を開放する
-    @param[in] m 開放対象のメッセージ領域
+/** 非同期送信メッセージの配送結果を送信者に通知する
+    @param[in] m      通知対象のメッセージ
+    @param[in] status 配送結果(0: 受信された, 負: エラー番号)
+    @note メッセージキューのロックを解放してから呼び出す.
+    メッセージは送信時に参照を獲得した完了通知キューに移され, 
+    送信者が終了している場合は解放される. 完了通知キューへの参照は
+    本関数で解放する.
  */
 static void
-lpc_msg_free(msg *m) {
-	intrflags flags;
-	
-	if ( m == NULL )
-		return;
+lpc_async_post(msg *m, int status) {
+	intrflags       flags;
+	lpc_async_ctx    *ctx;
+
+	kassert( m != NULL );
+	kassert( m->flags & LPC_MSG_FLAG_ASYNC );
+	kassert( list_not_linked( &m->link ) );
+	kassert( m->actx != NULL );
+
+	m->status = status;
+	ctx = m->actx;
+	m->actx = NULL;
+
+	/*
+	 * 完了通知キューのロック下で送信者の終了を判定することで
+	 * 送信者の終了処理と競合しないようにする
+	 */
+	spinlock_lock_disable_intr( &ctx->lock, &flags );
+	if ( ctx->dead )
+		kfree(m);  /*  送信者が終了している  */
+	else {
+
+		queue_add( &ctx->cmpl, &m->link );
+		sync_wake( &ctx->wait, SYNC_WAI_RELEASED );
+	}
+	spinlock_unlock_restore_intr( &ctx->lock, &flags );
+
+	lpc_async_ctx_put(ctx);  /*  メッセージからの参照を解放  */
+}
+
+/** 送信先のメッセージキューをロックする
+    @param[in]  dest  送信先エンドポイント
+    @param[out] portp 送信先ポート返却先(スレッド宛の場合はNULLを返却)
+    @param[out] qp    送信先メッセージキュー返却先
+    @retval     0       正常にロックした
+    @retval    -ENOENT  送信先が存在しないまたはキューが破棄済み
+    @note ポート宛の場合はポートへの参照を獲得して返却する
+ */
+static int
+lpc_lock_dest_queue(endpoint dest, lpc_port **portp, msg_queue **qp) {
+	intrflags      flags;
+	thread          *thr;
+	lpc_port       *port;
+	msg_queue         *q;
+
+	kassert( portp != NULL );
+	kassert( qp != NULL );
+
+	port = lpc_port_get(dest);
+	if ( port != NULL ) {  /*  ポート宛  */
+
+		q = &port->mque;
+		spinlock_lock( &q->lock );
+	} else {  /*  スレッド宛  */
+
+		acquire_all_thread_lock( &flags );
+		thr = thr_find_thread_by_tid_nolock(dest);
+		if ( thr == NULL ) {
+
+			release_all_thread_lock(&flags);
+			return -ENOENT;  /*  宛先不明  */
+		}
+
+		q = &thr->mque;
+		spinlock_lock( &q->lock );
+		release_all_thread_lock(&flags);
+	}
+
+	if ( q->dead ) {
+
+		/*  参照獲得後にキューが破棄された  */
+		spinlock_unlock( &q->lock );
+		if ( port != NULL )
+			lpc_port_put(port);
+		return -ENOENT;
+	}
+
+	*portp = port;
+	*qp = q;
+
+	return 0;
+}
+
+/** キューにつながっているメッセージを取り消す
+    @param[in] q    メッセージキュー
+    @param[in] m    取り消し対象のメッセージ
+    @retval    0       取り消し前に受信された
+    @retval   -EINTR   送信を取り消した
+    @retval   -ENOENT  取り消し前にキューが破棄された
+    @note メッセージキューのロックを獲得して呼び出す
+ */
+static int
+lpc_cancel_queued_msg_nolock(msg_queue *q, msg *m) {
+
+	kassert( spinlock_locked_by_self( &q->lock ) );
+
+	/* 受信者とキュー破棄処理はメッセージの取り出しから送信者の起床までを
+	 * キューのロック下で行うため, キューにつながっていなければ
+	 * 配送結果が確定している
+	 */
+	if ( list_not_linked( &m->link ) ) {
+
+		kassert( m->qp == NULL );
+		return m->status;
+	}
+
+	lpc_msg_del_nolock(q, m);
+	lpc_msg_complete_nolock(m, SYNC_OBJ_DESTROYED);
+
+	return -EINTR;
+}
+
+/** 送信完了前に送信を取り消す
+    @param[in] dest 送信先エンドポイント
+    @param[in] port 送信先ポート(スレッド宛の場合はNULL)
+    @param[in] m    取り消し対象のメッセージ
+    @retval    0       取り消し前に受信された
+    @retval   -EINTR   送信を取り消した
+    @retval   -ENOENT  送信先が終了した
+    @note キューイング先はキューのロック下でのみ参照する
+ */
+static int
+lpc_cancel_send(endpoint dest, lpc_port *port, msg *m) {
+	int               rc;
+	intrflags      flags;
+	thread          *thr;
+	msg_queue         *q;
+
+	if ( port != NULL ) {
+
+		/*
+		 * ポートは送信者が参照を獲得しているため, 
+		 * キューを直接参照できる
+		 */
+		q = &port->mque;
+		spinlock_lock( &q->lock );
+		rc = lpc_cancel_queued_msg_nolock(q, m);
+		spinlock_unlock( &q->lock );
+
+		return rc;
+	}
+
+	acquire_all_thread_lock( &flags );
+	thr = thr_find_thread_by_tid_nolock(dest);
+	if ( thr != NULL ) {
+
+		q = &thr->mque;
+		spinlock_lock( &q->lock );
+		release_all_thread_lock(&flags);
+
+		/*
+		 * キューイング先はキューのロック下で更新されるため, 
+		 * ロック獲得後に送信先のキューにつながっているかを判定する
+		 * (スレッドIDが再利用された場合は別のキューとなる)
+		 */
+		if ( m->qp == q ) {
+
+			rc = lpc_cancel_queued_msg_nolock(q, m);
+			spinlock_unlock( &q->lock );
+
+			return rc;
+		}
+		spinlock_unlock( &q->lock );
+	} else
+		release_all_thread_lock(&flags);
 
-	spinlock_lock_disable_intr( &m->cqlock, &flags);
-	sync_wake( &m->completion, SYNC_OBJ_DESTROYED);
-	spinlock_unlock_restore_intr( &m->cqlock, &flags);
+	/* 
+	 * 送信先スレッドが終了処理中の場合は, メッセージキューの破棄によって
+	 * メッセージが取り外されるのを送信完了待ちオブジェクトで待ち合わせる
+	 */
+	spinlock_lock( &m->cqlock );
+	while( m->qp != NULL )
+		sync_wait( &m->completion, &m->cqlock );
+	rc = m->status;
+	spinlock_unlock( &m->cqlock );
 
-	kfree( m );
+	return rc;
 }
 
 /** メッセージを取り出す
-    @param[in] src   送信元エンドポイント
+    @param[in] src    送信元エンドポイント
+    @param[in] accept 受信するメッセージ種別
     @param[in] mque   メッセージキュー
     @return 非NULL 受信可能な最初のメッセージ
     @return NULL   受信可能なメッセージがない
  */
 static msg *
-dequeue_message_nolock(endpoint src, msg_queue *mque) {
+dequeue_message_nolock(endpoint src, lpc_msg_type accept, msg_queue *mque) {
 	list *li, *next;
-	msg *m;
+	msg *m, *h;
+	msg     key;
 
 	kassert( mque != NULL );
 	kassert( spinlock_locked_by_self( &mque->lock ) );	
 
-	for ( li = queue_ref_top( &mque->que );
-	      li != (list *)(&mque->que);
-	      li = next) {
+	if ( src == LPC_RECV_ANY ) {
 
-		next = li->next;
-		m = CONTAINER_OF(li, struct _msg, link);
-		if ( ( src == LPC_RECV_ANY ) || ( m->src == src ) ) {
-			
-			list_del(li);  /*  メッセージを取り出す  */
-			return m;
+		/*  到着順に受信可能なメッセージを探す  */
+		for ( li = queue_ref_top( &mque->que );
+		      li != (list *)(&mque->que);
+		      li = next) {
+
+			next = li->next;
+			m = CONTAINER_OF(li, struct _msg, link);
+			if ( m->type & accept ) {
+
+				lpc_msg_del_nolock(mque, m);  /*  メッセージを取り出す  */
+				return m;
+			}
 		}
+
+		return NULL;
 	}
 
+	/*
+	 * 送信元索引から送信元の先頭メッセージを得て, 
+	 * 同一送信元のメッセージを到着順に探す
+	 */
+	key.src = src;
+	h = RB_FIND(lpc_src_tree, &mque->srcidx, &key);
+	if ( h == NULL )
+		return NULL;
+
+	m = h;
+	do{
+
+		if ( m->type & accept ) {
+
+			lpc_msg_del_nolock(mque, m);  /*  メッセージを取り出す  */
+			return m;
+		}
+		m = CONTAINER_OF(m->slink.next, struct _msg, slink);
+	}while( m != h );
+
 	return NULL;
 }
 
@@ -158,6 +555,11 @@ lpc_msg_queue_init(msg_queue *que) {
 	queue_init( &que->que );
 	sync_init_object( &que->wait_sender, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT);
 	sync_init_object( &que->wait_reciever, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT);
+	que->nr_async = 0;
+	que->async_limit = LPC_ASYNC_DEFAULT_DEPTH;
+	RB_INIT( &que->srcidx );
+	queue_init( &que->watchers );
+	que->dead = false;
 }
 
 /** メッセージキューを破棄する
@@ -169,10 +571,13 @@ lpc_destroy_msg_queue(msg_queue *que) {
 	list        *li;
 	list      *next;
 	msg          *m;
+	queue     async;
 
 	kassert( que != NULL );
 	kassert( !check_recursive_locked( &que->lock ) );
 
+	queue_init( &async );
+
 	spinlock_lock_disable_intr( &que->lock, &flags);
 	for( li = queue_ref_top(&que->que);
 	     li != (list *)&que->que;
@@ -180,69 +585,122 @@ lpc_destroy_msg_queue(msg_queue *que) {
 
 		next = li->next;
 
-		list_del(li);  /*  メッセージを取り出す  */
 		m = CONTAINER_OF(li, struct _msg, link);
-		lpc_msg_free(m); /* メッセージを開放する  */
+		lpc_msg_del_nolock(que, m);  /*  メッセージを取り出す  */
+		if ( m->flags & LPC_MSG_FLAG_ASYNC ) {
+
+			m->qp = NULL;
+			queue_add( &async, &m->link );  /* ロック解放後に通知する */
+			continue;
+		}
+		lpc_msg_complete_nolock(m, SYNC_OBJ_DESTROYED); /* 送信者に破棄を通知する  */
 	}
-	sync_wake( &que->wait_reciever, SYNC_OBJ_DESTROYED ); /* メッセージキュー消滅を通知 */
-	sync_wake( &que->wait_sender, SYNC_OBJ_DESTROYED );  /* メッセージキュー消滅を通知 */
+	que->nr_async = 0;
+	que->dead = true;
+	lpc_notify_watchers_nolock(que);  /*  多重待ち合わせ中のスレッドに通知  */
+	/*
+	 * メッセージキュー消滅を通知
+	 * 起床方針によらず全ての待ちスレッドを起床する
+	 */
+	while( !queue_is_empty( &que->wait_reciever.que ) )
+		sync_wake( &que->wait_reciever, SYNC_OBJ_DESTROYED );
+	while( !queue_is_empty( &que->wait_sender.que ) )
+		sync_wake( &que->wait_sender, SYNC_OBJ_DESTROYED );
 	spinlock_unlock_restore_intr( &que->lock, &flags);
+
+	/*  非同期送信者に破棄を通知する  */
+	while( !queue_is_empty( &async ) ) {
+
+		m = CONTAINER_OF(queue_get_top( &async ), struct _msg, link);
+		lpc_async_post(m, -ENOENT);
+	}
 }
 
 
-/** メッセージを送信する
+/** メッセージを送信する(共通処理)
     @param[in] dest  送信先エンドポイント
     @param[in] tmout タイムアウト時間(単位:ms)
-    @param[in] m     送信電文
+    @param[in] type  メッセージ種別
+    @param[in] m     送信電文(短メッセージの場合はカーネル内のバッファ)
     @retval    0     正常に送信した
     @retval   -EINTR イベント割込み
     @note 受信側が送信待ちキューで待機するまでメッセージの書き込みを待ち合わせ、
     電文を登録してから送信待ちキューを起床することで受信側が起床したときには
     メッセージが存在することを保証する
+    @note 電文は自スレッドの送信用メッセージスロットに格納するため, 
+    送信時にメモリ獲得を行わない
  */
-int
-lpc_send(endpoint dest, lpc_tmout tmout, void *m){
+static int
+lpc_send_common(endpoint dest, lpc_tmout tmout, lpc_msg_type type, void *m){
 	int               rc;
 	intrflags      flags;
 	thread          *thr;
+	lpc_port       *port;
 	msg_queue         *q;
 	msg         *new_msg;
 	sync_reason      res;
+	bool         replied;
 
 	kassert( m != NULL );
 
-	acquire_all_thread_lock( &flags );
-	thr = thr_find_thread_by_tid_nolock(dest);
-	if ( thr == NULL ) {
-
-		release_all_thread_lock(&flags);
-		return -ENOENT;  /*  宛先不明  */
+	new_msg = &current->lpc_slot;
+	kassert( new_msg->qp == NULL );
+	kassert( list_not_linked( &new_msg->link ) );
+
+	new_msg->src = current->tid;  /*  送信元エンドポイントを自スレッドに設定  */
+	new_msg->req_id = LPC_REQ_ID_NONE;
+	new_msg->prio = current->prio;
+	replied = false;
+	if ( current->lpc_reply_client == dest ) {
+
+		/* 受信した要求への応答には要求IDを引き継ぐ.
+		 * ポート経由で受信した要求への応答は, 
+		 * ポートを送信元エンドポイントとする
+		 */
+		if ( current->lpc_reply_port != LPC_PORT_ANY )
+			new_msg->src = current->lpc_reply_port;
+		new_msg->req_id = current->lpc_reply_req;
+		current->lpc_reply_port = LPC_PORT_ANY;
+		current->lpc_reply_client = THR_INVALID_TID;
+		current->lpc_reply_req = LPC_REQ_ID_NONE;
+		replied = true;
 	}
+	new_msg->dest = dest;
+	new_msg->type = type;
 
-	q = &thr->mque;
-
-	rc = lpc_msg_alloc(&new_msg, KMALLOC_NORMAL );
-	if ( rc != 0 )  { /*  メモリ獲得失敗  */
+	/*  
+	 * メッセージを複写する
+	 * 送信用メッセージスロットは自スレッド専用であるため, 
+	 * キューのロックを獲得する前に複写しておく
+	 */
+	if ( type == LPC_MSG_TYPE_SHORT )  /* 短メッセージはカーネル内から複写 */
+		memcpy(&new_msg->body.short_msg, m, sizeof(lpc_short_msg));
+	else {  /* 通常メッセージはユーザ空間から複写 */
 
-		release_all_thread_lock(&flags);
-		return rc;
+		rc = vm_copy_in(&current->p->vm, &new_msg->body, m, sizeof(msg_body));
+		if ( rc == -EFAULT )
+			goto restore_out;
 	}
 
+	rc = lpc_lock_dest_queue(dest, &port, &q);
+	if ( rc != 0 )
+		goto restore_out;  /*  宛先不明  */
+
 	/*
-	 * 送信待ちスレッドがいない場合は, 受信側スレッドを待ち合わせる
+	 * 送信待ちスレッドも多重待ち合わせ中のスレッドもいない場合は, 
+	 * 受信側スレッドを待ち合わせる
 	 */
-	spinlock_lock( &q->lock );
-	release_all_thread_lock(&flags);
 
-	while( queue_is_empty( &q->wait_sender.que ) ){
+	while( queue_is_empty( &q->wait_sender.que ) && 
+	    queue_is_empty( &q->watchers ) ){
 		
 		if ( tmout == 0 ) {
 			
 			/* ノンブロッキング送信
-			 * 受信者がいない場合は, ロック, メモリを解放して抜ける
+			 * 受信者がいない場合は, ロックを解放して抜ける
 			 */
 			rc = -EAGAIN;
-			goto msg_free_out;
+			goto unlock_out;
 		} else if ( tmout < 0 ) {
 
 			/* ブロッキング送信
@@ -252,18 +710,18 @@ lpc_send(endpoint dest, lpc_tmout tmout, void *m){
 			if ( res == SYNC_OBJ_DESTROYED ) {
 
                                 /*  スレッド破棄に伴ってキューが消失
-				 *  したためメモリだけ解放して抜ける
+				 *  したため抜ける
 				 */
 				rc = -ENOENT;
-				goto msg_free_out;
+				goto unlock_out;
 			}
 
 			if ( res == SYNC_WAI_DELIVEV ) {
 
-                                /*  イベント受信時は, メモリを解放して抜ける
+                                /*  イベント受信時は, ロックを解放して抜ける
 				 */
 				rc = -EINTR;
-				goto msg_free_out;
+				goto unlock_out;
 			}
 		} else {
 			
@@ -275,26 +733,26 @@ lpc_send(endpoint dest, lpc_tmout tmout, void *m){
 			if ( res == SYNC_OBJ_DESTROYED ) {
 
                                 /*  スレッド破棄に伴ってキューが消失
-				 *  するためメモリだけ解放して抜ける
+				 *  するため抜ける
 				 */
 				rc = -ENOENT;
-				goto msg_free_out;
+				goto unlock_out;
 			}
 
 			if ( res == SYNC_WAI_TIMEOUT ) {
 
-                                /*  タイムアウト時は, メモリを解放して抜ける
+                                /*  タイムアウト時は, ロックを解放して抜ける
 				 */
 				rc = -EAGAIN;
-				goto msg_free_out;
+				goto unlock_out;
 			}
 
 			if ( res == SYNC_WAI_DELIVEV ) {
 
-                                /*  イベント受信時は, メモリを解放して抜ける
+                                /*  イベント受信時は, ロックを解放して抜ける
 				 */
 				rc = -EINTR;
-				goto msg_free_out;
+				goto unlock_out;
 			}
 
 			/* 待ち中は, 全スレッドロックを取っていないので, 
@@ -302,44 +760,49 @@ lpc_send(endpoint dest, lpc_tmout tmout, void *m){
 			 * 送信先スレッド消失は, 上記のオブジェクト破棄
 			 * で通知されるはずなのでアサーションとして扱う。
 			 */
-			acquire_all_thread_lock( &flags );
-			thr = thr_find_thread_by_tid_nolock(dest);
-			release_all_thread_lock(&flags);
-			kassert ( thr != NULL );
+			if ( port == NULL ) {
+
+				acquire_all_thread_lock( &flags );
+				thr = thr_find_thread_by_tid_nolock(dest);
+				release_all_thread_lock(&flags);
+				kassert ( thr != NULL );
+			}
 		}
 	}
 
 	kassert( spinlock_locked_by_self( &q->lock ) );
 	kassert( !all_thread_locked_by_self() );
 
-	/*  メッセージをユーザ空間からコピーする  */
-	rc = vm_copy_in(&current->p->vm, &new_msg->body, m, sizeof(msg_body));
-	if ( rc == -EFAULT )
-		goto unlock_out;
-
 	lpc_msg_add_nolock(q, new_msg);  /*  メッセージキューに追加  */
 
-	spinlock_unlock(&q->lock);        /* キューロックを開放  */
-
         /*
 	 *  送信完了待ち
 	 */
 	spinlock_lock(&new_msg->cqlock);  /* 受信者が起床処理を待ち合わせるように
 					   *  送信完了待ちキューをロック
 					   */
-	sync_wake( &q->wait_sender, SYNC_WAI_RELEASED);  /*  送信待ち受信者を起床  */
-	/*  送信完了待ち同期オブジェクトでの休眠  */
-	res = sync_wait(&new_msg->completion, &new_msg->cqlock);
+	spinlock_unlock(&q->lock);        /* キューロックを開放  */
 
-	spinlock_unlock(&new_msg->cqlock);  /* 送信完了待ちキューをアンロック */
+	/*  
+	 *  送信待ち受信者を起床し, 受信者に直接CPUを引き渡して
+	 *  送信完了待ち同期オブジェクトで休眠する.
+	 *  受信者またはキュー破棄処理がメッセージスロットを返却するまで待ち合わせる
+	 */
+	res = sync_wake_and_wait(&q->wait_sender, &new_msg->completion, 
+	    &new_msg->cqlock);
+	while( ( res != SYNC_WAI_DELIVEV ) && ( new_msg->qp != NULL ) )
+		res = sync_wait(&new_msg->completion, &new_msg->cqlock);
 
-	if ( res == SYNC_OBJ_DESTROYED )   /* メッセージ破棄による起床  */
-		return  -ENOENT;
+	spinlock_unlock(&new_msg->cqlock);  /* 送信完了待ちキューをアンロック */
 
-	if ( res == SYNC_WAI_DELIVEV )
-		return -EINTR;  /*  イベント受信による起床  */
+	if ( res == SYNC_WAI_DELIVEV )  /* イベント受信による起床  */
+		rc = lpc_cancel_send(dest, port, new_msg);
+	else if ( res == SYNC_OBJ_DESTROYED )   /* メッセージ破棄による起床  */
+		rc = -ENOENT;
+	else
+		rc = 0;
 
-	return 0;
+	goto put_out;
 
 unlock_out:
 	kassert( spinlock_locked_by_self( &q->lock ) );
@@ -347,43 +810,50 @@ unlock_out:
 
 	spinlock_unlock( &q->lock );
 
-	return rc;
-
-msg_free_out:
-	kassert( spinlock_locked_by_self( &q->lock ) );
-	kassert( !all_thread_locked_by_self() );
+put_out:
+	if ( port != NULL )
+		lpc_port_put(port);  /*  ポートへの参照を解放  */
 
-	lpc_msg_free(new_msg);
-	spinlock_unlock( &q->lock );
+restore_out:
+	if ( replied )
+		lpc_restore_prio();  /*  応答を終えたので静的優先度に戻す  */
 
 	return rc;
 }
 
-/** メッセージを受信する
-    @param[in]     src     送信元エンドポイント
-    @param[in]     tmout   タイムアウト時間(単位:ms)
-    @param[in]     m       受信電文格納先
-    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
-    @retval    0       正常に受信した
+/** メッセージの到着を待ち合わせて取り出す
+    @param[in]  q      受信するメッセージキュー
+    @param[in]  src    送信元エンドポイント
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[in]  accept 受信するメッセージ種別
+    @param[out] rmsgp  取り出したメッセージの格納先
+    @retval    0       メッセージを取り出した
     @retval   -EAGAIN  電文がなかった
-    @note 
+    @retval   -EINTR   イベントを受信した
+    @retval   -ENOENT  ポートが破棄された
+    @note メッセージキューのロックを獲得して呼び出す. 
+    待ち合わせ中はロックを解放し, ロックを獲得した状態で復帰する.
  */
-int
-lpc_recv(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src){
+static int
+lpc_wait_msg_nolock(msg_queue *q, endpoint src, lpc_tmout tmout, lpc_msg_type accept,
+    msg **rmsgp){
 	int               rc;
-	intrflags      flags;
 	msg            *rmsg;
 	sync_reason      res;
 
-	spinlock_lock_disable_intr( &current->mque.lock, &flags);
+	kassert( spinlock_locked_by_self( &q->lock ) );
+	kassert( rmsgp != NULL );
 
 	while(1) {
 
-		/*  送信者を起床  */
-		sync_wake( &current->mque.wait_reciever, SYNC_WAI_RELEASED ); 
+		if ( q->dead ) {
+
+			rc = -ENOENT;  /*  ポートが破棄された  */
+			goto error_out;
+		}
 
 		/*  キューからメッセージを取り出す  */		
-		rmsg = dequeue_message_nolock(src, &current->mque);
+		rmsg = dequeue_message_nolock(src, accept, q);
 		if ( rmsg != NULL )
 			break;
 
@@ -392,64 +862,147 @@ lpc_recv(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src){
 			/* ノンブロッキング受信
 			 * 受信可能なメッセージがない場合は, エラー復帰
 			 */
+			sync_wake( &q->wait_reciever, SYNC_WAI_RELEASED ); 
 			rc = -EAGAIN;
-			goto unlock_out;
+			goto error_out;
 		} else if ( tmout < 0 ) {
 			
 			/* ブロッキング受信
+			 * 受信者待ちの送信者を起床して直接CPUを引き渡し, 
 			 * 送信者待ち同期オブジェクトで休眠
 			 */
-			res = sync_wait( &current->mque.wait_sender, 
-			    &current->mque.lock );
-			/*  自スレッドのキューであるためオブジェクト破壊
+			res = sync_wake_and_wait( &q->wait_reciever,
+			    &q->wait_sender, &q->lock );
+			/*  自スレッドのキューであればオブジェクト破壊
 			 *  で返ることはないためアサーションを先に判定
 			 */
-			kassert( res != SYNC_OBJ_DESTROYED );
-                         /* メッセージキュー破棄による復帰  */
+			kassert( ( q != &current->mque ) || 
+			    ( res != SYNC_OBJ_DESTROYED ) );
+                         /* ポート破棄による復帰  */
 			if ( res == SYNC_OBJ_DESTROYED ) {
 
 				rc =  -ENOENT;
-				goto unlock_out;
+				goto error_out;
 			}
 			/*  イベント受信による復帰  */
 			if ( res == SYNC_WAI_DELIVEV ) {
 
 				rc = -EINTR;
-				goto unlock_out;
+				goto error_out;
 			}
 		} else {
 
 			/* タイムアウト付きのブロッキング受信
-			 * 送信者待ちとタイムアウトの2つの同期オブジェクトに
-			 * 対して休眠する
+			 * 送信者を起床し, 送信者待ちとタイムアウトの
+			 * 2つの同期オブジェクトに対して休眠する
 			 */
-			res = tim_wait_obj(&current->mque.wait_sender, tmout, 
-			    &current->mque.lock );
-			/*  自スレッドのキューであるためオブジェクト破壊
+			sync_wake( &q->wait_reciever, SYNC_WAI_RELEASED ); 
+			res = tim_wait_obj(&q->wait_sender, tmout, 
+			    &q->lock );
+			/*  自スレッドのキューであればオブジェクト破壊
 			 *  で返ることはない
 			 */
-			kassert( res != SYNC_OBJ_DESTROYED );
+			kassert( ( q != &current->mque ) || 
+			    ( res != SYNC_OBJ_DESTROYED ) );
+
+			if ( res == SYNC_OBJ_DESTROYED ) {
+
+				rc = -ENOENT;  /*  ポート破棄による復帰  */
+				goto error_out;
+			}
 
 			if ( res == SYNC_WAI_TIMEOUT ) {
 
 				rc = -EAGAIN;  /*  タイムアウトによる復帰  */
-				goto unlock_out;
+				goto error_out;
 			}
 			if ( res == SYNC_WAI_DELIVEV ) {
 
 				rc = -EINTR;  /*  イベント受信による復帰  */
-				goto unlock_out;
+				goto error_out;
 			}
 		}
 		
 	}
 
-	/*  メッセージをユーザ空間にコピーする  */	
-	rc = vm_copy_out(&current->p->vm, m, &rmsg->body, sizeof(msg_body));
-	if ( rc == -EFAULT )
-		goto wakeup_out;
+	*rmsgp = rmsg;
 
-	if ( msg_src != NULL ) {
+	return 0;
+
+error_out:
+	return rc;
+}
+
+/** メッセージを受信する(共通処理)
+    @param[in]     port    受信するポート(自スレッドのキューから受信する場合はNULL)
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     accept  受信するメッセージ種別
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @param[out]    typep   受信したメッセージの種別格納先
+    @param[out]    reqp    受信したメッセージの要求ID格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @note 
+ */
+static int
+lpc_recv_common(lpc_port *port, endpoint src, lpc_tmout tmout, lpc_msg_type accept, 
+    void *m, endpoint *msg_src, lpc_msg_type *typep, lpc_req_id *reqp){
+	int               rc;
+	intrflags      flags;
+	msg_queue         *q;
+	msg            *rmsg;
+	bool           async;
+
+	q = ( port != NULL ) ? ( &port->mque ) : ( &current->mque );
+
+	lpc_restore_prio();  /*  応答しなかった前回の要求の優先度を返却する  */
+
+	spinlock_lock_disable_intr( &q->lock, &flags);
+
+	rc = lpc_wait_msg_nolock(q, src, tmout, accept, &rmsg);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	async = ( ( rmsg->flags & LPC_MSG_FLAG_ASYNC ) != 0 );
+	if ( async ) {
+
+		kassert( q->nr_async > 0 );
+		--q->nr_async;  /*  送信クレジットを返却  */
+	}
+
+	/*
+	 * 応答時に要求IDを引き継ぐため, 応答先を記録する
+	 * ポート経由で受信した場合は, 応答時の送信元エンドポイントを
+	 * ポートにする
+	 */
+	current->lpc_reply_port = ( port != NULL ) ? ( port->id ) : ( LPC_PORT_ANY );
+	current->lpc_reply_client = rmsg->src;
+	current->lpc_reply_req = rmsg->req_id;
+	lpc_lend_prio(rmsg->prio);  /*  応答するまで要求元の優先度で処理する  */
+
+	if ( accept == LPC_MSG_TYPE_SHORT ) {
+
+		/*  短メッセージをカーネル内のバッファにコピーする  */
+		memcpy(m, &rmsg->body.short_msg, sizeof(lpc_short_msg));
+		if ( msg_src != NULL )
+			*msg_src = rmsg->src;
+		rc = 0;
+		goto wakeup_out;
+	}
+
+	/*  メッセージをユーザ空間にコピーする  */	
+	rc = vm_copy_out(&current->p->vm, m, &rmsg->body, 
+	    ( rmsg->type == LPC_MSG_TYPE_SHORT ) ? 
+	    ( sizeof(lpc_short_msg) ) : ( sizeof(msg_body) ) );
+	if ( rc == -EFAULT )
+		goto wakeup_out;
+
+	if ( typep != NULL )
+		*typep = rmsg->type;  /*  メッセージ種別を返却する  */
+
+	if ( msg_src != NULL ) {
 		
 		/*  送信者のスレッドIDを返却する  */	
 		rc = vm_copy_out(&current->p->vm, msg_src, &rmsg->src, sizeof(endpoint) );
@@ -457,22 +1010,182 @@ lpc_recv(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src){
 			goto wakeup_out;
 	}
 
+	if ( reqp != NULL ) {
+		
+		/*  要求IDを返却する  */	
+		rc = vm_copy_out(&current->p->vm, reqp, &rmsg->req_id, sizeof(lpc_req_id) );
+		if ( rc == -EFAULT )
+			goto wakeup_out;
+	}
+
 	rc = 0;
 
 wakeup_out:
+	if ( async ) {
+
+		/*
+		 * 非同期送信の場合は, ロック解放後に送信者の
+		 * 完了通知キューに配送結果を通知する
+		 */
+		spinlock_unlock_restore_intr( &q->lock, &flags);
+		lpc_async_post(rmsg, 0);
+		return rc;
+	}
+
 	/*
 	 *  送信完了待ち合わせ処理
 	 */
-	spinlock_lock( &rmsg->cqlock );
-	sync_wake( &rmsg->completion, SYNC_WAI_RELEASED );  /*  送信者を起床  */
-	spinlock_unlock( &rmsg->cqlock );
+	lpc_msg_complete_nolock(rmsg, SYNC_WAI_RELEASED);  /*  送信者を起床  */
 	
 unlock_out:
-	spinlock_unlock_restore_intr( &current->mque.lock, &flags);
+	spinlock_unlock_restore_intr( &q->lock, &flags);
 	
 	return rc;
 }
 
+/** メッセージを送信する
+    @param[in] dest  送信先エンドポイント
+    @param[in] tmout タイムアウト時間(単位:ms)
+    @param[in] m     送信電文
+    @retval    0     正常に送信した
+    @retval   -EINTR イベント割込み
+ */
+int
+lpc_send(endpoint dest, lpc_tmout tmout, void *m){
+
+	return lpc_send_common(dest, tmout, LPC_MSG_TYPE_NORMAL, m);
+}
+
+/** メッセージを受信する
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @retval   -EINTR   イベントを受信した
+    @retval   -EFAULT  受信電文格納先にアクセスできなかった
+    @note 通常メッセージだけを受信する
+ */
+int
+lpc_recv(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src){
+
+	return lpc_recv_common(NULL, src, tmout, LPC_MSG_TYPE_NORMAL, m, msg_src, 
+	    NULL, NULL);
+}
+
+/** 通常メッセージと短メッセージを受信する
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @param[out]    typep   受信したメッセージの種別格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @retval   -EINTR   イベントを受信した
+    @retval   -EFAULT  受信電文格納先にアクセスできなかった
+    @note 短メッセージを受け付けるカーネルサービスが使用する.
+    短メッセージを受信した場合は, m->short_msgにメッセージを格納する.
+ */
+int
+lpc_recv_msg(endpoint src, lpc_tmout tmout, msg_body *m, endpoint *msg_src,
+    lpc_msg_type *typep){
+
+	kassert( typep != NULL );
+
+	return lpc_recv_common(NULL, src, tmout, LPC_MSG_TYPE_ANY, m, msg_src, 
+	    typep, NULL);
+}
+
+/** 短メッセージを送信する
+    @param[in] dest  送信先エンドポイント
+    @param[in] tmout タイムアウト時間(単位:ms)
+    @param[in] sm    送信する短メッセージ(カーネル内のバッファ)
+    @retval    0     正常に送信した
+    @retval   -EINTR イベント割込み
+    @note 短メッセージは, lpc_recv_msg, lpc_recv_shortでのみ受信できる
+ */
+int
+lpc_send_short(endpoint dest, lpc_tmout tmout, lpc_short_msg *sm){
+
+	kassert( sm != NULL );
+
+	return lpc_send_common(dest, tmout, LPC_MSG_TYPE_SHORT, sm);
+}
+
+/** 短メッセージを受信する
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     sm      受信した短メッセージの格納先(カーネル内のバッファ)
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先(カーネル内)
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @retval   -EINTR   イベントを受信した
+ */
+int
+lpc_recv_short(endpoint src, lpc_tmout tmout, lpc_short_msg *sm, endpoint *msg_src){
+
+	kassert( sm != NULL );
+
+	return lpc_recv_common(NULL, src, tmout, LPC_MSG_TYPE_SHORT, sm, msg_src, 
+	    NULL, NULL);
+}
+
+/** 短メッセージを送信後短メッセージによるリプライを待ち合わせる
+    @param[in]     dest   送信先エンドポイント
+    @param[in,out] sm     送受信する短メッセージ(カーネル内のバッファ)
+    @retval    0      正常に受信した
+    @retval   -EINTR  イベント割込み
+    @retval   -ENOENT 送信先が存在しない
+ */
+int
+lpc_short_call(endpoint dest, lpc_short_msg *sm) {
+	int rc;
+
+	rc = lpc_send_short(dest, LPC_INFINITE, sm);
+	if ( rc != 0 )
+		return rc;
+
+	return lpc_recv_short(dest, LPC_INFINITE, sm, NULL);
+}
+
+/** ポートからメッセージを受信する
+    @param[in]     port    受信するポート
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @param[out]    typep   受信したメッセージの種別格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @retval   -EINTR   イベントを受信した
+    @retval   -EFAULT  受信電文格納先にアクセスできなかった
+    @retval   -ENOENT  ポートが存在しない(破棄された)
+    @note 複数のスレッドが同一のポートで受信待ちでき, 最初に起床した
+    スレッドが次のメッセージを受信する. 受信したメッセージの送信元への
+    次の送信はポートを送信元エンドポイントとして行う.
+    通常メッセージ, 短メッセージの双方を受信する(短メッセージはm->short_msgに格納).
+ */
+int
+lpc_port_recv_msg(endpoint port, endpoint src, lpc_tmout tmout, msg_body *m, 
+    endpoint *msg_src, lpc_msg_type *typep){
+	int           rc;
+	lpc_port  *portp;
+
+	kassert( typep != NULL );
+
+	portp = lpc_port_get(port);
+	if ( portp == NULL )
+		return -ENOENT;
+
+	rc = lpc_recv_common(portp, src, tmout, LPC_MSG_TYPE_ANY, m, msg_src, 
+	    typep, NULL);
+
+	lpc_port_put(portp);
+
+	return rc;
+}
+
 /** メッセージを送信し返信を待ち受ける
     @param[in] dest   送信先エンドポイント
     @param[in] m      受信電文格納先
@@ -495,3 +1208,576 @@ lpc_send_and_reply(endpoint dest, void *m) {
 
 	return 0;
 }
+
+/** 非同期送信完了通知キューを初期化する
+    @param[in] ctxp 初期化対象の完了通知キューへのポインタ
+    @note 完了通知キューは初回使用時に割り当てる
+ */
+void
+lpc_async_ctx_init(lpc_async_ctx **ctxp) {
+
+	kassert( ctxp != NULL );
+
+	*ctxp = NULL;
+}
+
+/** 非同期送信完了通知キューを破棄する
+    @param[in] ctxp 破棄対象の完了通知キューへのポインタ
+    @note 所有スレッドの終了処理から呼び出す. 以降, 完了通知は
+    キューにつながらずに解放される. 未完了の非同期送信メッセージが
+    残っている場合は, 最後のメッセージの配送時にキューを解放する.
+ */
+void
+lpc_async_ctx_destroy(lpc_async_ctx **ctxp) {
+	intrflags       flags;
+	lpc_async_ctx    *ctx;
+	msg                *m;
+
+	kassert( ctxp != NULL );
+
+	ctx = *ctxp;
+	if ( ctx == NULL )
+		return;  /*  非同期送信を使用していない  */
+
+	*ctxp = NULL;
+
+	spinlock_lock_disable_intr( &ctx->lock, &flags);
+	ctx->dead = true;
+	while( !queue_is_empty( &ctx->cmpl ) ) {
+
+		m = CONTAINER_OF(queue_get_top( &ctx->cmpl ), struct _msg, link);
+		kfree(m);  /*  未回収の完了通知を解放  */
+	}
+	spinlock_unlock_restore_intr( &ctx->lock, &flags);
+
+	lpc_async_ctx_put(ctx);  /*  所有スレッドからの参照を解放  */
+}
+
+/** メッセージを非同期に送信する
+    @param[in]  dest  送信先エンドポイント
+    @param[in]  m     送信電文
+    @param[out] idp   割り当てた要求ID格納先
+    @retval    0       送信先のキューに登録した
+    @retval   -EAGAIN  送信先のキューに空きがない(クレジットなし)
+    @retval   -ENOENT  送信先が存在しない
+    @retval   -ENOMEM  メモリ不足
+    @retval   -EFAULT  送信電文または要求ID格納先にアクセスできなかった
+    @note 受信者を待ち合わせずに送信先のキューに登録して復帰する.
+    送信先のキューに滞留できる非同期送信メッセージの数は送信先毎に
+    制限され, 受信されるとクレジットが返却される. 配送結果は
+    lpc_async_waitで要求IDと共に回収する. 
+ */
+int
+lpc_send_async(endpoint dest, void *m, lpc_req_id *idp) {
+	int               rc;
+	lpc_port       *port;
+	msg_queue         *q;
+	msg         *new_msg;
+	lpc_async_ctx   *ctx;
+
+	kassert( m != NULL );
+	kassert( idp != NULL );
+
+	rc = lpc_async_ctx_get_current(&ctx);
+	if ( rc != 0 )
+		return rc;
+
+	new_msg = kmalloc( sizeof(msg), KMALLOC_NORMAL );
+	if ( new_msg == NULL )
+		return -ENOMEM;
+
+	lpc_msg_slot_init(new_msg);
+	new_msg->src = current->tid;
+	new_msg->dest = dest;
+	new_msg->type = LPC_MSG_TYPE_NORMAL;
+	new_msg->flags = LPC_MSG_FLAG_ASYNC;
+	new_msg->prio = current->prio;
+	new_msg->req_id = ctx->next_id++;  /* 要求IDを割り当てる */
+
+	rc = vm_copy_in(&current->p->vm, &new_msg->body, m, sizeof(msg_body));
+	if ( rc < 0 )
+		goto free_out;
+
+	rc = vm_copy_out(&current->p->vm, idp, &new_msg->req_id, sizeof(lpc_req_id));
+	if ( rc < 0 )
+		goto free_out;
+
+	rc = lpc_lock_dest_queue(dest, &port, &q);
+	if ( rc != 0 )
+		goto free_out;  /*  宛先不明  */
+
+	if ( q->nr_async >= q->async_limit ) {
+
+		rc = -EAGAIN;  /*  クレジットがない  */
+		goto unlock_out;
+	}
+
+	++q->nr_async;  /*  クレジットを消費  */
+
+	/*  完了通知キューへの参照を獲得し, 配送結果の通知先とする  */
+	rc = refcnt_get( &ctx->refs, NULL );
+	kassert( rc == 0 );
+	new_msg->actx = ctx;
+
+	lpc_msg_add_nolock(q, new_msg);
+	sync_wake( &q->wait_sender, SYNC_WAI_RELEASED );  /*  受信者を起床  */
+
+	spinlock_unlock( &q->lock );
+
+	if ( port != NULL )
+		lpc_port_put(port);
+
+	return 0;
+
+unlock_out:
+	spinlock_unlock( &q->lock );
+
+	if ( port != NULL )
+		lpc_port_put(port);
+
+free_out:
+	kfree(new_msg);
+
+	return rc;
+}
+
+/** 非同期送信の配送結果を回収する
+    @param[in]  tmout    タイムアウト時間(単位:ms)
+    @param[out] idp      配送結果に対応する要求ID格納先
+    @param[out] statusp  配送結果格納先(0: 受信された, -ENOENT: 送信先が消滅した)
+    @retval    0          配送結果を回収した
+    @retval   -EAGAIN     回収可能な配送結果がない
+    @retval   -ETIMEDOUT  タイムアウトした
+    @retval   -EINTR      イベントを受信した
+    @retval   -EFAULT     格納先にアクセスできなかった
+    @retval   -ENOMEM     メモリ不足
+ */
+int
+lpc_async_wait(lpc_tmout tmout, lpc_req_id *idp, int *statusp) {
+	int               rc;
+	intrflags      flags;
+	lpc_async_ctx   *ctx;
+	msg               *m;
+	sync_reason      res;
+
+	kassert( idp != NULL );
+	kassert( statusp != NULL );
+
+	rc = lpc_async_ctx_get_current(&ctx);
+	if ( rc != 0 )
+		return rc;
+
+	spinlock_lock_disable_intr( &ctx->lock, &flags);
+	while( queue_is_empty( &ctx->cmpl ) ) {
+
+		if ( tmout == 0 ) {
+
+			rc = -EAGAIN;
+			goto unlock_out;
+		}
+
+		if ( tmout < 0 )
+			res = sync_wait( &ctx->wait, &ctx->lock );
+		else
+			res = tim_wait_obj( &ctx->wait, tmout, &ctx->lock );
+
+		if ( !queue_is_empty( &ctx->cmpl ) )
+			break;
+
+		if ( res == SYNC_WAI_TIMEOUT ) {
+
+			rc = -ETIMEDOUT;
+			goto unlock_out;
+		}
+
+		if ( res == SYNC_WAI_DELIVEV ) {
+
+			rc = -EINTR;
+			goto unlock_out;
+		}
+	}
+
+	m = CONTAINER_OF(queue_get_top( &ctx->cmpl ), struct _msg, link);
+	spinlock_unlock_restore_intr( &ctx->lock, &flags);
+
+	rc = vm_copy_out(&current->p->vm, idp, &m->req_id, sizeof(lpc_req_id));
+	if ( rc >= 0 )
+		rc = vm_copy_out(&current->p->vm, statusp, &m->status, sizeof(int));
+
+	kfree(m);
+
+	return ( rc < 0 ) ? ( rc ) : ( 0 );
+
+unlock_out:
+	spinlock_unlock_restore_intr( &ctx->lock, &flags);
+
+	return rc;
+}
+
+/** 要求IDと共にメッセージを受信する
+    @param[in]     src     送信元エンドポイント
+    @param[in]     tmout   タイムアウト時間(単位:ms)
+    @param[in]     m       受信電文格納先
+    @param[in,out] msg_src 受信したメッセージの送信元エンドポイント格納先
+    @param[out]    reqp    受信したメッセージの要求ID格納先
+    @retval    0       正常に受信した
+    @retval   -EAGAIN  電文がなかった
+    @note 応答メッセージの場合は, 応答対象の要求の要求IDを返却する
+    (非同期送信した要求と応答との対応付けに使用する).
+ */
+int
+lpc_recv_req(endpoint src, lpc_tmout tmout, void *m, endpoint *msg_src,
+    lpc_req_id *reqp){
+
+	kassert( reqp != NULL );
+
+	return lpc_recv_common(NULL, src, tmout, LPC_MSG_TYPE_NORMAL, m, msg_src, 
+	    NULL, reqp);
+}
+
+/** 非同期送信メッセージの最大滞留数を設定する
+    @param[in] ep    設定対象のエンドポイント(ポートまたは自スレッド)
+    @param[in] depth 最大滞留数
+    @retval    0       正常に設定した
+    @retval   -EINVAL  最大滞留数が不正
+    @retval   -EPERM   自スレッド以外のスレッドを指定した
+ */
+int
+lpc_set_async_depth(endpoint ep, obj_cnt_type depth) {
+	intrflags      flags;
+	lpc_port       *port;
+	msg_queue         *q;
+
+	if ( depth == 0 )
+		return -EINVAL;
+
+	port = lpc_port_get(ep);
+	if ( port != NULL )
+		q = &port->mque;
+	else if ( ep == current->tid )
+		q = &current->mque;
+	else
+		return -EPERM;
+
+	spinlock_lock_disable_intr( &q->lock, &flags);
+	q->async_limit = depth;  /*  滞留中のメッセージは受信されるまで保持  */
+	spinlock_unlock_restore_intr( &q->lock, &flags);
+
+	if ( port != NULL )
+		lpc_port_put(port);
+
+	return 0;
+}
+
+/** 複数のメッセージを一括して受信する
+    @param[in]  src   送信元エンドポイント
+    @param[in]  tmout 最初のメッセージを待ち合わせるタイムアウト時間(単位:ms)
+    @param[out] ents  受信したメッセージの格納先配列
+    @param[in]  nr    格納先配列の要素数
+    @return    正  受信したメッセージ数
+    @retval   -EINVAL  要素数が不正
+    @retval   -EAGAIN  電文がなかった
+    @retval   -EINTR   イベントを受信した
+    @retval   -EFAULT  格納先にアクセスできなかった
+    @note 最初のメッセージが到着するまで待ち合わせた後, キューに滞留している
+    通常メッセージを最大nr個まで一度のロック獲得で取り出し, 送信者を起床する.
+    応答はlpc_reply_batchで一括して行う.
+ */
+int
+lpc_recv_batch(endpoint src, lpc_tmout tmout, lpc_batch_ent *ents, int nr) {
+	int               rc;
+	int              cnt;
+	intrflags      flags;
+	msg_queue         *q;
+	msg            *rmsg;
+	queue          async;
+	lpc_batch_ent    ent;
+
+	if ( ( nr <= 0 ) || ( nr > LPC_BATCH_MAX_ENTRIES ) )
+		return -EINVAL;
+
+	q = &current->mque;
+	queue_init( &async );
+	cnt = 0;
+
+	/*  一括受信した要求への応答は, lpc_reply_batchで要求毎に行う  */
+	current->lpc_reply_port = LPC_PORT_ANY;
+	current->lpc_reply_client = THR_INVALID_TID;
+	current->lpc_reply_req = LPC_REQ_ID_NONE;
+	lpc_restore_prio();
+
+	spinlock_lock_disable_intr( &q->lock, &flags);
+
+	rc = lpc_wait_msg_nolock(q, src, tmout, LPC_MSG_TYPE_NORMAL, &rmsg);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	/*  
+	 * キューは優先度順に並んでいるため, 先頭の要求が一括受信した
+	 * 要求の中で最も高い優先度を持つ. lpc_reply_batchで応答するまで
+	 * その優先度で処理する.
+	 */
+	lpc_lend_prio(rmsg->prio);
+
+	do{
+
+		memset( &ent, 0, sizeof(lpc_batch_ent) );
+		ent.peer = rmsg->src;
+		ent.req_id = rmsg->req_id;
+		memcpy( &ent.body, &rmsg->body, sizeof(msg_body) );
+
+		rc = vm_copy_out(&current->p->vm, &ents[cnt], &ent, sizeof(lpc_batch_ent));
+		if ( rc >= 0 )
+			++cnt;
+
+		/*
+		 * 送信者を起床する
+		 * 非同期送信の場合はロック解放後に配送結果を通知する
+		 */
+		if ( rmsg->flags & LPC_MSG_FLAG_ASYNC ) {
+
+			kassert( q->nr_async > 0 );
+			--q->nr_async;  /*  送信クレジットを返却  */
+			rmsg->qp = NULL;
+			queue_add( &async, &rmsg->link );
+		} else 
+			lpc_msg_complete_nolock(rmsg, SYNC_WAI_RELEASED);
+
+		if ( rc < 0 )
+			break;  /*  格納先にアクセスできない  */
+
+		if ( cnt >= nr )
+			break;
+
+		rmsg = dequeue_message_nolock(src, LPC_MSG_TYPE_NORMAL, q);
+	} while( rmsg != NULL );
+
+unlock_out:
+	spinlock_unlock_restore_intr( &q->lock, &flags);
+
+	while( !queue_is_empty( &async ) ) {
+
+		rmsg = CONTAINER_OF(queue_get_top( &async ), struct _msg, link);
+		lpc_async_post(rmsg, 0);
+	}
+
+	if ( cnt > 0 )
+		return cnt;
+
+	return rc;
+}
+
+/** 一括受信したメッセージに一括して応答する
+    @param[in,out] ents  応答メッセージの配列(各エントリのrcに送信結果を返却)
+    @param[in]     nr    配列の要素数
+    @return    0以上   送信に成功した応答数
+    @retval   -EINVAL  要素数が不正
+    @retval   -EFAULT  配列にアクセスできなかった
+    @note 各応答には要求IDを引き継ぐ. 個々の応答の失敗は
+    エントリのrcに返却し, 残りの応答の送信を継続する.
+ */
+int
+lpc_reply_batch(lpc_batch_ent *ents, int nr) {
+	int               rc;
+	int               ok;
+	int                i;
+	lpc_batch_ent    ent;
+
+	if ( ( nr < 0 ) || ( nr > LPC_BATCH_MAX_ENTRIES ) )
+		return -EINVAL;
+
+	for( i = 0, ok = 0; nr > i; ++i) {
+
+		rc = vm_copy_in(&current->p->vm, &ent, &ents[i], 
+		    offsetof(lpc_batch_ent, body));
+		if ( rc < 0 )
+			goto fault_out;
+
+		/*  応答先と要求IDを応答コンテキストに設定して送信する  */
+		current->lpc_reply_port = LPC_PORT_ANY;
+		current->lpc_reply_client = ent.peer;
+		current->lpc_reply_req = ent.req_id;
+
+		ent.rc = lpc_send_common(ent.peer, LPC_INFINITE, LPC_MSG_TYPE_NORMAL, 
+		    &ents[i].body);
+		if ( ent.rc == 0 )
+			++ok;
+
+		rc = vm_copy_out(&current->p->vm, &ents[i].rc, &ent.rc, sizeof(int));
+		if ( rc < 0 )
+			goto fault_out;
+	}
+
+	lpc_restore_prio();  /*  静的優先度に戻す  */
+
+	return ok;
+
+fault_out:
+	lpc_restore_prio();
+
+	return -EFAULT;
+}
+
+/** 複数のエンドポイントとイベントを同時に待ち合わせる
+    @param[in]  eps    待ち合わせるエンドポイントの配列(ポートまたは自スレッド)
+    @param[in]  nr     配列の要素数
+    @param[in]  tmout  タイムアウト時間(単位:ms)
+    @param[out] readyp 受信可能なエンドポイントのビットマップ格納先
+                       (eps[i]が受信可能な場合ビットiをセット, イベント受信可能な
+                        場合LPC_WAIT_READY_EVENTをセット)
+    @return    正          受信可能な要因の数
+    @retval   -EINVAL      要素数またはエンドポイントが不正
+    @retval   -EFAULT      配列または格納先にアクセスできなかった
+    @retval   -EAGAIN      受信可能な要因がない(ノンブロック時)
+    @retval   -ETIMEDOUT   タイムアウトした
+    @note 各メッセージキューに監視者を登録した後, 単一の同期オブジェクトで
+    待ち合わせる. 受信可能となったエンドポイントからはlpc_recv等で受信する.
+    破棄されたポートは受信可能として通知する(受信時に-ENOENTとなる).
+ */
+int
+lpc_wait_any(endpoint *eps, int nr, lpc_tmout tmout, uint64_t *readyp) {
+	int                               rc;
+	int                                i;
+	int                              cnt;
+	bool                       timed_out;
+	intrflags                      flags;
+	uint64_t                       ready;
+	sync_reason                      res;
+	lpc_waiter                    waiter;
+	endpoint   kep[LPC_WAIT_MAX_ENDPOINTS];
+	lpc_port  *ports[LPC_WAIT_MAX_ENDPOINTS];
+	msg_queue    *qs[LPC_WAIT_MAX_ENDPOINTS];
+	lpc_watch  watch[LPC_WAIT_MAX_ENDPOINTS];
+
+	if ( ( nr < 0 ) || ( nr > LPC_WAIT_MAX_ENDPOINTS ) )
+		return -EINVAL;
+
+	rc = vm_copy_in(&current->p->vm, kep, eps, sizeof(endpoint) * nr);
+	if ( rc < 0 )
+		return -EFAULT;
+
+	/*
+	 * 待ち合わせ対象のメッセージキューを得る
+	 */
+	for( i = 0; nr > i; ++i) {
+
+		ports[i] = lpc_port_get(kep[i]);
+		if ( ports[i] != NULL )
+			qs[i] = &ports[i]->mque;
+		else if ( kep[i] == current->tid )
+			qs[i] = &current->mque;
+		else {
+
+			rc = -EINVAL;  /*  他スレッドのキューは待ち合わせられない  */
+			goto put_out;
+		}
+	}
+
+	spinlock_init( &waiter.lock );
+	sync_init_object( &waiter.wait, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT);
+	waiter.fired = false;
+
+	/*
+	 * 監視者を登録し, 受信者を待ち合わせている送信者を起床する
+	 */
+	for( i = 0; nr > i; ++i) {
+
+		list_init( &watch[i].link );
+		watch[i].waiter = &waiter;
+		spinlock_lock_disable_intr( &qs[i]->lock, &flags);
+		queue_add( &qs[i]->watchers, &watch[i].link );
+		sync_wake( &qs[i]->wait_reciever, SYNC_WAI_RELEASED ); 
+		spinlock_unlock_restore_intr( &qs[i]->lock, &flags);
+	}
+
+	timed_out = false;
+	while(1) {
+
+		spinlock_lock( &waiter.lock );
+		waiter.fired = false;  /*  以降の到着は休眠前に検出する  */
+		spinlock_unlock( &waiter.lock );
+
+		/*
+		 * 受信可能な要因を調べる
+		 */
+		ready = 0;
+		for( i = 0, cnt = 0; nr > i; ++i) {
+
+			spinlock_lock_disable_intr( &qs[i]->lock, &flags);
+			if ( ( !queue_is_empty( &qs[i]->que ) ) || ( qs[i]->dead ) ) {
+
+				ready |= ( 1ULL << i );
+				++cnt;
+			}
+			spinlock_unlock_restore_intr( &qs[i]->lock, &flags);
+		}
+
+		if ( ev_has_pending_events(current) ) {
+
+			ready |= LPC_WAIT_READY_EVENT;
+			++cnt;
+		}
+
+		if ( cnt > 0 ) {
+
+			rc = cnt;
+			break;
+		}
+
+		if ( tmout == 0 ) {
+
+			rc = -EAGAIN;
+			break;
+		}
+
+		if ( timed_out ) {
+
+			rc = -ETIMEDOUT;
+			break;
+		}
+
+		/*
+		 * 単一の同期オブジェクトで待ち合わせる
+		 */
+		spinlock_lock( &waiter.lock );
+		if ( !waiter.fired ) {
+
+			if ( tmout < 0 )
+				res = sync_wait( &waiter.wait, &waiter.lock );
+			else
+				res = tim_wait_obj( &waiter.wait, tmout, &waiter.lock );
+
+			if ( res == SYNC_WAI_TIMEOUT )
+				timed_out = true;  /*  最後に受信可能な要因を確認して抜ける  */
+		}
+		spinlock_unlock( &waiter.lock );
+	}
+
+	/*
+	 * 監視者の登録を解除する
+	 */
+	for( i = 0; nr > i; ++i) {
+
+		spinlock_lock_disable_intr( &qs[i]->lock, &flags);
+		list_del( &watch[i].link );
+		spinlock_unlock_restore_intr( &qs[i]->lock, &flags);
+	}
+
+	if ( rc > 0 ) {
+
+		if ( vm_copy_out(&current->p->vm, readyp, &ready, sizeof(uint64_t)) < 0 )
+			rc = -EFAULT;
+	}
+
+	i = nr;
+
+put_out:
+	while( i > 0 ) {
+
+		--i;
+		if ( ports[i] != NULL )
+			lpc_port_put(ports[i]);
+	}
+
+	return rc;
+}
@@ -28,7 +28,9 @@
 #include <kern/async-event.h>
 #include <kern/page.h>
 #include <kern/ctype.h>
-#include <kern/mutex.h>
+#include <kern/rwsem.h>
+#include <kern/lpc-ring.h>
+#include <kern/vm-grant.h>
 
 #include <proc/proc-internal.h>
 #include <vm/vm-internal.h>
@@ -95,7 +97,7 @@ alloc_process_stack(proc *p, size_t size){
 	/*
 	 * stack
 	 */
-	mutex_lock( &p->vm.asmtx );
+	rwsem_down_write( &p->vm.asmtx );
 	rc = vm_create_vma(&p->vm, 
 	    &p->stack, 
 	    (void *)(USER_STACK_BOTTOM - PAGE_SIZE),
@@ -118,7 +120,7 @@ alloc_process_stack(proc *p, size_t size){
 
 	rc = 0;
 
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 	return rc;
 
 unmap_stack_out:
@@ -128,7 +130,7 @@ unmap_stack_out:
 	p->stack = NULL;
 
 unlock_out:
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 	return rc;
 }
 
@@ -373,7 +375,7 @@ setup_heap_area(proc *p){
 	/*
 	 * heap
 	 */
-	mutex_lock( &p->vm.asmtx );
+	rwsem_down_write( &p->vm.asmtx );
 
 	rc = vm_create_vma(&p->vm, 
 	    &p->heap, 
@@ -382,7 +384,7 @@ setup_heap_area(proc *p){
 	    VMA_PROT_R | VMA_PROT_W,
 	    VMA_FLAG_HEAP);
 
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 
 	return rc;
 }
@@ -403,7 +405,7 @@ proc_expand_stack(proc *p, void *new_top){
 	kassert( p != NULL );
 	kassert( p->stack != NULL );
 
-	mutex_lock( &p->vm.asmtx );
+	rwsem_down_write( &p->vm.asmtx );
 
 	/*  アクセス可能な範囲にある場合は抜ける
 	 *   (スレッドスタックの場合に該当)
@@ -414,7 +416,7 @@ proc_expand_stack(proc *p, void *new_top){
 
 	rc = vm_resize_area(&p->vm, p->stack->start, new_top, &old_addr);
 unlock_out:
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 
 	return rc;
 }
@@ -437,7 +439,7 @@ proc_expand_heap(proc *p, void *new_heap_end, void **old_heap_endp) {
 	kassert( p->heap != NULL );
 	kassert( old_heap_endp != NULL );
 
-	mutex_lock( &p->vm.asmtx );
+	rwsem_down_write( &p->vm.asmtx );
 	if ( new_heap_end != NULL )
 		rc = vm_resize_area(&p->vm, p->heap->start, new_heap_end, &old_addr);
 	else {
@@ -445,12 +447,65 @@ proc_expand_heap(proc *p, void *new_heap_end, void **old_heap_endp) {
 		old_addr = p->heap->end;
 		rc = 0;
 	}
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 	if ( rc == 0 )
 		*old_heap_endp = old_addr;
 
 	return rc;
 }
+
+/** ヒープ範囲を増分指定で伸縮する
+        @param[in]  p              プロセス構造体
+        @param[in]  inc            ヒープ終端の増分(負の場合は縮小, 0の場合は伸縮しない)
+        @param[out] old_heap_endp  変更前のheapの最終位置返却アドレス
+	@retval    0               ヒープの更新に成功した
+	@retval   -EINVAL          ヒープの先頭より前に縮小しようとした
+	@retval   -EBUSY           他の領域と衝突する
+	@retval   -ENOMEM          メモリ不足
+	@note 現在の終端の取得と伸縮を仮想空間の1回のロック区間内で行う
+ */
+int
+proc_sbrk(proc *p, intptr_t inc, void **old_heap_endp) {
+	int        rc;
+	void *cur_end;
+	void *new_end;
+
+	kassert( p != NULL );
+	kassert( p->heap != NULL );
+	kassert( old_heap_endp != NULL );
+
+	rwsem_down_write( &p->vm.asmtx );
+
+	cur_end = p->heap->end;
+	if ( inc == 0 ) {
+
+		rc = 0;
+		goto success_out;
+	}
+
+	new_end = ( PAGE_ALIGNED( (uintptr_t)(cur_end + inc) ) ) ? 
+		( (void *)( cur_end + inc ) )  :
+		( (void *)PAGE_NEXT( (uintptr_t)(cur_end + inc) ) );
+
+	if ( new_end < p->heap->start ) {
+
+		rc = -EINVAL;
+		goto unlock_out;
+	}
+
+	rc = vm_resize_area(&p->vm, p->heap->start, new_end, &cur_end);
+	if ( rc != 0 )
+		goto unlock_out;
+
+success_out:
+	*old_heap_endp = cur_end;
+
+unlock_out:
+	rwsem_up_write( &p->vm.asmtx );
+
+	return rc;
+}
+
 /** プロセスの基本情報を初期化
     @param[in] p  操作対象のプロセス
  */
@@ -464,9 +519,11 @@ _proc_common_init(proc *p) {
 	queue_init( &p->threads );        /*  プロセスロックとスレッドキューを初期化 */
 	p->pid = THR_INVALID_TID;         /*  PIDを一時的に無効なIDに設定            */
 	p->status = PROC_PSTATE_DORMANT;  /*  プロセスの状態を停止中に設定           */
+	p->caps = PROC_CAP_NONE;          /*  特権なし                               */
 	ev_queue_init( &p->evque );       /*  イベントキューを初期化                 */
 	
-	mutex_init( &p->vm.asmtx, MTX_FLAG_EXCLUSIVE);      /* 仮想空間mutexの初期化 */
+	rwsem_init( &p->vm.asmtx );          /* 仮想空間セマフォの初期化             */
+	spinlock_init( &p->vm.pgtbl_lock );  /* ページテーブル更新ロックの初期化     */
 	p->vm.p = p;                 /*  仮想空間の所属先プロセスを設定              */
 	RB_INIT(&p->vm.vma_head);    /*  仮想空間の仮想メモリ領域ツリーを初期化する  */
 }
@@ -508,9 +565,9 @@ proc_create(proc **procp, thr_prio prio, char *cmdline, const char *environ[], v
         /*
 	 * ELFファイルを配置した領域からアドレス空間情報(VMA)を読込む 
 	 */
-	mutex_lock( &p->vm.asmtx );
+	rwsem_down_write( &p->vm.asmtx );
 	rc = _proc_load_ELF_from_memory(p, image);
-	mutex_unlock( &p->vm.asmtx );
+	rwsem_up_write( &p->vm.asmtx );
 	if ( rc != 0 )
 		goto free_proc_out;
 
@@ -656,8 +713,9 @@ proc_destroy(proc *p){
 
 	/*  プロセス内にスレッドが居ればエラーで復帰  */
 	spinlock_lock_disable_intr( &p->lock, &flags );
-	if ( !queue_is_empty( &p->threads ) ) {
+	if ( ( !queue_is_empty( &p->threads ) ) || ( p->status == PROC_PSTATE_EXIT ) ) {
 
+		/*  スレッドが残存しているか既に破棄処理中  */
 		rc = -EBUSY;
 		spinlock_unlock_restore_intr( &p->lock, &flags );
 		goto error_out;
@@ -684,6 +742,18 @@ proc_destroy(proc *p){
 	 */
 	ev_free_pending_events( &p->evque );
 
+	spinlock_unlock_restore_intr( &p->lock, &flags );
+
+	/*
+	 * 共有メモリリングチャネル/ページグラントの解放
+	 * 他プロセスの仮想空間のロック(スリープ可能なロック)を獲得するため, 
+	 * プロセスのロックを解放して実施する
+	 */
+	lpc_ring_release_as( &p->vm );
+	vm_grant_release_as( &p->vm );
+
+	spinlock_lock_disable_intr( &p->lock, &flags );
+
         /*
 	 *  アドレス空間の解放
 	 */
@@ -0,0 +1,41 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  common test fixture routines                                      */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/thread.h>
+
+#include <kern/tst-progs.h>
+
+/** テスト用のカーネルスレッドを生成して起動する
+    @param[out] thrp 生成したスレッドの返却先(NULLの場合は返却しない)
+    @param[in]  fn   スレッド関数
+    @param[in]  arg  スレッド関数の引数
+ */
+void
+tst_start_kthread(thread **thrp, int (*fn)(void *), void *arg) {
+	int      rc;
+	thread *thr;
+
+	rc = thr_new_thread(&thr);
+	kassert( rc == 0 );
+
+	if ( thrp != NULL )
+		*thrp = thr;  /*  起動前に返却し, 他のテストスレッドから参照可能にする  */
+
+	rc = thr_create_kthread(thr, 0, THR_FLAG_NONE,
+	    THR_INVALID_TID, fn, arg);
+	kassert( rc == 0 );
+
+	rc = thr_start(thr, current->tid);
+	kassert( rc == 0 );
+}
@@ -0,0 +1,64 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  futex test routines                                               */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/errno.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/futex.h>
+
+#include <kern/tst-progs.h>
+
+static volatile futex_val futex_word;
+
+static int
+futex_waiter_thread(void *arg) {
+	int rc;
+
+	kprintf(KERN_INF, "%s:tid=%d thread=%p wait\n",
+	    (char *)arg, current->tid, current);
+	rc = futex_wait(&hal_refer_kernel_proc()->vm, (void *)&futex_word,
+	    0, FUTEX_INFINITE);
+	kprintf(KERN_INF, "%s:tid=%d thread=%p woken rc=%d val=%u\n",
+	    (char *)arg, current->tid, current, rc, futex_word);
+
+	return 0;
+}
+
+void
+futex_test(void) {
+	int  rc;
+	vm  *as;
+
+	as = &hal_refer_kernel_proc()->vm;
+	futex_word = 0;
+
+	/*  値が異なる場合は休眠しない  */
+	rc = futex_wait(as, (void *)&futex_word, 1, FUTEX_INFINITE);
+	kassert( rc == -EAGAIN );
+
+	/*  タイムアウト  */
+	rc = futex_wait(as, (void *)&futex_word, 0, 10);
+	kassert( rc == -ETIMEDOUT );
+
+	tst_start_kthread(NULL, futex_waiter_thread, "Waiter1");
+	tst_start_kthread(NULL, futex_waiter_thread, "Waiter2");
+	thr_yield();
+
+	futex_word = 1;
+	rc = futex_wake(as, (void *)&futex_word, FUTEX_WAKE_ALL);
+	kprintf(KERN_INF, "futex_test: woken=%d\n", rc);
+}
@@ -0,0 +1,108 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  asynchronous LPC test routines                                    */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/errno.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/lpc.h>
+
+#include <kern/tst-progs.h>
+
+#define ASYNC_TEST_DEPTH  (4)
+
+static thread *client_thr, *server_thr;
+
+static int
+async_server(void __attribute__ ((unused)) *arg) {
+	endpoint     src;
+	msg_body     msg;
+	lpc_req_id   req;
+	int       rc, i;
+
+	for( i = 0; ASYNC_TEST_DEPTH > i; ++i) {
+
+		rc = lpc_recv_req(LPC_RECV_ANY, LPC_INFINITE, &msg, &src, &req);
+		kassert( rc == 0 );
+		kprintf(KERN_INF, "AsyncServer: recv req=%lu len=%d\n",
+		    req, msg.sys_pri_dbg_msg.len);
+
+		msg.sys_pri_dbg_msg.rc = i;
+		rc = lpc_send(src, LPC_INFINITE, &msg);  /*  要求IDを引き継いで応答  */
+		kassert( rc == 0 );
+	}
+
+	return 0;
+}
+
+static int
+async_client(void __attribute__ ((unused)) *arg) {
+	msg_body            msg;
+	lpc_req_id ids[ASYNC_TEST_DEPTH];
+	lpc_req_id     id, req;
+	endpoint       src, port;
+	int         rc, st,   i;
+
+	msg.sys_pri_dbg_msg.msg = "async";
+	msg.sys_pri_dbg_msg.len = strlen(msg.sys_pri_dbg_msg.msg);
+
+	/*  滞留上限を超える要求はクレジット不足で拒否される  */
+	rc = lpc_port_create(LPC_PORT_ANY, &port);
+	kassert( rc == 0 );
+	rc = lpc_set_async_depth(port, 1);
+	kassert( rc == 0 );
+	rc = lpc_send_async(port, &msg, &id);
+	kassert( rc == 0 );
+	rc = lpc_send_async(port, &msg, &req);
+	kassert( rc == -EAGAIN );
+
+	/*  未受信のままポートを破棄すると配送失敗が通知される  */
+	rc = lpc_port_destroy(port);
+	kassert( rc == 0 );
+	rc = lpc_async_wait(LPC_NON_BLOCK, &req, &st);
+	kassert( rc == 0 );
+	kassert( ( req == id ) && ( st == -ENOENT ) );
+
+	/*  受信者を待たずに要求を投入する  */
+	for( i = 0; ASYNC_TEST_DEPTH > i; ++i) {
+
+		rc = lpc_send_async(server_thr->tid, &msg, &ids[i]);
+		kassert( rc == 0 );
+	}
+
+	/*  配送結果と応答を要求IDで対応付ける  */
+	for( i = 0; ASYNC_TEST_DEPTH > i; ++i) {
+
+		rc = lpc_async_wait(LPC_INFINITE, &id, &st);
+		kassert( rc == 0 );
+		kassert( st == 0 );
+
+		rc = lpc_recv_req(server_thr->tid, LPC_INFINITE, &msg, &src, &req);
+		kassert( rc == 0 );
+		kassert( req == ids[i] );
+		kprintf(KERN_INF, "AsyncClient: delivered id=%lu reply req=%lu rc=%d\n",
+		    id, req, msg.sys_pri_dbg_msg.rc);
+	}
+
+	return 0;
+}
+
+void
+lpc_async_test(void) {
+
+	tst_start_kthread(&server_thr, async_server, NULL);
+	tst_start_kthread(&client_thr, async_client, NULL);
+}
@@ -0,0 +1,74 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  batched LPC receive/reply test routines                           */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/lpc.h>
+
+#include <kern/tst-progs.h>
+
+#define BATCH_TEST_CLIENTS  (4)
+
+static thread *batch_server_thr;
+static lpc_batch_ent batch_ents[BATCH_TEST_CLIENTS];
+
+static int
+batch_server(void __attribute__ ((unused)) *arg) {
+	int  rc, i, nr, served;
+
+	for( served = 0; BATCH_TEST_CLIENTS > served; served += nr) {
+
+		nr = lpc_recv_batch(LPC_RECV_ANY, LPC_INFINITE, batch_ents, 
+		    BATCH_TEST_CLIENTS);
+		kassert( nr > 0 );
+		kprintf(KERN_INF, "BatchServer: received %d messages\n", nr);
+
+		for( i = 0; nr > i; ++i) 
+			batch_ents[i].body.sys_pri_dbg_msg.rc = 
+				batch_ents[i].body.sys_pri_dbg_msg.len;
+
+		rc = lpc_reply_batch(batch_ents, nr);
+		kprintf(KERN_INF, "BatchServer: replied %d/%d\n", rc, nr);
+	}
+
+	return 0;
+}
+
+static int
+batch_client(void *arg) {
+	msg_body msg;
+	int       rc;
+
+	msg.sys_pri_dbg_msg.msg = (char *)arg;
+	msg.sys_pri_dbg_msg.len = strlen(msg.sys_pri_dbg_msg.msg);
+
+	rc = lpc_send_and_reply(batch_server_thr->tid, &msg);
+	kprintf(KERN_INF, "BatchClient(%s): rc=%d reply-rc=%d\n", 
+	    (char *)arg, rc, msg.sys_pri_dbg_msg.rc);
+
+	return 0;
+}
+
+void
+lpc_batch_test(void) {
+
+	tst_start_kthread(&batch_server_thr, batch_server, NULL);
+	tst_start_kthread(NULL, batch_client, "A");
+	tst_start_kthread(NULL, batch_client, "BB");
+	tst_start_kthread(NULL, batch_client, "CCC");
+	tst_start_kthread(NULL, batch_client, "DDDD");
+}
@@ -0,0 +1,78 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  LPC round trip benchmark routines                                 */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/lpc.h>
+
+#include <hal/rdtsc.h>
+
+#include <kern/tst-progs.h>
+
+#define LPC_BENCH_LOOPS  (10000)  /*< 往復回数  */
+
+static thread *bench_client, *bench_server;
+
+static int
+lpc_bench_server(void __attribute__ ((unused)) *arg) {
+	int        i;
+	int       rc;
+	msg_body msg;
+	endpoint src;
+
+	for( i = 0; LPC_BENCH_LOOPS > i; ++i) {
+
+		rc = lpc_recv(LPC_RECV_ANY, LPC_INFINITE, &msg, &src);
+		kassert( rc == 0 );
+
+		rc = lpc_send(src, LPC_INFINITE, &msg);
+		kassert( rc == 0 );
+	}
+
+	return 0;
+}
+
+static int
+lpc_bench_client(void __attribute__ ((unused)) *arg) {
+	int             i;
+	int            rc;
+	msg_body      msg;
+	uint64_t    start;
+	uint64_t      end;
+
+	memset(&msg, 0, sizeof(msg_body));
+
+	start = rdtsc();
+	for( i = 0; LPC_BENCH_LOOPS > i; ++i) {
+
+		rc = lpc_send_and_reply(bench_server->tid, &msg);
+		kassert( rc == 0 );
+	}
+	end = rdtsc();
+
+	kprintf(KERN_INF, "lpc-bench: %d round trips, %ld cycles/round trip\n",
+	    LPC_BENCH_LOOPS, ( end - start ) / LPC_BENCH_LOOPS);
+
+	return 0;
+}
+
+void
+lpc_bench_test(void) {
+
+	tst_start_kthread(&bench_server, lpc_bench_server, NULL);
+	tst_start_kthread(&bench_client, lpc_bench_client, NULL);
+}
@@ -0,0 +1,129 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  LPC many senders stress test routines                             */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/lpc.h>
+
+#include <hal/rdtsc.h>
+
+#include <kern/tst-progs.h>
+
+#define LPC_STRESS_SENDERS  (256)  /*< 同時送信スレッド数  */
+
+static endpoint stress_port;
+static thread  *stress_server_thr;
+static thread  *stress_senders[LPC_STRESS_SENDERS];
+
+static void
+stress_reply(msg_body *msg, endpoint src) {
+	int rc;
+
+	msg->sys_pri_dbg_msg.rc = msg->sys_pri_dbg_msg.len;
+	rc = lpc_send(src, LPC_INFINITE, msg);
+	kassert( rc == 0 );
+}
+
+static int
+lpc_stress_server(void __attribute__ ((unused)) *arg) {
+	int              rc;
+	int               i;
+	msg_body        msg;
+	endpoint        src;
+	lpc_msg_type   type;
+	uint64_t      start;
+	uint64_t        end;
+
+	start = rdtsc();
+
+	/*
+	 * 後半の送信者からは送信元を指定して逆順に受信する
+	 * (送信元索引による検索)
+	 */
+	for( i = LPC_STRESS_SENDERS - 1; i >= LPC_STRESS_SENDERS / 2; --i) {
+
+		rc = lpc_port_recv_msg(stress_port, stress_senders[i]->tid, 
+		    LPC_INFINITE, &msg, &src, &type);
+		kassert( rc == 0 );
+		kassert( src == stress_senders[i]->tid );
+		stress_reply(&msg, src);
+	}
+
+	/*
+	 * 残りの送信者からは到着順に受信する
+	 */
+	for( i = 0; LPC_STRESS_SENDERS / 2 > i; ++i) {
+
+		rc = lpc_port_recv_msg(stress_port, LPC_RECV_ANY, 
+		    LPC_INFINITE, &msg, &src, &type);
+		kassert( rc == 0 );
+		stress_reply(&msg, src);
+	}
+
+	end = rdtsc();
+
+	kprintf(KERN_INF, "lpc stress: %d senders served in %lu cycles\n",
+	    LPC_STRESS_SENDERS, end - start);
+
+	rc = lpc_port_destroy(stress_port);
+	kassert( rc == 0 );
+
+	return 0;
+}
+
+static int
+lpc_stress_sender(void __attribute__ ((unused)) *arg) {
+	int          rc;
+	int          st;
+	msg_body    msg;
+	lpc_req_id   id;
+	lpc_req_id  req;
+
+	memset(&msg, 0, sizeof(msg_body));
+	msg.sys_pri_dbg_msg.len = (size_t)current->tid;
+
+	rc = lpc_send_async(stress_port, &msg, &id);
+	kassert( rc == 0 );
+
+	rc = lpc_recv_req(stress_port, LPC_INFINITE, &msg, NULL, &req);
+	kassert( rc == 0 );
+	kassert( req == id );
+	kassert( msg.sys_pri_dbg_msg.rc == (int)current->tid );
+
+	rc = lpc_async_wait(LPC_INFINITE, &req, &st);
+	kassert( rc == 0 );
+	kassert( ( req == id ) && ( st == 0 ) );
+
+	return 0;
+}
+
+void
+lpc_stress_test(void) {
+	int   rc;
+	int    i;
+
+	rc = lpc_port_create(LPC_PORT_ANY, &stress_port);
+	kassert( rc == 0 );
+
+	rc = lpc_set_async_depth(stress_port, LPC_STRESS_SENDERS);
+	kassert( rc == 0 );
+
+	for( i = 0; LPC_STRESS_SENDERS > i; ++i)
+		tst_start_kthread(&stress_senders[i], lpc_stress_sender, NULL);
+
+	tst_start_kthread(&stress_server_thr, lpc_stress_server, NULL);
+}
@@ -0,0 +1,91 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  multiplexed LPC wait test routines                                */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/errno.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/timer.h>
+#include <kern/lpc.h>
+
+#include <kern/tst-progs.h>
+
+#define WAIT_TEST_TMOUT  (100)  /*< 待ち合わせのタイムアウト時間(単位:ms)  */
+
+static endpoint wait_port;
+
+static int
+wait_server(void __attribute__ ((unused)) *arg) {
+	int         rc;
+	endpoint   eps[2];
+	uint64_t  ready;
+	msg_body    msg;
+	endpoint    src;
+	lpc_msg_type type;
+
+	eps[0] = current->tid;
+	eps[1] = wait_port;
+
+	/*
+	 * 送信者がいない間はタイムアウトする
+	 */
+	rc = lpc_wait_any(eps, 2, WAIT_TEST_TMOUT, &ready);
+	kprintf(KERN_INF, "WaitServer: first wait rc=%d\n", rc);
+	kassert( rc == -ETIMEDOUT );
+
+	rc = lpc_wait_any(eps, 2, LPC_INFINITE, &ready);
+	kprintf(KERN_INF, "WaitServer: second wait rc=%d ready=0x%lx\n", rc, ready);
+	kassert( rc > 0 );
+	kassert( ready & ( 1ULL << 1 ) );
+
+	rc = lpc_port_recv_msg(wait_port, LPC_RECV_ANY, LPC_NON_BLOCK, &msg, 
+	    &src, &type);
+	kprintf(KERN_INF, "WaitServer: recv rc=%d from %d msg=%s\n", 
+	    rc, src, msg.sys_pri_dbg_msg.msg);
+	kassert( rc == 0 );
+
+	rc = lpc_port_destroy(wait_port);
+	kassert( rc == 0 );
+
+	return 0;
+}
+
+static int
+wait_client(void *arg) {
+	msg_body msg;
+	int       rc;
+
+	msg.sys_pri_dbg_msg.msg = (char *)arg;
+	msg.sys_pri_dbg_msg.len = strlen(msg.sys_pri_dbg_msg.msg);
+
+	tim_wait(WAIT_TEST_TMOUT * 2);
+
+	rc = lpc_send(wait_port, LPC_INFINITE, &msg);
+	kprintf(KERN_INF, "WaitClient: send rc=%d\n", rc);
+
+	return 0;
+}
+
+void
+lpc_wait_test(void) {
+	int rc;
+
+	rc = lpc_port_create(LPC_PORT_ANY, &wait_port);
+	kassert( rc == 0 );
+
+	tst_start_kthread(NULL, wait_server, NULL);
+	tst_start_kthread(NULL, wait_client, "Hello");
+}
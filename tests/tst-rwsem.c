@@ -0,0 +1,74 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  reader-writer semaphore test routines                             */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kern/config.h>
+#include <kern/assert.h>
+#include <kern/string.h>
+#include <kern/kprintf.h>
+#include <kern/thread.h>
+#include <kern/sched.h>
+#include <kern/proc.h>
+#include <kern/rwsem.h>
+
+#include <kern/tst-progs.h>
+
+static rwsem sem1;
+static int shared_val;
+
+static int
+rwsem_reader(void *arg) {
+
+	kprintf(KERN_INF, "%s:tid=%d thread=%p down read\n",
+	    (char *)arg, current->tid, current);
+	rwsem_down_read(&sem1);
+	kprintf(KERN_INF, "%s:tid=%d thread=%p read val=%d\n",
+	    (char *)arg, current->tid, current, shared_val);
+	thr_yield();
+	kprintf(KERN_INF, "%s:tid=%d thread=%p up read\n",
+	    (char *)arg, current->tid, current);
+	rwsem_up_read(&sem1);
+
+	return 0;
+}
+
+static int
+rwsem_writer(void *arg) {
+
+	kprintf(KERN_INF, "%s:tid=%d thread=%p down write\n",
+	    (char *)arg, current->tid, current);
+	rwsem_down_write(&sem1);
+	kassert( rwsem_write_locked_by_self(&sem1) );
+	++shared_val;
+	thr_yield();
+	kprintf(KERN_INF, "%s:tid=%d thread=%p up write val=%d\n",
+	    (char *)arg, current->tid, current, shared_val);
+	rwsem_up_write(&sem1);
+
+	return 0;
+}
+
+void
+rwsem_test(void) {
+
+	rwsem_init(&sem1);
+	shared_val = 0;
+
+	/*
+	 * 読み込み中に書き込み待ちが入った後の読み込み要求は
+	 * 書き込み完了まで待たされる
+	 */
+	tst_start_kthread(NULL, rwsem_reader, "Reader1");
+	tst_start_kthread(NULL, rwsem_reader, "Reader2");
+	tst_start_kthread(NULL, rwsem_writer, "Writer1");
+	tst_start_kthread(NULL, rwsem_reader, "Reader3");
+	tst_start_kthread(NULL, rwsem_writer, "Writer2");
+}
@@ -21,59 +21,47 @@
 #include <kern/errno.h>
 #include <kern/spinlock.h>
 #include <kern/thread.h>
-#include <kern/kresv-ids.h>
 
 //#define  DEBUG_REAPER_THREAD
 
 static thread_reaper kthread_repaer;
 
-/** 回収処理スレッド
+/** 回収処理(ワークキュー処理関数)
+    @param[in] data 未使用
+    @note 回収処理はワーカスレッドの優先度(WQ_WORKER_PRIO)で動作する.
+    専用の回収スレッド(THR_MAX_PRIO - 1)よりも低い優先度となるが, 
+    高優先度の処理要求として他の処理要求より先に実行する.
  */
-static int
-reaper_thread(void __attribute__ ((unused)) *arg) {
+static void
+reap_threads(private_inf __attribute__ ((unused)) data) {
 	int             rc;
 	intrflags    flags;
 	thread_reaper *ktr;
-	sync_reason    res;
 	thread        *thr;
 	thread_queue   *tq;
 
 	ktr = &kthread_repaer;
 	tq = &ktr->tq;
 
-	while(1) {
-				
 #if defined(DEBUG_REAPER_THREAD)
-		kprintf(KERN_INF, "reaper thread[tid:%d] waiting\n", 
-		    current->tid);
+	kprintf(KERN_INF, "reaper work[tid:%d] start\n", current->tid);
 #endif  /*  DEBUG_REAPER_THREAD  */
 
-		spinlock_lock_disable_intr( &tq->lock, &flags );
+	spinlock_lock_disable_intr( &tq->lock, &flags );
 
-		res = sync_wait( &ktr->wai, &tq->lock );
-		kassert( res == SYNC_WAI_RELEASED );
+	while( !tq_is_empty( tq ) ) {
 
+		tq_get_top( tq, &thr );
 #if defined(DEBUG_REAPER_THREAD)
-		kprintf(KERN_INF, "reaper thread[tid:%d] wakeup\n", 
-		    current->tid);
-#endif  /*  DEBUG_REAPER_THREAD  */
-
-		while( !tq_is_empty( tq ) ) {
-
-			tq_get_top( tq, &thr );
-#if defined(DEBUG_REAPER_THREAD)
-		kprintf(KERN_INF, "reaper thread[tid:%d] try to destroy:tid=%d[thread=%p. status=%d]\n", 
+		kprintf(KERN_INF, "reaper work[tid:%d] try to destroy:tid=%d[thread=%p. status=%d]\n", 
 		    current->tid, thr->tid, thr, thr->status);
 #endif  /*  DEBUG_REAPER_THREAD  */
-			kassert( thr->status == THR_TSTATE_EXIT );
+		kassert( thr->status == THR_TSTATE_EXIT );
 
-			rc = thr_destroy(thr);
-			kassert( rc == 0 );
-		}
-		spinlock_unlock_restore_intr( &tq->lock, &flags );
+		rc = thr_destroy(thr);
+		kassert( rc == 0 );
 	}
-
-	return 0;
+	spinlock_unlock_restore_intr( &tq->lock, &flags );
 }
 
 /** 自スレッドの回収を依頼する
@@ -98,29 +86,17 @@ _thr_enter_dead(void) {
 	tq_add( tq, current);  /*  自スレッドを回収対象に追加  */
 	spinlock_unlock_restore_intr(&tq->lock, &flags);
 
-	sync_wake(&ktr->wai, SYNC_WAI_RELEASED);  /*  回収処理スレッドを起床  */
+	queue_work(&ktr->work);  /*  回収処理をワークキューに依頼  */
 }
 
 /** スレッド回収処理の初期化
  */
 void
 _thr_init_reaper(void) {
-	int            rc;
 	thread_reaper *ktr;
 
 	ktr = &kthread_repaer;
 
-	rc = thr_new_thread( &ktr->thr );
-	kassert( rc == 0 );
-
-	rc = thr_create_kthread( ktr->thr, THR_MAX_PRIO - 1, THR_FLAG_NONE,
-	    ID_RESV_REAPER, reaper_thread, (void *)"ThreadReaper" );
-	kassert( rc == 0 );
-	kassert( ktr->thr->tid == ID_RESV_REAPER );
-
-	sync_init_object( &ktr->wai, SYNC_WAKE_FLAG_ALL, THR_TSTATE_WAIT );
+	work_init( &ktr->work, reap_threads, NULL, WQ_PRIO_HIGH );
 	tq_init( &ktr->tq );
-
-	rc = thr_start(ktr->thr, current->tid);
-	kassert( rc == 0 );
 }
@@ -24,6 +24,8 @@
 #include <kern/sched.h>
 #include <kern/idle.h>
 
+#include <thr/thr-internal.h>
+
 static thread *running_threads[NR_CPUS];         /*<  実行中のスレッド  */
 static thread_queue ready_queues[THR_MAX_PRIO];  /*<  レディキュー      */
 
@@ -115,6 +117,27 @@ ready_queue_get_next_thread(void) {
 found_next:
 	return next;
 }
+
+/** 実行可能なスレッドの最高優先度を得る
+    @return 実行可能なスレッドの最高優先度(実行可能なスレッドがない場合は-1)
+ */
+static int
+ready_queue_highest_prio(void) {
+	int           i;
+	bool      found;
+	intrflags flags;
+
+	for( i = ( THR_MAX_PRIO  - 1 ); 0 <= i; --i ) {
+
+		spinlock_lock_disable_intr( &ready_queues[i].lock, &flags);
+		found = !ready_queue_is_empty_nolock( i );
+		spinlock_unlock_restore_intr( &ready_queues[i].lock, &flags);
+		if ( found )
+			return i;
+	}
+
+	return -1;
+}
 /** スレッドを起床する
     @param[in] 起床対象スレッド
     @note スレッド開始関数/同期機構/非同期イベントを実装するIFのため外部リンケージとして定義
@@ -130,11 +153,14 @@ _sched_wakeup(thread *thr) {
 	    ( thr->status == THR_TSTATE_DORMANT ) );
 
 	spinlock_lock_disable_intr( &ready_queues[thr->prio].lock, &flags);
-	if ( ( thr_in_wait(thr) ) || ( thr->status == THR_TSTATE_DORMANT ) ) {
+	if ( ( !thr->handoff ) &&
+	    ( ( thr_in_wait(thr) ) || ( thr->status == THR_TSTATE_DORMANT ) ) ) {
 
 		/* 既に起床されたスレッドをキューに入れ直して
 		 * キューを破壊しないように, WAIT/DORMANTの場合だけ
 		 * レディキューに入れる.
+		 * CPU直接引き渡しの切り替え先として予約されているスレッドは
+		 * 引き渡し処理で実行されるためレディキューに入れない.
 		 */
 		thr->status = THR_TSTATE_READY;
 		ready_queue_add_nolock( thr );
@@ -143,6 +169,53 @@ _sched_wakeup(thread *thr) {
 	spinlock_unlock_restore_intr( &ready_queues[thr->prio].lock, &flags);
 }
 
+/** スレッドの実行優先度を変更する
+    @param[in] thr  対象スレッド
+    @param[in] prio 新しい実行優先度
+    @note レディキューに登録されているスレッドは新しい優先度の
+    キューに付け替える. 優先度を下げた場合, 自スレッドより
+    高い優先度のスレッドを起床した場合にはスケジュール要求を発行する.
+ */
+void
+sched_set_prio(thread *thr, thr_prio prio) {
+	intrflags flags;
+	thr_prio    old;
+
+	kassert( thr != NULL );
+	kassert( prio < THR_MAX_PRIO );
+
+	hal_cpu_disable_interrupt( &flags );
+
+	old = thr->prio;
+	if ( old == prio )
+		goto out;
+
+	spinlock_lock( &ready_queues[old].lock );
+	if ( thr->status == THR_TSTATE_READY ) {
+
+		/*  レディキューを付け替える  */
+		tq_del( &ready_queues[old], thr );
+		spinlock_unlock( &ready_queues[old].lock );
+
+		spinlock_lock( &ready_queues[prio].lock );
+		thr->prio = prio;
+		ready_queue_add_nolock( thr );
+		spinlock_unlock( &ready_queues[prio].lock );
+	} else {
+
+		thr->prio = prio;
+		spinlock_unlock( &ready_queues[old].lock );
+	}
+
+	if ( ( ( thr == current ) && ( prio < old ) ) ||
+	    ( ( thr != current ) && ( thr->status == THR_TSTATE_READY ) &&
+		( prio > current->prio ) ) )
+		ti_set_delay_dispatch(current->ti);  /*  優先度変更に伴うスケジュール要求  */
+
+out:
+	hal_cpu_restore_interrupt( &flags );
+}
+
 /** スケジューラ本体
  */
 void
@@ -194,6 +267,112 @@ no_need_sched:
 	hal_cpu_restore_interrupt(&flags);
 }
 
+/** 待ちスレッドをCPU直接引き渡しの切り替え先として予約する
+    @param[in] thr 同期オブジェクトから取り外した待ちスレッド
+    @retval    真  予約した
+    @retval    偽  待ち状態でないか既に予約済みのため予約できなかった
+    @note 予約中のスレッドは他の起床処理でレディキューに入れられない.
+    予約したスレッドはsched_handoffまたは_sched_release_handoffに渡す.
+ */
+bool
+_sched_reserve_handoff(thread *thr) {
+	bool        rc;
+	intrflags flags;
+
+	kassert( thr != NULL );
+
+	spinlock_lock_disable_intr( &ready_queues[thr->prio].lock, &flags);
+	rc = ( thr_in_wait(thr) ) && ( !thr->handoff );
+	if ( rc )
+		thr->handoff = true;
+	spinlock_unlock_restore_intr( &ready_queues[thr->prio].lock, &flags);
+
+	return rc;
+}
+
+/** CPU直接引き渡しの予約を解除し, レディキュー経由で起床する
+    @param[in] thr 予約済みのスレッド
+ */
+void
+_sched_release_handoff(thread *thr) {
+	intrflags flags;
+
+	kassert( thr != NULL );
+
+	spinlock_lock_disable_intr( &ready_queues[thr->prio].lock, &flags);
+	kassert( thr->handoff );
+	thr->handoff = false;
+	spinlock_unlock_restore_intr( &ready_queues[thr->prio].lock, &flags);
+
+	_sched_wakeup(thr);
+}
+
+/** 指定したスレッドに直接CPUを引き渡す
+    @param[in] next 切り替え先のスレッド(_sched_reserve_handoffで予約済みの待ちスレッド)
+    @note 自スレッドを待ち状態に設定し, ディスパッチ禁止状態(1段)で呼び出す.
+    レディキューを経由せず, スレッド選択処理も行わずに切り替え先スレッドに
+    切り替え, 自スレッドの残りタイムスライスを譲渡する.
+    切り替え先スレッドより優先度の高いスレッドが実行可能な場合は,
+    切り替え先スレッドをレディキュー経由で起床して通常のスケジュールを行う.
+    呼び出し元のディスパッチ禁止は本関数内で解除する.
+ */
+void
+sched_handoff(thread *next) {
+	intrflags    flags;
+	intrflags  rqflags;
+	thread_info    *ti;
+
+	kassert( next != NULL );
+	kassert( next != current );
+	kassert( next->handoff );
+
+	hal_cpu_disable_interrupt(&flags);
+
+	ti = current->ti;
+	kassert( ( ~THR_PREEMPT_ACTIVE & ti->preempt ) == 1 );
+	kassert( ti->intrcnt == 0 );
+
+	if ( ( !thr_in_wait(current) ) ||
+	    ( ready_queue_highest_prio() > (int)next->prio ) ) {
+
+		/* 
+		 * 休眠前に自スレッドが起床された場合や切り替え先より優先度の
+		 * 高いスレッドが実行可能な場合は, 切り替え先スレッドを
+		 * レディキュー経由で起床する. 自スレッドが待ち状態であれば
+		 * ディスパッチ許可時に再スケジュールされる.
+		 */
+		hal_cpu_restore_interrupt(&flags);
+		_sched_release_handoff(next);
+		ti_enable_dispatch();
+		return;
+	}
+
+	/*
+	 * 予約を解除して実行中に遷移させ, 以降の起床処理で
+	 * レディキューに入れられないようにする
+	 */
+	spinlock_lock_disable_intr( &ready_queues[next->prio].lock, &rqflags);
+	kassert( thr_in_wait(next) );
+	next->handoff = false;
+	next->status = THR_TSTATE_RUN;
+	spinlock_unlock_restore_intr( &ready_queues[next->prio].lock, &rqflags);
+
+	ti_clr_thread_info(ti); /* ディスパッチ禁止と遅延ディスパッチ要求をクリア  */
+
+	/*
+	 * 自スレッドの残りタイムスライスを譲渡する
+	 */
+	if ( ( current->prio == THR_RR_PRIO ) && ( next->prio == THR_RR_PRIO ) )
+		next->cur_slice = current->cur_slice;
+
+	sched_switch_threads(current, next);  /*  スレッドの切り替え  */
+	kassert( current->status == THR_TSTATE_RUN );  /*  currentは切り替え後のスレッド */
+
+	running_threads[current_cpu()] = current;  /*  カレントCPUの実行中スレッドを更新  */
+
+	hal_cpu_restore_interrupt(&flags);
+}
+
 /** スケジューラの初期化
     @note レディキューの初期化
  */
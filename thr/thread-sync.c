@@ -170,6 +170,76 @@ sync_wait(sync_obj *obj, spinlock *lock){
 	return sync_wait_with_callback(obj, sync_spinlocked_callback, lock); 
 }
 
+/** 同期オブジェクトを待ち合わせているスレッドを起こし, CPUを直接引き渡して待ち合わせる
+    @param[in] wobj 起床対象スレッドが待ち合わせている同期オブジェクト
+    @param[in] obj  自スレッドが待ち合わせる同期オブジェクト
+    @param[in] lock 同期オブジェクトobjに紐付けられたロック
+    @retval SYNC_WAI_RELEASED  待ち要因が解消された 
+    @retval SYNC_OBJ_DESTROYED オブジェクトが破棄された
+    @retval SYNC_WAI_DELIVEV   イベントを受信した
+    @note sync_wake(wobj)とsync_wait(obj, lock)を組み合わせた処理を行う.
+    wobjの先頭の待ちスレッドはレディキューを経由せずに直接ディスパッチする.
+    切り替え先スレッドを予約してから切り替えが完了するまで割込みを禁止する.
+*/
+sync_reason
+sync_wake_and_wait(sync_obj *wobj, sync_obj *obj, spinlock *lock) {
+	intrflags   flags;
+	intrflags  iflags;
+	sync_block    blk;
+	sync_block  *wblk;
+	thread      *next;
+
+	kassert( wobj != NULL );
+	kassert( obj != NULL );
+	kassert( spinlock_locked_by_self(lock) );
+
+	hal_cpu_disable_interrupt(&iflags);  /*  切り替え完了まで割込みを禁止  */
+
+	wait_sync_obj_no_schedule(obj, &blk);
+
+	/*
+	 * 起床対象スレッドを同期オブジェクトから取り外す
+	 */
+	next = NULL;
+	spinlock_lock_disable_intr( &wobj->lock, &flags );  
+	while( !queue_is_empty( &wobj->que ) ) {
+		
+		wblk = CONTAINER_OF( queue_get_top( &wobj->que ),
+		    sync_block, olink);
+		wblk->reason = SYNC_WAI_RELEASED; 
+
+		if ( ( next == NULL ) && ( _sched_reserve_handoff( wblk->thr ) ) )
+			next = wblk->thr;  /*  先頭のスレッドにCPUを引き渡す  */
+		else
+			_sched_wakeup( wblk->thr );
+		
+		if ( wobj->policy == SYNC_WAKE_FLAG_ONE )
+			break;
+	}
+	spinlock_unlock_restore_intr( &wobj->lock, &flags );
+
+	if ( next == NULL ) {  /*  起床対象スレッドがいない  */
+
+		if ( thr_in_wait(current) ) {
+
+			spinlock_unlock(lock);
+			sched_schedule();  /*  CPUを解放, 再スケジュールを実施  */
+			spinlock_lock(lock);
+		}
+	} else if ( thr_in_wait(current) ) {
+
+		ti_disable_dispatch();  /*  ロック解放時にディスパッチしないようにする  */
+		spinlock_unlock(lock);
+		sched_handoff(next);    /*  起床対象スレッドに直接切り替える  */
+		spinlock_lock(lock);
+	} else
+		_sched_release_handoff(next);  /*  既に自スレッドが起床されている  */
+
+	hal_cpu_restore_interrupt(&iflags);
+
+	return finish_wait(obj, &blk);  /*  起床要因を返却  */
+}
+
 /** 同期オブジェクトを待ち合わせているスレッドを起こす
     @param[in] obj    同期オブジェクト
     @param[in] reason 起床要因 
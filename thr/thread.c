@@ -123,6 +123,7 @@ create_thread_common(thread *thr, int prio) {
 	spinlock_unlock_restore_intr( &thr_free_queue.lock, &flags );
 
 	thr->prio = prio;  /*  スレッドの属性にprioを設定     */
+	thr->base_prio = prio;  /*  静的優先度を記録  */
 
 	spinlock_lock_disable_intr( &thr_dormant_queue.lock, &flags );
 	tq_add(&thr_dormant_queue, thr);  /* 停止キューに追加  */
@@ -158,6 +159,7 @@ _thr_init_kthread_params(thread *thr) {
 	kassert( thr != NULL);
 
 	thr->tid = THR_INVALID_TID;        /*  tidを無効TIDに設定  */
+	thr->handoff = false;              /*  CPU直接引き渡しの予約なし  */
 
 	/*
 	 * lock, mlink, plink, linkを初期化
@@ -178,6 +180,12 @@ _thr_init_kthread_params(thread *thr) {
 	thread_resource_init( &thr->resource );
 
 	lpc_msg_queue_init( &thr->mque );  /*  メッセージキューを初期化  */
+	lpc_msg_slot_init( &thr->lpc_slot );  /*  送信用メッセージスロットを初期化  */
+	thr->lpc_reply_port = LPC_PORT_ANY;     /*  ポート経由の応答先を初期化  */
+	thr->lpc_reply_client = THR_INVALID_TID;
+	thr->lpc_reply_req = LPC_REQ_ID_NONE;
+	thr->lpc_prio_lent = false;
+	lpc_async_ctx_init( &thr->lpc_async );  /*  非同期送信完了通知キューを初期化  */
 
 	hal_fpctx_init(&thr->fpctx);       /*  浮動小数点コンテキストの初期化  */
 
@@ -468,7 +476,8 @@ thr_start(thread *thr, tid ptid) {
 		thr->ptid = ptid;  /* 親スレッドのIDを設定  */
 
 		/*  親スレッドのイベントマスクをコピーする  */
-		memcpy( &thr->evque.masks, &pthr->evque.masks, sizeof(event_mask) );
+		memcpy( &thr->evque.masks, ev_refer_mask( &pthr->evque ), 
+		    sizeof(event_mask) );
 
 		spinlock_unlock( &pthr->lock );
 	}
@@ -509,6 +518,9 @@ thr_exit(exit_code rc) {
 
 
 	current->exit_code = rc; /* 終了コードを設定  */
+
+	ev_mask_page_release(current);  /*  共有マスクページを解放する  */
+
 	/*
 	 * 子スレッドの監視解除
 	 */
@@ -608,6 +620,7 @@ enter_dead:
 	spinlock_unlock_restore_intr( &current->evque.lock, &flags );
 
 	lpc_destroy_msg_queue( &current->mque );    /* メッセージキューの削除  */
+	lpc_async_ctx_destroy( &current->lpc_async ); /* 未回収の完了通知を破棄  */
 
 	proc_destroy(current->p); /*  プロセスの解放を試みる  */
 
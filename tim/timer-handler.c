@@ -24,11 +24,25 @@
 #include <kern/list.h>
 #include <kern/thread.h>
 #include <kern/irq.h>
+#include <kern/softirq.h>
 #include <kern/timer.h>
 
 #include <tim/tim-internal.h>
 
 uptime_ticks uptime;  /*<  起動後の総ティック発生回数  */
+static softirq_work callout_work;  /*<  コールアウト処理の遅延処理要求  */
+
+/** コールアウト処理(遅延割込み処理)
+    @param[in] data プライベートデータ
+    @note 割込み出口で割込み許可状態で呼び出される.
+    遅延中に複数回ティックが進んだ場合は, 処理時点のアップタイムまでに
+    満了したコールアウトをまとめて処理する.
+ */
+static void
+callout_softirq(private_inf __attribute__ ((unused)) data) {
+
+	_tim_invoke_callout( _tim_refer_uptime_lockfree() );
+}
 
 /** タイマハンドラ
     @param[in] no   割込み番号
@@ -39,12 +53,9 @@ uptime_ticks uptime;  /*<  起動後の総ティック発生回数  */
 static ihandler_res 
 timer_handler(intr_no __attribute__ ((unused)) no, private_inf __attribute__ ((unused)) data, void *ctx) {
 	intrflags flags;
-	ticks cur_tick;
 
 	spinlock_lock_disable_intr( &uptime.lock, &flags);
-
 	++uptime.tick_cnt;
-	cur_tick = uptime.tick_cnt;
 	spinlock_unlock_restore_intr( &uptime.lock, &flags);
 
 	/*
@@ -72,7 +83,7 @@ timer_handler(intr_no __attribute__ ((unused)) no, private_inf __attribute__ ((u
 			++current->resource.sys_time;
 	}
 
-	_tim_invoke_callout(cur_tick);
+	softirq_raise( &callout_work );  /*  コールアウト処理を割込み出口に遅延  */
 
 	return IRQHDL_RES_HANDLED;
 }
@@ -99,6 +110,7 @@ _tim_setup_uptime_clock(void) {
 
 	spinlock_init( &uptime.lock );
 	uptime.tick_cnt = 0;
+	softirq_init_work( &callout_work, callout_softirq, NULL );
 }
 
 /** タイマ割込みハンドラの割込み番号を登録する
@@ -30,7 +30,7 @@
 
 /*  タイマコールアウトキュー  */
 static timer_queue timer_callout_queue =
-	__TIMER_QUEUE_INITIALIZER( &timer_callout_queue.que ); 
+	__TIMER_QUEUE_INITIALIZER( timer_callout_queue ); 
 
 static int timer_handler_cmp(struct _timer_callout *_a, struct _timer_callout *_b);
 
@@ -39,9 +39,10 @@ RB_GENERATE_STATIC(timer_queue, _timer_callout, tnode, timer_handler_cmp);
 /** タイマコールバックの発火時間を比較する
     @param[in] a 比較対象のコールバック1
     @param[in] b 比較対象のコールバック2
-    @retval 0  両者の発火時間が同じ
+    @retval 0  両者が同一のコールバック
     @retval 負 コールバック1の発火時間のほうが前
     @retval 正 コールバック1の発火時間のほうが後
+    @note 発火時間が同じ場合は, コールバックのアドレスで順序付けする
  */
 static int
 timer_handler_cmp(struct _timer_callout *a, struct _timer_callout *b) {
@@ -54,6 +55,12 @@ timer_handler_cmp(struct _timer_callout *a, struct _timer_callout *b) {
 	if ( a->expire > b->expire )
 		return 1;
 
+	if ( (uintptr_t)a < (uintptr_t)b )
+		return -1;
+
+	if ( (uintptr_t)a > (uintptr_t)b )
+		return 1;
+
 	return 0;
 }
 
@@ -77,6 +84,33 @@ init_timer_callout(timer_callout *callout) {
 
 	callout->tmout  = 0;
 	callout->expire = 0;
+	list_init( &callout->link );
+}
+
+/** 未実行のコールアウトをタイマキューまたは発火済みキューから取り除く
+    @param[in] cbp 取り除くコールバック情報
+    @retval    真  取り除いた
+    @retval    偽  登録されていない(実行済みを含む)
+    @note タイマコールアウトキューのロックを獲得して呼び出す
+ */
+static bool
+remove_callout_nolock(timer_callout *cbp) {
+
+	kassert( spinlock_locked_by_self( &timer_callout_queue.lock ) );
+
+	if ( !list_not_linked( &cbp->link ) ) {
+
+		list_del( &cbp->link );  /*  発火済みで実行待ち  */
+		return true;
+	}
+
+	if ( RB_FIND(timer_queue, &timer_callout_queue.que, cbp) == cbp ) {
+
+		RB_REMOVE(timer_queue, &timer_callout_queue.que, cbp);
+		return true;
+	}
+
+	return false;
 }
 
 /** タイムアウトに伴うスレッド起床処理
@@ -179,7 +213,7 @@ finish_wait_time_obj(sync_obj *obj, sync_obj *timer_objp, sync_block *obj_sbp, s
 
 	spinlock_lock_disable_intr( &timer_callout_queue.lock, &flags ); 
 	if ( timer_sbp->reason == SYNC_WAI_WAIT  ) {
-		RB_REMOVE(timer_queue, &timer_callout_queue.que, cbp);
+		remove_callout_nolock(cbp);  /*  未発火または実行待ち  */
 	} else if ( obj_sbp->reason == SYNC_WAI_WAIT )
 		res = timer_sbp->reason;   /*  待ち解除要因を更新    */
 	spinlock_unlock_restore_intr( &timer_callout_queue.lock, &flags ); 
@@ -194,6 +228,10 @@ finish_wait_time_obj(sync_obj *obj, sync_obj *timer_objp, sync_block *obj_sbp, s
 
 /** コールアウトを起動する
     @param[in] cur_tick コールアウト起動時のシステムタイマティック値
+    @note 発火したコールアウトをロック下でタイマキューから発火済みキューに
+    移し, 1つずつ取り出してロックを解放した割込み許可状態で実行する.
+    遅延割込み処理の実行中はディスパッチが禁止されているため, 
+    実行中のコールアウトが取り消し処理と競合することはない.
  */
 void
 _tim_invoke_callout(ticks cur_tick) {
@@ -203,20 +241,84 @@ _tim_invoke_callout(ticks cur_tick) {
 
 	spinlock_lock_disable_intr( &timer_callout_queue.lock, &flags );
 
-	for (callout_ref = RB_MIN(timer_queue, &timer_callout_queue.que); callout_ref != NULL; callout_ref = next) {
+	/*
+	 * 発火したコールアウトをタイマキューから取り外す
+	 */
+	for (callout_ref = RB_MIN(timer_queue, &timer_callout_queue.que); 
+	     ( callout_ref != NULL ) && ( callout_ref->expire <= cur_tick ); 
+	     callout_ref = next) {
 
 		next = RB_NEXT(timer_queue, &timer_callout_queue.que, callout_ref);
-		if ( callout_ref->expire <= cur_tick ) {
 
-			RB_REMOVE(timer_queue, &timer_callout_queue.que, callout_ref);
+		RB_REMOVE(timer_queue, &timer_callout_queue.que, callout_ref);
+		queue_add( &timer_callout_queue.expired, &callout_ref->link );
+	}
 
-			kassert( callout_ref->callout != NULL );
-			callout_ref->callout(callout_ref->data);
-		}
+	/*
+	 * 取り外したコールアウトをロック外で実行する
+	 */
+	while( !queue_is_empty( &timer_callout_queue.expired ) ) {
+
+		callout_ref = CONTAINER_OF(queue_get_top( &timer_callout_queue.expired ),
+		    timer_callout, link);
+		spinlock_unlock_restore_intr( &timer_callout_queue.lock, &flags );
+
+		kassert( callout_ref->callout != NULL );
+		callout_ref->callout(callout_ref->data);
+
+		spinlock_lock_disable_intr( &timer_callout_queue.lock, &flags );
 	}
 
 	spinlock_unlock_restore_intr( &timer_callout_queue.lock, &flags );
-	
+}
+
+/** コールアウトを登録する
+    @param[in] cbp   コールバック情報
+    @param[in] outms 発火までの時間(単位:ms)
+    @param[in] func  コールアウト関数
+    @param[in] data  コールアウト関数に渡す引数
+    @note コールアウト関数は遅延割込み処理から, タイマコールアウトキューの
+    ロックを解放した割込み許可状態で呼び出される
+ */
+void
+tim_callout_add(timer_callout *cbp, tim_tmout outms,
+    void (*func)(private_inf _data), private_inf data) {
+	intrflags           flags;
+	timer_callout        *res;
+
+	kassert( cbp != NULL );
+	kassert( func != NULL );
+
+	init_timer_callout( cbp ); /* コールバック情報を初期化  */
+
+	cbp->tmout = outms;
+	cbp->expire = ms_to_ticks(outms) + _tim_refer_uptime_lockfree();
+	cbp->callout = func;
+	cbp->data = data;
+
+	spinlock_lock_disable_intr( &timer_callout_queue.lock, &flags );
+	res = RB_INSERT(timer_queue, &timer_callout_queue.que, cbp );
+	kassert( res == NULL );
+	spinlock_unlock_restore_intr( &timer_callout_queue.lock, &flags );
+}
+
+/** 登録済みのコールアウトを取り消す
+    @param[in] cbp   コールバック情報
+    @retval    真    発火前に取り消した
+    @retval    偽    登録されていない(実行済みを含む)
+ */
+bool
+tim_callout_cancel(timer_callout *cbp) {
+	bool                   rc;
+	intrflags           flags;
+
+	kassert( cbp != NULL );
+
+	spinlock_lock_disable_intr( &timer_callout_queue.lock, &flags );
+	rc = remove_callout_nolock(cbp);
+	spinlock_unlock_restore_intr( &timer_callout_queue.lock, &flags );
+
+	return rc;
 }
 
 /** 指定した時間だけCPUを開放する
@@ -250,6 +352,7 @@ tim_wait(tim_tmout outms) {
 	kassert( cbp == NULL );
 
 	res = sync_wait(&timer_obj, &timer_callout_queue.lock);
+	remove_callout_nolock( &cb );  /*  イベントによる起床時は未実行のため取り除く  */
 
 	spinlock_lock( &timer_obj.lock ); 
 	kassert( queue_is_empty( &timer_obj.que ) );  /*  キューが空であることを確認  */
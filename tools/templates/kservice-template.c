@@ -42,7 +42,7 @@ handle_YYYY_service(void __attribute__ ((unused)) *arg) {
 	endpoint          src;
 	int                rc;
 
-	rc = kns_register_kernel_service(ID_RESV_NAME_XXXX);
+	rc = kns_register_kernel_service(ID_RESV_NAME_XXXX, current->tid);
 	kassert( rc == 0 );
 	
 	while(1) {
@@ -9,11 +9,21 @@
 #include <hal/rdtsc.h>
 
 #define LOOP_TSC (2000000000ULL)
+#define SYSCALL_BENCH_LOOP (10000)
+#define RING_BENCH_LOOP    (10000)
+#define RING_BENCH_PAGES   (4)
+#define RING_BENCH_ADDR    ((void *)0x100000000000)  /*< チャネル生成側のマップ先  */
+#define RING_BENCH_PEER    ((void *)0x100000100000)  /*< 接続側のマップ先          */
+#define HEAP_BENCH_LOOP    (1000)
+#define HEAP_BENCH_SIZE    (4096)
+#define EVENT_BENCH_LOOP   (1000)
 
 static int data_bss;
 static int data=0x8000;
 
 static volatile int thr_flag=0;
+static volatile lpc_ring_id ring_bench_id = LPC_RING_ID_NONE;
+static volatile int event_bench_count=0;
 
 void
 show_event_mask(event_mask *msk){
@@ -81,6 +91,227 @@ user_stack_test(void) {
 	return;
 }
 
+void
+syscall_bench(void) {
+	int                 i;
+	syscall_res_type  res;
+	uint64_t   tsc1, tsc2;
+
+	/*
+	 * SYSCALL命令とint 0x90トラップのシステムコール往復時間比較
+	 */
+	tsc1 = rdtsc();
+	for(i = 0; SYSCALL_BENCH_LOOP > i; ++i) 
+		__syscall0(X86_64_SYSCALL_INSN_FAST, res, SYS_YATOS_THR_GETID);
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: getid via syscall: %lu cycles/call\n", 
+	    (int)res, (tsc2 - tsc1) / SYSCALL_BENCH_LOOP);
+
+	tsc1 = rdtsc();
+	for(i = 0; SYSCALL_BENCH_LOOP > i; ++i) 
+		trap_syscall0(res, SYS_YATOS_THR_GETID);
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: getid via int 0x90: %lu cycles/call\n", 
+	    (int)res, (tsc2 - tsc1) / SYSCALL_BENCH_LOOP);
+}
+
+void
+syscall_batch_test(void) {
+	int                 rc;
+	svc_batch_entry ents[3];
+
+	/*
+	 * システムコール一括処理デモ
+	 * 不正なシステムコールで処理を打ち切るため3番目の要求は処理されない
+	 */
+	yatos_batch_set(&ents[0], SYS_YATOS_THR_GETID, 0, 0, 0, 0, 0);
+	yatos_batch_set(&ents[1], SYS_YATOS_MAX_NOSYS, 0, 0, 0, 0, 0);
+	yatos_batch_set(&ents[2], SYS_YATOS_THR_YIELD, 0, 0, 0, 0, 0);
+
+	rc = yatos_syscall_batch(&ents[0], 3, SVC_BATCH_FLAG_STOP_ON_ERROR);
+	yatos_printf("[%d]: batch rc=%d res=(%ld, %ld, %ld)\n",
+	    yatos_thread_getid(), rc, ents[0].res, ents[1].res, ents[2].res);
+}
+
+int
+ring_bench_consumer(void __attribute__ ((unused)) *arg) {
+	int                i;
+	int               rc;
+	yatos_lpc_ring    ch;
+	lpc_ring_ent     ent;
+	msg_body         msg;
+	endpoint         src;
+
+	while( ring_bench_id == LPC_RING_ID_NONE )
+		yatos_thread_yield();
+
+	rc = yatos_lpc_ring_attach(&ch, ring_bench_id, RING_BENCH_PEER);
+	if ( rc != 0 )
+		return 1;
+
+	/*
+	 * 要求リングから取り出したエントリを完了リングに返却する
+	 */
+	for( i = 0; RING_BENCH_LOOP > i; ++i) {
+
+		rc = yatos_lpc_ring_consume(&ch, LPC_RING_SQ, &ent, LPC_INFINITE);
+		if ( rc != 0 )
+			return 1;
+
+		while( yatos_lpc_ring_produce(&ch, LPC_RING_CQ, &ent) != 0 )
+			yatos_thread_yield();  /*  完了リング満杯  */
+	}
+
+	for( i = 0; RING_BENCH_LOOP > i; ++i) 
+		yatos_lpc_recv(LPC_RECV_ANY, LPC_INFINITE, &msg, &src);
+
+	return 0;
+}
+
+void
+ring_bench(void *stack) {
+	int                rc;
+	int        sent, done;
+	tid             newid;
+	tid            chldid;
+	exit_code        code;
+	yatos_lpc_ring     ch;
+	lpc_ring_ent      ent;
+	msg_body          msg;
+	uint64_t   tsc1, tsc2;
+
+	/*
+	 * 共有メモリリングチャネルとLPCのメッセージ転送性能比較
+	 */
+	rc = yatos_proc_create_thread(0, (void *)ring_bench_consumer, NULL, 
+	    stack, &newid);
+	if ( rc != 0 )
+		return;
+
+	rc = yatos_lpc_ring_create(&ch, newid, RING_BENCH_PAGES, RING_BENCH_ADDR);
+	yatos_printf("[%d]: ring create rc=%d id=%lu\n",
+	    yatos_thread_getid(), rc, ch.id);
+	if ( rc != 0 )
+		return;
+	ring_bench_id = ch.id;
+
+	memset(&ent, 0, sizeof(lpc_ring_ent));
+	tsc1 = rdtsc();
+	for( sent = 0, done = 0; RING_BENCH_LOOP > done; ++done) {
+
+		while( ( RING_BENCH_LOOP > sent ) 
+		    && ( yatos_lpc_ring_produce(&ch, LPC_RING_SQ, &ent) == 0 ) )
+			++sent;
+
+		rc = yatos_lpc_ring_consume(&ch, LPC_RING_CQ, &ent, LPC_INFINITE);
+		if ( rc != 0 )
+			break;
+	}
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: ring channel: %lu cycles/msg\n", 
+	    yatos_thread_getid(), (tsc2 - tsc1) / RING_BENCH_LOOP);
+
+	memset(&msg, 0, sizeof(msg_body));
+	tsc1 = rdtsc();
+	for( done = 0; RING_BENCH_LOOP > done; ++done) 
+		yatos_lpc_send(newid, LPC_INFINITE, &msg);
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: lpc_send: %lu cycles/msg\n", 
+	    yatos_thread_getid(), (tsc2 - tsc1) / RING_BENCH_LOOP);
+
+	yatos_thread_wait(newid, THR_WAIT_ANY, &chldid, &code);
+	yatos_lpc_ring_destroy(&ch);
+}
+
+void
+heap_bench(void) {
+	int                 i;
+	void             *ptr;
+	uint64_t   tsc1, tsc2;
+
+	/*
+	 * ヒープ伸縮のシステムコール直接処理とVMサーバ経由処理の比較
+	 * (確保した領域に書き込んでから縮小する)
+	 */
+	tsc1 = rdtsc();
+	for(i = 0; HEAP_BENCH_LOOP > i; ++i) {
+
+		ptr = yatos_vm_sbrk(HEAP_BENCH_SIZE);
+		if ( ptr == NULL )
+			break;
+		*(volatile char *)ptr = 1;
+		yatos_vm_sbrk(-HEAP_BENCH_SIZE);
+	}
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: sbrk via syscall: %lu cycles/iteration\n", 
+	    yatos_thread_getid(), (tsc2 - tsc1) / HEAP_BENCH_LOOP);
+
+	tsc1 = rdtsc();
+	for(i = 0; HEAP_BENCH_LOOP > i; ++i) {
+
+		ptr = yatos_vm_sbrk_service(HEAP_BENCH_SIZE);
+		if ( ptr == NULL )
+			break;
+		*(volatile char *)ptr = 1;
+		yatos_vm_sbrk_service(-HEAP_BENCH_SIZE);
+	}
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: sbrk via vm-server: %lu cycles/iteration\n", 
+	    yatos_thread_getid(), (tsc2 - tsc1) / HEAP_BENCH_LOOP);
+
+	tsc1 = rdtsc();
+	for(i = 0; HEAP_BENCH_LOOP > i; ++i) {
+
+		if ( yatos_vm_map_anon(NULL, HEAP_BENCH_SIZE, 
+			VMA_PROT_R | VMA_PROT_W, &ptr) != 0 )
+			break;
+		*(volatile char *)ptr = 1;
+		yatos_vm_unmap_anon(ptr, HEAP_BENCH_SIZE);
+	}
+	tsc2 = rdtsc();
+	yatos_printf("[%d]: anonymous map/unmap: %lu cycles/iteration\n", 
+	    yatos_thread_getid(), (tsc2 - tsc1) / HEAP_BENCH_LOOP);
+}
+
+void
+event_bench_handler(event_no __attribute__ ((unused)) id, 
+    evinfo __attribute__ ((unused)) *inf, void __attribute__ ((unused)) *ctx) {
+
+	++event_bench_count;
+}
+
+void
+event_bench(void) {
+	int                 i;
+	int                rc;
+	tid              self;
+	uint64_t   tsc1, tsc2;
+
+	/*
+	 * 自スレッドへのイベント送信から配送完了までの時間を計測する
+	 * (EV_SIG_USR1のマスクを解除してから呼び出す)
+	 */
+	self = yatos_thread_getid();
+	event_bench_count = 0;
+	yatos_register_user_event_handler(EV_SIG_USR1, event_bench_handler);
+
+	tsc1 = rdtsc();
+	for(i = 0; EVENT_BENCH_LOOP > i; ++i) {
+
+		rc = yatos_proc_send_event(self, EV_SIG_USR1, NULL);
+		if ( rc != 0 )
+			break;
+	}
+	tsc2 = rdtsc();
+
+	yatos_register_user_event_handler(EV_SIG_USR1, user_handler);
+
+	yatos_printf("[%d]: event send and delivery: %lu cycles/event "
+	    "(delivered=%d, queue size=%lu)\n", self,
+	    (tsc2 - tsc1) / EVENT_BENCH_LOOP, event_bench_count,
+	    sizeof(event_queue));
+}
+
 int
 main(int argc, char *argv[]){
 	int                i;
@@ -93,6 +324,7 @@ main(int argc, char *argv[]){
 	uint64_t  tsc1, tsc2;
 	thread_resource tres;
 	event_mask       msk;
+	kstat_pgflt       pf;
 
 #if defined(CRASH_ME)
 	uintptr_t *crash_p = (uintptr_t *)main;
@@ -132,6 +364,15 @@ main(int argc, char *argv[]){
 	fval = 1.0;
 	fval *= 2.0;
 
+	/*
+	 * システムコール往復時間の計測
+	 * (統計情報の採取開始にはブートオプションkstatによる特権が必要)
+	 */
+	rc = yatos_kstat_ctrl(KSTAT_CTRL_ENABLE);
+	yatos_printf("[%d]: kstat enable rc=%d\n", yatos_thread_getid(), rc);
+	syscall_bench();
+	syscall_batch_test();
+
 	/*
 	 * ヒープの伸縮デモ
 	 */
@@ -238,6 +479,16 @@ main(int argc, char *argv[]){
 	yatos_printf("[%d]: wait-thread rc=%d id=%d code=%d\n",
 	    yatos_thread_getid(), rc, chldid, code);
 
+	/*
+	 * 共有メモリリングチャネルの性能測定(子スレッドのスタックを再利用)
+	 */
+	ring_bench( (void *)(old_heap - sizeof(void *)) );
+
+	/*
+	 * ヒープ伸縮の性能測定
+	 */
+	heap_bench();
+
 	/*
 	 * 保留していたブロードキャストの受信
 	 */
@@ -248,6 +499,11 @@ main(int argc, char *argv[]){
 	yatos_get_event_mask( &msk );
 	show_event_mask( &msk );
 
+	/*
+	 * イベント配送の性能測定
+	 */
+	event_bench();
+
 	/*
 	 * 自スレッド消費リソース獲得処理のデモ
 	 */
@@ -272,6 +528,15 @@ main(int argc, char *argv[]){
 	user_stack_test();
 	yatos_printf("[%d]: process stack demand paging test OK\n", yatos_thread_getid());
 
+	/*
+	 * カーネル統計情報の表示
+	 */
+	rc = yatos_kstat_get_pgflt(&pf);
+	yatos_printf("[%d]: page fault (rc, demand, stack, segv)=(%d, %lu, %lu, %lu)\n",
+	    yatos_thread_getid(), rc, pf.count[KSTAT_PGFLT_DEMAND],
+	    pf.count[KSTAT_PGFLT_STACK], pf.count[KSTAT_PGFLT_SEGV]);
+	yatos_kstat_ctrl(KSTAT_CTRL_SHOW);
+
 #if defined(CRASH_ME)
 	*crash_p = 0xdeaddead;
 #endif  /*  CRASH_ME  */
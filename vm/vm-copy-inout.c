@@ -25,7 +25,7 @@
 #include <kern/thread.h>
 #include <kern/vm.h>
 #include <kern/page.h>
-#include <kern/mutex.h>
+#include <kern/rwsem.h>
 
 #include <vm/vm-internal.h>
 
@@ -66,6 +66,42 @@ can_not_access:
 	return false;
 }
 
+/** 2つの仮想アドレス空間の読み込みロックをアドレス順に獲得する
+    @param[in] as1  仮想アドレス空間1
+    @param[in] as2  仮想アドレス空間2
+ */
+static void
+lock_both_spaces(vm *as1, vm *as2) {
+
+	if ( as1 == as2 ) {
+
+		rwsem_down_read( &as1->asmtx );
+		return;
+	}
+
+	if ( as1 < as2 ) {
+
+		rwsem_down_read( &as1->asmtx );
+		rwsem_down_read( &as2->asmtx );
+	} else {
+
+		rwsem_down_read( &as2->asmtx );
+		rwsem_down_read( &as1->asmtx );
+	}
+}
+
+/** 2つの仮想アドレス空間の読み込みロックを解放する
+    @param[in] as1  仮想アドレス空間1
+    @param[in] as2  仮想アドレス空間2
+ */
+static void
+unlock_both_spaces(vm *as1, vm *as2) {
+
+	rwsem_up_read( &as1->asmtx );
+	if ( as1 != as2 )
+		rwsem_up_read( &as2->asmtx );
+}
+
 /** プロセス間でデータをコピーする
     @param[in] dest_as  コピー先の仮想アドレス空間
     @param[in] src_as   コピー元の仮想アドレス空間
@@ -77,10 +113,8 @@ can_not_access:
     @return    -EFAULT ページが存在しない
     @note      カーネルストレートマップ領域間でメモリコピーを行うことで
                アドレス空間の切り替えを行わないようにする
-	       また、自プロセスの空間のmutexを取ると互いの空間のロック待ちで
-	       デッドロックするため, プリエンプションを禁止にして自プロセス内の
-	       他のスレッドが割り込まないようにし, 自プロセスのアドレス空間の
-	       mutexを取らないようにする。
+	       また、双方の空間の読み込みロックを獲得する. 互いの空間のロック待ちで
+	       デッドロックしないように, 仮想空間のアドレス順にロックを獲得する。
  */
 static int
 inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t count) {
@@ -95,8 +129,6 @@ inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t cou
 	size_t         src_len;
 	size_t        dest_len;
 	size_t         cpy_len;
-	void         *new_page;
-	vma              *vmap;
 
 	kassert( src_as != NULL );
 	kassert( src_as->p != NULL );
@@ -111,16 +143,8 @@ inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t cou
 	    ( src_as->p == hal_refer_kernel_proc() ) )
 		return -EFAULT;
 
-	/*  自CPUの同一プロセス内のスレッドがアドレス空間を操作
-	 *   しないことを保証するためにプリエンプションを抑止
-	 */
-	ti_disable_dispatch();  
-
-	/*  相手の空間のロック(mutex)を取る  */
-	if ( &current->p->vm == dest_as ) 
-		mutex_lock( &src_as->asmtx );
-	else 
-		mutex_lock( &dest_as->asmtx );
+	/*  アドレス順に双方の空間の読み込みロックを取る  */
+	lock_both_spaces(dest_as, src_as);
 	
 	saddr = (void *)src;
 	daddr = dest;
@@ -141,23 +165,15 @@ inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t cou
 				/*
 				 * ページ未割り当て時はページを割当てる
 				 */
-				rc = _vm_find_vma_nolock(src_as, saddr, &vmap);
+				rc = vm_map_newpage(src_as, saddr);
 				if ( rc != 0 )
 					goto unlock_out;
 
-				if ( vmap->prot == VMA_PROT_NONE )
-					goto unlock_out;
-
-				rc = get_free_page(&new_page);
-				if ( rc != 0 )
-					goto unlock_out;
+				rc = hal_translate_user_page(src_as, (uintptr_t)saddr,
+				    &src_kvaddr, &src_prot);
+				if ( rc != 0 ) {  /*  VMA_PROT_NONE領域  */
 
-				memset(new_page, 0, PAGE_SIZE);
-				rc = hal_map_user_page(src_as, (uintptr_t)saddr, 
-				    (uintptr_t)new_page, vmap->prot );
-				if ( rc != 0 ) {
-					
-					free_page(new_page);
+					rc = -EFAULT;
 					goto unlock_out;
 				}
 			}
@@ -174,23 +190,15 @@ inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t cou
 				/*
 				 * ページ未割り当て時はページを割当てる
 				 */
-				rc = _vm_find_vma_nolock(dest_as, daddr, &vmap);
+				rc = vm_map_newpage(dest_as, daddr);
 				if ( rc != 0 )
 					goto unlock_out;
 
-				if ( vmap->prot == VMA_PROT_NONE )
-					goto unlock_out;
-
-				rc = get_free_page(&new_page);
-				if ( rc != 0 )
-					goto unlock_out;
+				rc = hal_translate_user_page(dest_as, (uintptr_t)daddr,
+				    &dest_kvaddr, &dest_prot);
+				if ( rc != 0 ) {  /*  VMA_PROT_NONE領域  */
 
-				memset(new_page, 0, PAGE_SIZE);
-				rc = hal_map_user_page(dest_as, (uintptr_t)daddr, 
-				    (uintptr_t)new_page, vmap->prot );
-				if ( rc != 0 ) {
-					
-					free_page(new_page);
+					rc = -EFAULT;
 					goto unlock_out;
 				}
 			}
@@ -220,12 +228,7 @@ inter_user_copy(vm *dest_as, vm *src_as, void *dest, const void *src, size_t cou
 	rc = count - len;
 
 unlock_out:
-	if ( &current->p->vm == dest_as ) 
-		mutex_unlock( &src_as->asmtx );
-	else 
-		mutex_unlock( &dest_as->asmtx );
-
-	ti_enable_dispatch();
+	unlock_both_spaces(dest_as, src_as);
 
 	return rc;
 }
@@ -245,9 +248,9 @@ vm_user_area_can_access(vm *as, void *start, size_t count, vma_prot prot) {
 	if ( as->p == hal_refer_kernel_proc() )
 		return true;
 
-	mutex_lock( &as->asmtx );
+	rwsem_down_read( &as->asmtx );
 	rc = user_area_can_access_nolock(as, start, count, prot);
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 
 	return rc;
 }
@@ -282,7 +285,7 @@ vm_copy_in(vm *as, void *dest, const void *src, size_t count) {
 		}
 	}
 
-	mutex_lock( &as->asmtx );
+	rwsem_down_read( &as->asmtx );
 
 	/*
 	 * カーネルへのコピー
@@ -305,12 +308,12 @@ vm_copy_in(vm *as, void *dest, const void *src, size_t count) {
 	}
 copy_ok:
 	memcpy(dest, src, count);
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 copy_end:
 	return count;
 
 error_out:
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 	return rc;
 }
 
@@ -344,7 +347,7 @@ vm_copy_out(vm *as, void *dest, const void *src, size_t count) {
 		}
 	}
 
-	mutex_lock( &as->asmtx );
+	rwsem_down_read( &as->asmtx );
 
 	/*
 	 * カーネルからのコピー
@@ -368,12 +371,12 @@ vm_copy_out(vm *as, void *dest, const void *src, size_t count) {
 
 copy_ok:
 	memcpy(dest, src, count);
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 
 copy_end:
 	return count;
 
 error_out:
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 	return rc;
 }
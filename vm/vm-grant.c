@@ -0,0 +1,519 @@
+/* -*- mode: C; coding:utf-8 -*- */
+/**********************************************************************/
+/*  Yet Another Teachable Operating System                            */
+/*  Copyright 2016 Takeharu KATO                                      */
+/*                                                                    */
+/*  Page grant routines                                               */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kern/config.h>
+#include <kern/kernel.h>
+#include <kern/param.h>
+#include <kern/kern_types.h>
+#include <kern/assert.h>
+#include <kern/kprintf.h>
+#include <kern/string.h>
+#include <kern/errno.h>
+#include <kern/spinlock.h>
+#include <kern/queue.h>
+#include <kern/rbtree.h>
+#include <kern/refcount.h>
+#include <kern/proc.h>
+#include <kern/thread.h>
+#include <kern/vm.h>
+#include <kern/vm-grant.h>
+#include <kern/page.h>
+#include <kern/rwsem.h>
+#include <kern/mutex.h>
+
+#include <vm/vm-internal.h>
+
+/** グラント表
+ */
+static vm_grant_db grant_db = __VM_GRANT_DB_INITIALIZER( grant_db );
+
+static int vm_grant_cmp(struct _vm_grant *_a, struct _vm_grant *_b);
+
+RB_GENERATE_STATIC(vm_grant_tree, _vm_grant, node, vm_grant_cmp);
+
+/** グラントIDの比較関数
+    @param[in] a グラント1
+    @param[in] b グラント2
+    @retval 0  グラント1とグラント2のIDが等しい
+    @retval 負 グラント1のIDがグラント2のIDより小さい
+    @retval 正 グラント1のIDがグラント2のIDより大きい
+ */
+static int
+vm_grant_cmp(struct _vm_grant *a, struct _vm_grant *b) {
+
+	kassert( a != NULL );
+	kassert( b != NULL );
+
+	if ( a->id < b->id )
+		return -1;
+
+	if ( a->id > b->id )
+		return 1;
+
+	return 0;
+}
+
+/** グラントを解放する
+    @param[in] g 解放するグラント
+    @note 提供元ページのマップカウントを返却する
+ */
+static void
+vm_grant_free(vm_grant *g) {
+	obj_cnt_type i;
+
+	kassert( g != NULL );
+
+	for( i = 0; g->nr_pages > i; ++i)
+		dec_page_map_count( g->pages[i] );
+
+	kfree(g);
+}
+
+/** グラントへの参照を解放する
+    @param[in] g 操作対象のグラント
+    @note 取り消し済みのグラントの最後の参照を解放した場合はグラントを解放する
+ */
+static void
+vm_grant_put(vm_grant *g) {
+	int rc;
+
+	kassert( g != NULL );
+
+	rc = refcnt_put( &g->refs, NULL );
+	if ( rc == 0 )
+		vm_grant_free(g);
+}
+
+/** グラント表からグラントを検索する
+    @param[in] id グラントID
+    @return    グラント(見つからなかった場合はNULL)
+    @note グラント表のロックを獲得して呼び出す
+ */
+static vm_grant *
+vm_grant_find_nolock(vm_grant_id id) {
+	vm_grant key;
+
+	kassert( spinlock_locked_by_self(&grant_db.lock) );
+
+	key.id = id;
+
+	return RB_FIND(vm_grant_tree, &grant_db.head, &key);
+}
+
+/** グラントをマップした仮想アドレス領域を解放する
+    @param[in] as   マップ先の仮想空間
+    @param[in] vmap マップ先の仮想アドレス領域
+ */
+static void
+vm_grant_unmap_vma(vm *as, vma *vmap) {
+
+	kassert( as != NULL );
+	kassert( vmap != NULL );
+
+	rwsem_down_write( &as->asmtx );
+	_vm_remove_vma_nolock(as, vmap);
+	rwsem_up_write( &as->asmtx );
+}
+
+/** 自プロセスのページを指定した受信者に提供する
+    @param[in]  grantee 受信者のエンドポイント
+    @param[in]  start   提供する領域の開始アドレス(ページ境界)
+    @param[in]  size    提供する領域の長さ(ページサイズの倍数)
+    @param[in]  prot    受信者に許可するアクセス属性
+    @param[out] idp     グラントID返却先
+    @retval     0       正常に提供した
+    @retval    -EINVAL  領域の境界またはアクセス属性が不正
+    @retval    -E2BIG   提供するページ数が多すぎる
+    @retval    -EPERM   カーネルスレッドから呼び出した
+    @retval    -EFAULT  提供する領域にアクセスできない
+    @retval    -EACCES  提供元で許可されていないアクセス属性を指定した
+    @retval    -ENOMEM  メモリ不足
+    @note ページの内容は複写せず, 提供元ページのマップカウントを加算して保持する
+ */
+int
+vm_grant_create(endpoint grantee, void *start, size_t size, vma_prot prot,
+    vm_grant_id *idp) {
+	int             rc;
+	obj_cnt_type nr, i;
+	vm             *as;
+	vma          *vmap;
+	vm_grant        *g;
+	void        *vaddr;
+	uintptr_t   kvaddr;
+	vma_prot     cprot;
+	vm_grant      *res;
+	vm_grant_id     id;
+
+	as = &current->p->vm;
+	if ( as->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( ( !PAGE_ALIGNED( (uintptr_t)start ) ) || ( size == 0 )
+	    || ( !PAGE_ALIGNED( size ) ) )
+		return -EINVAL;
+
+	if ( ( !( prot & VMA_PROT_R ) ) || ( prot & ~( VMA_PROT_R | VMA_PROT_W ) ) )
+		return -EINVAL;
+
+	nr = size / PAGE_SIZE;
+	if ( nr > VM_GRANT_MAX_PAGES )
+		return -E2BIG;
+
+	g = kmalloc( sizeof(vm_grant) + sizeof(void *) * nr, KMALLOC_NORMAL );
+	if ( g == NULL )
+		return -ENOMEM;
+
+	list_init( &g->link );
+	refcnt_init( &g->refs );
+	g->id = VM_GRANT_ID_NONE;
+	g->state = VM_GRANT_STATE_OFFERED;
+	g->owner = as;
+	g->grantee = grantee;
+	g->prot = prot;
+	g->mapped_as = NULL;
+	g->mapped_vma = NULL;
+	g->nr_pages = 0;
+
+	/*
+	 * 提供するページを確定し, マップカウントを加算する
+	 */
+	rwsem_down_read( &as->asmtx );
+	for( i = 0; nr > i; ++i) {
+
+		vaddr = start + i * PAGE_SIZE;
+
+		rc = _vm_find_vma_nolock(as, vaddr, &vmap);
+		if ( rc != 0 ) {
+
+			rc = -EFAULT;
+			goto unlock_out;
+		}
+
+		if ( ( vmap->prot & prot ) != prot ) {
+
+			rc = -EACCES;
+			goto unlock_out;
+		}
+
+		rc = hal_translate_user_page(as, (uintptr_t)vaddr, &kvaddr, &cprot);
+		if ( rc != 0 ) {
+
+			rc = vm_map_newpage(as, vaddr);
+			if ( rc != 0 )
+				goto unlock_out;
+
+			rc = hal_translate_user_page(as, (uintptr_t)vaddr, &kvaddr, &cprot);
+			if ( rc != 0 ) {
+
+				rc = -EFAULT;
+				goto unlock_out;
+			}
+		}
+
+		inc_page_map_count( (void *)kvaddr );
+		g->pages[i] = (void *)kvaddr;
+		++g->nr_pages;
+	}
+	rwsem_up_read( &as->asmtx );
+
+	/*
+	 * グラント表に登録する
+	 */
+	spinlock_lock( &grant_db.lock );
+	id = grant_db.next_id++;
+	g->id = id;
+	res = RB_INSERT(vm_grant_tree, &grant_db.head, g);
+	kassert( res == NULL );
+	spinlock_unlock( &grant_db.lock );
+
+	rc = vm_copy_out(as, idp, &id, sizeof(vm_grant_id));
+	if ( rc < 0 ) {
+
+		vm_grant_revoke(id);
+		return -EFAULT;
+	}
+
+	return 0;
+
+unlock_out:
+	rwsem_up_read( &as->asmtx );
+	vm_grant_free(g);
+	return rc;
+}
+
+/** 提供されたページを自プロセスの仮想空間にマップする
+    @param[in] id    グラントID
+    @param[in] addr  マップ先のアドレス(ページ境界)
+    @param[in] prot  マップ時のアクセス属性
+    @retval     0       正常にマップした
+    @retval    -EINVAL  アドレスの境界またはアクセス属性が不正
+    @retval    -EPERM   受信者以外のスレッドから呼び出した
+    @retval    -ENOENT  グラントが存在しない(マップ中に取り消された場合を含む)
+    @retval    -EBUSY   既にマップ済み, またはマップ先の領域が使用中
+    @retval    -EACCES  提供元が許可していないアクセス属性を指定した
+    @retval    -ENOMEM  メモリ不足
+ */
+int
+vm_grant_map(vm_grant_id id, void *addr, vma_prot prot) {
+	int             rc;
+	bool          undo;
+	obj_cnt_type     i;
+	vm             *as;
+	vma          *vmap;
+	vm_grant        *g;
+
+	as = &current->p->vm;
+	if ( as->p == hal_refer_kernel_proc() )
+		return -EPERM;
+
+	if ( !PAGE_ALIGNED( (uintptr_t)addr ) )
+		return -EINVAL;
+
+	if ( ( !( prot & VMA_PROT_R ) ) || ( prot & ~( VMA_PROT_R | VMA_PROT_W ) ) )
+		return -EINVAL;
+
+	spinlock_lock( &grant_db.lock );
+
+	g = vm_grant_find_nolock(id);
+	if ( g == NULL ) {
+
+		rc = -ENOENT;
+		goto unlock_out;
+	}
+
+	if ( g->grantee != current->tid ) {
+
+		rc = -EPERM;
+		goto unlock_out;
+	}
+
+	if ( g->state != VM_GRANT_STATE_OFFERED ) {
+
+		rc = -EBUSY;
+		goto unlock_out;
+	}
+
+	if ( ( g->prot & prot ) != prot ) {
+
+		rc = -EACCES;
+		goto unlock_out;
+	}
+
+	g->state = VM_GRANT_STATE_MAPPING;  /*  他のマップ要求を排他する  */
+	rc = refcnt_get( &g->refs, NULL );
+	kassert( rc == 0 );
+
+	spinlock_unlock( &grant_db.lock );
+
+	/*
+	 * 提供元のページを複写せずにマップする
+	 */
+	rwsem_down_write( &as->asmtx );
+
+	rc = vm_create_vma(as, &vmap, addr, g->nr_pages * PAGE_SIZE, prot,
+	    VMA_FLAG_GRANT);
+	if ( rc == 0 ) {
+
+		for( i = 0; g->nr_pages > i; ++i) {
+
+			rc = vm_map_addr(as, addr + i * PAGE_SIZE, g->pages[i]);
+			if ( rc != 0 ) {
+
+				_vm_remove_vma_nolock(as, vmap);
+				break;
+			}
+		}
+	}
+
+	rwsem_up_write( &as->asmtx );
+
+	/*
+	 * マップ中に取り消された場合はマップを取り消す
+	 */
+	undo = false;
+	spinlock_lock( &grant_db.lock );
+	if ( g->state == VM_GRANT_STATE_MAPPING ) {
+
+		if ( rc == 0 ) {
+
+			g->state = VM_GRANT_STATE_MAPPED;
+			g->mapped_as = as;
+			g->mapped_vma = vmap;
+		} else
+			g->state = VM_GRANT_STATE_OFFERED;
+	} else if ( rc == 0 ) {
+
+		undo = true;
+		rc = -ENOENT;
+	}
+	spinlock_unlock( &grant_db.lock );
+
+	if ( undo )
+		vm_grant_unmap_vma(as, vmap);
+
+	vm_grant_put(g);
+
+	return rc;
+
+unlock_out:
+	spinlock_unlock( &grant_db.lock );
+	return rc;
+}
+
+/** 提供されたページのマップを解除する
+    @param[in] id グラントID
+    @retval     0       正常にアンマップした
+    @retval    -ENOENT  グラントが存在しないか, 自プロセスにマップされていない
+    @note グラントはマップ待ち状態に戻り, 再度マップ可能になる
+ */
+int
+vm_grant_unmap(vm_grant_id id) {
+	vm             *as;
+	vma          *vmap;
+	vm_grant        *g;
+
+	as = &current->p->vm;
+
+	spinlock_lock( &grant_db.lock );
+
+	g = vm_grant_find_nolock(id);
+	if ( ( g == NULL ) || ( g->state != VM_GRANT_STATE_MAPPED )
+	    || ( g->mapped_as != as ) ) {
+
+		spinlock_unlock( &grant_db.lock );
+		return -ENOENT;
+	}
+
+	vmap = g->mapped_vma;
+	g->state = VM_GRANT_STATE_OFFERED;
+	g->mapped_as = NULL;
+	g->mapped_vma = NULL;
+
+	spinlock_unlock( &grant_db.lock );
+
+	vm_grant_unmap_vma(as, vmap);
+
+	return 0;
+}
+
+/** 提供したページを取り消す
+    @param[in] id グラントID
+    @retval     0       正常に取り消した
+    @retval    -ENOENT  グラントが存在しない
+    @retval    -EPERM   提供元以外のプロセスから呼び出した
+    @note 受信者がマップ済みの場合は受信者の仮想空間からアンマップする.
+    アンマップが完了するまで受信者の仮想空間の破棄(vm_grant_release_as)と
+    排他する.
+ */
+int
+vm_grant_revoke(vm_grant_id id) {
+	int             rc;
+	vm_grant        *g;
+
+	mutex_lock( &grant_db.unmap_mtx );
+	spinlock_lock( &grant_db.lock );
+
+	g = vm_grant_find_nolock(id);
+	if ( g == NULL ) {
+
+		rc = -ENOENT;
+		goto unlock_out;
+	}
+
+	if ( g->owner != &current->p->vm ) {
+
+		rc = -EPERM;
+		goto unlock_out;
+	}
+
+	RB_REMOVE(vm_grant_tree, &grant_db.head, g);
+	if ( g->state != VM_GRANT_STATE_MAPPED )
+		g->mapped_vma = NULL;  /*  マップ処理中の場合はマップ側で取り消す  */
+	g->state = VM_GRANT_STATE_REVOKED;
+
+	spinlock_unlock( &grant_db.lock );
+
+	if ( g->mapped_vma != NULL )
+		vm_grant_unmap_vma(g->mapped_as, g->mapped_vma);
+
+	mutex_unlock( &grant_db.unmap_mtx );
+
+	refcnt_mark_deleted( &g->refs );
+	vm_grant_put(g);
+
+	return 0;
+
+unlock_out:
+	spinlock_unlock( &grant_db.lock );
+	mutex_unlock( &grant_db.unmap_mtx );
+
+	return rc;
+}
+
+/** 破棄する仮想空間に関連するグラントを解放する
+    @param[in] as 破棄する仮想空間
+    @note 仮想アドレス領域の破棄前に呼び出す.
+    asが提供したグラントは取り消し, asにマップされたグラントは
+    マップ待ち状態に戻す(仮想アドレス領域は呼出元で破棄する).
+    スリープ可能なロックを獲得するため, スピンロックを保持せずに呼び出す.
+ */
+void
+vm_grant_release_as(vm *as) {
+	queue          revq;
+	vm_grant   *g, *next;
+
+	kassert( as != NULL );
+
+	queue_init( &revq );
+
+	mutex_lock( &grant_db.unmap_mtx );  /*  他プロセスからのアンマップと排他  */
+	spinlock_lock( &grant_db.lock );
+
+	for( g = RB_MIN(vm_grant_tree, &grant_db.head); g != NULL; g = next) {
+
+		next = RB_NEXT(vm_grant_tree, &grant_db.head, g);
+
+		if ( g->owner == as ) {
+
+			RB_REMOVE(vm_grant_tree, &grant_db.head, g);
+			if ( ( g->state != VM_GRANT_STATE_MAPPED ) || ( g->mapped_as == as ) )
+				g->mapped_vma = NULL;
+			g->state = VM_GRANT_STATE_REVOKED;
+			queue_add( &revq, &g->link );
+		} else if ( ( g->state == VM_GRANT_STATE_MAPPED )
+		    && ( g->mapped_as == as ) ) {
+
+			g->state = VM_GRANT_STATE_OFFERED;
+			g->mapped_as = NULL;
+			g->mapped_vma = NULL;
+		}
+	}
+
+	spinlock_unlock( &grant_db.lock );
+
+	/*
+	 * 他プロセスにマップされているページをアンマップしてから解放する
+	 */
+	while( !queue_is_empty( &revq ) ) {
+
+		g = CONTAINER_OF(queue_get_top( &revq ), vm_grant, link);
+
+		if ( g->mapped_vma != NULL )
+			vm_grant_unmap_vma(g->mapped_as, g->mapped_vma);
+
+		refcnt_mark_deleted( &g->refs );
+		vm_grant_put(g);
+	}
+
+	mutex_unlock( &grant_db.unmap_mtx );
+}
@@ -24,8 +24,9 @@
 #include <kern/proc.h>
 #include <kern/thread.h>
 #include <kern/vm.h>
+#include <kern/vm-grant.h>
 #include <kern/page.h>
-#include <kern/mutex.h>
+#include <kern/rwsem.h>
 
 #include <vm/vm-internal.h>
 
@@ -96,7 +97,7 @@ check_vma_overlap_nolock(vm *as, vma *vmap) {
 	vma   *vma_ref;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 	kassert( vmap != NULL );
 
 	pg_start = (void *)PAGE_START((uintptr_t)vmap->start);
@@ -146,7 +147,7 @@ _vm_find_vma_nolock(vm *as, void *vaddr, vma **res) {
 	vma    *vma_ref;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_is_locked(&as->asmtx) );
 	kassert( res != NULL );
 
 	RB_FOREACH(vma_ref, vma_tree, &as->vma_head) {
@@ -184,7 +185,7 @@ unmap_range(vm *as, void *start, void *end) {
 	void      *vaddr;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 
 	for( vaddr = start; vaddr < end; vaddr += PAGE_SIZE) {
 		
@@ -211,7 +212,7 @@ map_newpage_range(vm *as, void *start, void *end, vma_prot prot) {
 	void   *new_page;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 
 	for( vaddr = start; vaddr < end; vaddr += PAGE_SIZE) {
 
@@ -260,7 +261,7 @@ resize_vma(vma *vmap, void *start, void *end) {
 	kassert( vmap != NULL);
 	kassert( vmap->as != NULL);
 	kassert( start != NULL );
-	kassert( mutex_locked_by_self(&vmap->as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&vmap->as->asmtx) );
 
 	/*
 	 * 引数で与えられたアドレスをページ境界に合わせる
@@ -333,6 +334,24 @@ vm_destroy_vma_nolock(vma *vmap){
 	return 0;
 }
 
+/** 仮想アドレス領域を仮想空間から取り外して破棄する
+    @param[in] as   操作対象の仮想空間
+    @param[in] vmap 破棄対象の仮想アドレス領域
+    @retval 0 正常に破棄した
+ */
+int
+_vm_remove_vma_nolock(vm *as, vma *vmap){
+
+	kassert( as != NULL );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
+	kassert( vmap != NULL );
+	kassert( vmap->as == as );
+
+	RB_REMOVE(vma_tree, &as->vma_head, vmap);
+
+	return vm_destroy_vma_nolock(vmap);
+}
+
 /**  指定されたアドレスを含むVMAを検索する
      @param[in] as    検索対象のアドレス空間
      @param[in] vaddr 検索キーとなるアドレス
@@ -347,9 +366,9 @@ vm_find_vma(vm *as, void *vaddr, vma **res) {
 	kassert( as != NULL );
 	kassert( res != NULL );
 
-	mutex_lock( &as->asmtx );
+	rwsem_down_read( &as->asmtx );
 	rc = _vm_find_vma_nolock(as, vaddr, res);
-	mutex_unlock( &as->asmtx );
+	rwsem_up_read( &as->asmtx );
 
 	return rc;
 }
@@ -436,7 +455,7 @@ vm_create_vma(vm *as, vma **vmapp, void *start, size_t size, vma_prot prot, vma_
 	vma *vmap, *res;
 
 	kassert( as != NULL );
-      	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 	kassert( vmapp != NULL );
 
 	vmap = alloc_new_vma(as, start, start + size, prot, vflags);
@@ -471,9 +490,9 @@ vm_destroy_vma(vma *vmap){
 	kassert( vmap->as != NULL );
 	kassert( vmap != NULL );
 
-	mutex_lock( &vmap->as->asmtx );
-	rc = vm_destroy_vma_nolock(vmap);
-	mutex_unlock( &vmap->as->asmtx );
+	rwsem_down_write( &vmap->as->asmtx );
+	rc = _vm_remove_vma_nolock(vmap->as, vmap);
+	rwsem_up_write( &vmap->as->asmtx );
 	return rc;
 }
 
@@ -496,7 +515,8 @@ vm_duplicate(vm *dest, vm *src) {
 	kassert( dest->p != hal_refer_kernel_proc() );
 	kassert( src->p != hal_refer_kernel_proc() );
 
-	mutex_lock( &src->asmtx );
+	rwsem_down_write( &dest->asmtx );
+	rwsem_down_read( &src->asmtx );
 	RB_FOREACH(vmap, vma_tree, &src->vma_head) {
 
 		rc = vm_create_vma(dest, &new_vma, vmap->start, 
@@ -509,7 +529,8 @@ vm_duplicate(vm *dest, vm *src) {
 			goto error_out;
 	}
 error_out:
-	mutex_unlock( &src->asmtx );
+	rwsem_up_read( &src->asmtx );
+	rwsem_up_write( &dest->asmtx );
 
 }
 
@@ -525,9 +546,10 @@ int
 vm_map_addr(vm *as, void *vaddr, void *kpaddr){
 	int           rc;
 	vma         *res;
+	intrflags  flags;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_is_locked(&as->asmtx) );
 
 	if ( ( (uintptr_t)vaddr ) >= USER_VADDR_LIMIT )
 		return -EFAULT;
@@ -536,8 +558,10 @@ vm_map_addr(vm *as, void *vaddr, void *kpaddr){
 	if ( rc != 0 ) 
 		goto error_out;
 
+	spinlock_lock_disable_intr( &as->pgtbl_lock, &flags );
 	rc = hal_map_user_page(as, (uintptr_t)vaddr, 
 	    (uintptr_t)kpaddr, res->prot ); 
+	spinlock_unlock_restore_intr( &as->pgtbl_lock, &flags );
 
 error_out:
 	return rc;
@@ -549,15 +573,20 @@ error_out:
     @retval       0  正常にマップした
     @retval -ENOMEM  ページテーブルのメモリ獲得に失敗した
                      新規ページの獲得に失敗した
+    @note 読み込みロック下で並行して呼び出されることを考慮し, ページテーブル
+    更新ロック獲得後に割当て済みであることを確認した場合は正常終了する
  */
 int
 vm_map_newpage(vm *as, void *vaddr){
 	int           rc;
 	void   *new_page;
 	vma         *res;
+	uintptr_t  kvaddr;
+	vma_prot     prot;
+	intrflags   flags;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_is_locked(&as->asmtx) );
 
 	if ( ( (uintptr_t)vaddr ) >= USER_VADDR_LIMIT )
 		return -EFAULT;
@@ -572,9 +601,24 @@ vm_map_newpage(vm *as, void *vaddr){
 
 	memset(new_page, 0, PAGE_SIZE);
 
+	spinlock_lock_disable_intr( &as->pgtbl_lock, &flags );
+
+	rc = hal_translate_user_page(as, (uintptr_t)vaddr, &kvaddr, &prot);
+	if ( rc == 0 ) {  /*  他スレッドが割当て済み  */
+
+		spinlock_unlock_restore_intr( &as->pgtbl_lock, &flags );
+		free_page(new_page);
+		goto error_out;
+	}
+
 	rc = hal_map_user_page(as, (uintptr_t)vaddr, 
 	    (uintptr_t)new_page, res->prot );
 
+	spinlock_unlock_restore_intr( &as->pgtbl_lock, &flags );
+
+	if ( rc != 0 ) 
+		free_page(new_page);
+
 error_out:
 
 	return rc;
@@ -592,7 +636,7 @@ vm_unmap_addr(vm *as, void *vaddr){
 	vma         *res;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 
 	if ( ( (uintptr_t)vaddr ) >= USER_VADDR_LIMIT )
 		return -EFAULT;
@@ -622,7 +666,7 @@ vm_resize_area(vm *as, void *fault_addr, void *new_addr, void **old_addrp){
 	void        *new_end;
 
 	kassert( as != NULL );
-	kassert( mutex_locked_by_self(&as->asmtx) );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
 	kassert( fault_addr != NULL );
 	kassert( new_addr != NULL );
 	kassert( old_addrp != NULL );
@@ -680,6 +724,154 @@ error_out:
 	return rc;
 }
 
+/** 匿名メモリ領域などを割り当てる空き領域を探す
+    @param[in]  as     操作対象の仮想アドレス空間
+    @param[in]  size   領域長(ページサイズの倍数)
+    @param[out] addrp  空き領域の先頭アドレス格納先
+    @retval     0      空き領域が見つかった
+    @retval    -ENOMEM 空き領域がない
+    @note 仮想アドレス領域は開始アドレス順に並んでいるため, 
+    USER_MMAP_BASEから順にたどって最初に見つかった隙間を返す
+ */
+int
+_vm_find_free_area_nolock(vm *as, size_t size, void **addrp) {
+	vma      *vma_ref;
+	uintptr_t    cand;
+
+	kassert( as != NULL );
+	kassert( rwsem_write_locked_by_self(&as->asmtx) );
+	kassert( addrp != NULL );
+
+	cand = USER_MMAP_BASE;
+
+	RB_FOREACH(vma_ref, vma_tree, &as->vma_head) {
+
+		if ( (uintptr_t)vma_ref->end <= cand )
+			continue;  /*  探索開始位置より前の領域  */
+
+		if ( cand + size <= (uintptr_t)vma_ref->start )
+			break;  /*  隙間が見つかった  */
+
+		cand = PAGE_ALIGNED( (uintptr_t)vma_ref->end ) ? 
+			( (uintptr_t)vma_ref->end ) : 
+			( PAGE_NEXT( (uintptr_t)vma_ref->end ) );
+	}
+
+	if ( cand + size > USER_MMAP_LIMIT )
+		return -ENOMEM;
+
+	*addrp = (void *)cand;
+
+	return 0;
+}
+
+/** 匿名メモリ領域を生成する
+    @param[in]  as     操作対象の仮想アドレス空間
+    @param[in]  addr   領域の先頭アドレス(ページ境界, NULLの場合は空き領域を探す)
+    @param[in]  size   領域長
+    @param[in]  prot   保護属性
+    @param[out] addrp  生成した領域の先頭アドレス格納先
+    @retval     0      正常に生成した
+    @retval    -EINVAL アドレスまたは領域長が不正
+    @retval    -EBUSY  他の領域と衝突する
+    @retval    -ENOMEM 空き領域がないまたはメモリ不足
+    @note ページはアクセス時にゼロ埋めされたページを割り当てる(デマンドページング).
+ */
+int
+vm_map_anon(vm *as, void *addr, size_t size, vma_prot prot, void **addrp) {
+	int       rc;
+	vma    *vmap;
+	void   *start;
+
+	kassert( as != NULL );
+	kassert( addrp != NULL );
+
+	/*
+	 * ページ境界への切り上げで桁あふれしないよう, 
+	 * 領域長を切り上げる前に範囲を確認する
+	 */
+	if ( ( size == 0 ) || ( size > ( USER_MMAP_LIMIT - USER_MMAP_BASE ) ) ||
+	    ( !PAGE_ALIGNED( (uintptr_t)addr ) ) )
+		return -EINVAL;
+
+	size = PAGE_ALIGNED(size) ? ( size ) : ( PAGE_NEXT(size) );
+
+	if ( ( addr != NULL ) && 
+	    ( ( (uintptr_t)addr >= USER_VADDR_LIMIT ) ||
+		( ( (uintptr_t)addr + size ) > USER_VADDR_LIMIT ) ) )
+		return -EINVAL;
+
+	rwsem_down_write( &as->asmtx );
+
+	start = addr;
+	if ( start == NULL ) {
+
+		rc = _vm_find_free_area_nolock(as, size, &start);
+		if ( rc != 0 )
+			goto unlock_out;
+	}
+
+	rc = vm_create_vma(as, &vmap, start, size, prot, VMA_FLAG_ANON);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	*addrp = start;
+
+unlock_out:
+	rwsem_up_write( &as->asmtx );
+
+	return rc;
+}
+
+/** 匿名メモリ領域を破棄する
+    @param[in] as     操作対象の仮想アドレス空間
+    @param[in] addr   領域の先頭アドレス
+    @param[in] size   領域長
+    @retval    0      正常に破棄した
+    @retval   -EINVAL 領域長が不正または領域全体を指定していない
+    @retval   -ENOENT 指定したアドレスに領域がない
+    @retval   -EPERM  匿名メモリ領域ではない
+    @note 領域の一部だけを破棄することはできない.
+    ページグラントやリングチャネルの領域は, それぞれの解放処理で破棄する.
+ */
+int
+vm_unmap_anon(vm *as, void *addr, size_t size) {
+	int       rc;
+	vma    *vmap;
+
+	kassert( as != NULL );
+
+	if ( ( size == 0 ) || ( size > ( USER_MMAP_LIMIT - USER_MMAP_BASE ) ) )
+		return -EINVAL;  /*  領域長が不正  */
+
+	size = PAGE_ALIGNED(size) ? ( size ) : ( PAGE_NEXT(size) );
+
+	rwsem_down_write( &as->asmtx );
+
+	rc = _vm_find_vma_nolock(as, addr, &vmap);
+	if ( rc != 0 )
+		goto unlock_out;
+
+	if ( !( vmap->flags & VMA_FLAG_ANON ) ) {
+
+		rc = -EPERM;
+		goto unlock_out;
+	}
+
+	if ( ( vmap->start != addr ) || ( vmap->end != ( addr + size ) ) ) {
+
+		rc = -EINVAL;
+		goto unlock_out;
+	}
+
+	rc = _vm_remove_vma_nolock(as, vmap);
+
+unlock_out:
+	rwsem_up_write( &as->asmtx );
+
+	return rc;
+}
+
 /** 仮想アドレス空間を初期化し, ユーザページテーブルディレクトリを割り当てる 
     @param[in] as  操作対象の仮想空間
     @param[in] p   仮想空間が所属するプロセス
@@ -706,7 +898,7 @@ vm_destroy(vm *as) {
 	kassert( as != NULL );
 	kassert( spinlock_locked_by_self(&as->p->lock) );
 
-	mutex_lock( &as->asmtx );
+	rwsem_down_write( &as->asmtx );
 	/*
 	 * VMAを全て破棄する
 	 */
@@ -719,7 +911,7 @@ vm_destroy(vm *as) {
 
 	hal_free_user_page_table( as );  /*  ページテーブルを解放   */
 
-	mutex_unlock( &as->asmtx );
+	rwsem_up_write( &as->asmtx );
 
 	as->pgtbl = NULL;
 }